@@ -0,0 +1,371 @@
+#include "RunTests.h"
+#include "SnippyRVdash/VTable.h"
+
+#include <dlfcn.h>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// These tests load libSnippyRVdash.so with dlopen, as llvm-snippy and the
+// lockstep mode of rvdashSim do, and call it through RVMVTable and
+// RVMExtVTable. The programs are encoded by hand, they are loaded at 0.
+
+// RVM.h only declares it, the callbacks of the tests write to it
+struct RVMCallbackHandler {
+  std::vector<std::string> Updates;
+
+  std::vector<std::string> take() { return std::exchange(Updates, {}); }
+};
+
+namespace {
+
+const unsigned MtvecCsr = 0x305;
+const unsigned MscratchCsr = 0x340;
+const unsigned MepcCsr = 0x341;
+
+const uint32_t Ebreak = 0x00100073;
+const uint32_t Illegal = 0xffffffff;
+
+// addi a0, zero, 1; then three addi a0, a0, 1; ebreak
+const std::vector<uint32_t> CountProgram = {0x00100513, 0x00150513, 0x00150513,
+                                            0x00150513, Ebreak};
+
+// The handler at 0x20 steps over the illegal instruction at 0x8:
+//   addi t0, zero, 0x20; csrrw zero, mtvec, t0; .word 0xffffffff;
+//   addi a1, a1, 1; ebreak
+// 0x20:
+//   csrrs t1, mepc, zero; addi t1, t1, 4; csrrw zero, mepc, t1; mret
+const std::vector<uint32_t> TrapProgram = {
+    0x02000293, 0x30529073, Illegal,    0x00158593, Ebreak,     0,
+    0,          0,          0x34102373, 0x00430313, 0x34131073, 0x30200073};
+
+/**
+ * @brief struct ModelLib - libSnippyRVdash.so with its tables. It is loaded
+ *                          once for all tests and is not closed, the pool
+ *                          of the models lives in it.
+ */
+struct ModelLib {
+  const rvm::RVM_FunctionPointers *VTable = nullptr;
+  const rvm::RVMExt_FunctionPointers *ExtVTable = nullptr;
+
+  static const ModelLib &get() {
+    static ModelLib Lib;
+    return Lib;
+  }
+
+private:
+  ModelLib() {
+    void *Handle = dlopen(RVDASH_MODEL_PATH, RTLD_NOW | RTLD_LOCAL);
+    if (Handle == nullptr)
+      rvdash::failWithError(std::string("Can't load ") + RVDASH_MODEL_PATH +
+                            ": " + dlerror());
+    VTable = static_cast<const rvm::RVM_FunctionPointers *>(
+        dlsym(Handle, "RVMVTable"));
+    ExtVTable = static_cast<const rvm::RVMExt_FunctionPointers *>(
+        dlsym(Handle, "RVMExtVTable"));
+    if (VTable == nullptr || ExtVTable == nullptr ||
+        ExtVTable->Version != RVMEXT_CURRENT_VERSION ||
+        ExtVTable->Size != sizeof(rvm::RVMExt_FunctionPointers))
+      rvdash::failWithError("libSnippyRVdash.so has no RVM tables");
+  }
+};
+
+/**
+ * @brief makeConfig - the config of an RV32I model with one RAM region
+ *                     [0, RamSize) and the log at LogFilePath.
+ */
+RVMConfig makeConfig(const char *LogFilePath,
+                     unsigned long long RamSize = 0x10000) {
+  RVMConfig Config{};
+  Config.RamStart = 0;
+  Config.RamSize = RamSize;
+  Config.RomStart = 0;
+  Config.RomSize = 0;
+  Config.RV64 = 0;
+  Config.MisaExt = RVM_MISA_I;
+  Config.LogFilePath = LogFilePath;
+  Config.PluginInfo = "";
+  return Config;
+}
+
+void onXRegUpdate(RVMCallbackHandler *Handler, RVMXReg Reg, RVMRegT Value) {
+  std::ostringstream Update;
+  Update << "x" << Reg << " 0x" << std::hex << Value;
+  Handler->Updates.push_back(Update.str());
+}
+
+void onMemUpdate(RVMCallbackHandler *Handler, uint64_t Addr, const char *Data,
+                 size_t Size) {
+  std::ostringstream Update;
+  Update << "mem 0x" << std::hex << Addr << ":";
+  for (size_t Idx = 0; Idx < Size; ++Idx)
+    Update << " " << std::setw(2) << std::setfill('0')
+           << static_cast<unsigned>(static_cast<unsigned char>(Data[Idx]));
+  Handler->Updates.push_back(Update.str());
+}
+
+void onPCUpdate(RVMCallbackHandler *Handler, uint64_t PC) {
+  std::ostringstream Update;
+  Update << "pc 0x" << std::hex << PC;
+  Handler->Updates.push_back(Update.str());
+}
+
+/**
+ * @brief class Model - the model created by rvm_modelCreate and given back
+ *                      to the library by rvm_modelDestroy.
+ */
+class Model {
+  const ModelLib &Lib = ModelLib::get();
+  RVMState *State;
+
+public:
+  explicit Model(const RVMConfig &Config)
+      : State(Lib.VTable->modelCreate(&Config)) {}
+  Model(const Model &) = delete;
+  Model &operator=(const Model &) = delete;
+  ~Model() { Lib.VTable->modelDestroy(State); }
+
+  void load(const std::vector<uint32_t> &Program, uint64_t Addr = 0) {
+    Lib.VTable->writeMem(State, Addr, Program.size() * sizeof(uint32_t),
+                         reinterpret_cast<const char *>(Program.data()));
+  }
+
+  uint32_t readWord(uint64_t Addr) const {
+    uint32_t Word = 0;
+    Lib.VTable->readMem(State, Addr, sizeof(Word),
+                        reinterpret_cast<char *>(&Word));
+    return Word;
+  }
+
+  int step() { return Lib.VTable->executeInstr(State); }
+
+  RVMStopReason batch(uint64_t MaxCount, uint64_t StopPc, uint64_t &Retired) {
+    return Lib.ExtVTable->executeBatch(State, MaxCount, StopPc, &Retired);
+  }
+
+  void reset() { Lib.ExtVTable->modelReset(State); }
+
+  uint64_t readPC() const { return Lib.VTable->readPC(State); }
+
+  RVMRegT readXReg(unsigned Reg) const {
+    return Lib.VTable->readXReg(State, static_cast<RVMXReg>(Reg));
+  }
+
+  RVMRegT readCSR(unsigned Csr) const {
+    return Lib.VTable->readCSRReg(State, Csr);
+  }
+  void setCSR(unsigned Csr, RVMRegT Value) {
+    Lib.VTable->setCSRReg(State, Csr, Value);
+  }
+
+  /**
+   * @brief expectCleared - the state of a new model: zero memory, registers,
+   *                        PC, instret and machine CSRs.
+   */
+  void expectCleared() const {
+    for (uint64_t Addr = 0; Addr < 0x40; Addr += sizeof(uint32_t))
+      EXPECT_EQ(readWord(Addr), 0) << "at 0x" << std::hex << Addr;
+    EXPECT_EQ(readWord(0x100), 0);
+    for (unsigned Reg = 0; Reg < 32; ++Reg)
+      EXPECT_EQ(readXReg(Reg), 0) << "x" << Reg;
+    EXPECT_EQ(readPC(), 0);
+    EXPECT_EQ(readCSR(RVM_CSR_INSTRET), 0);
+    EXPECT_EQ(readCSR(MtvecCsr), 0);
+    EXPECT_EQ(readCSR(MscratchCsr), 0);
+    EXPECT_EQ(readCSR(MepcCsr), 0);
+  }
+};
+
+std::string readLog(const std::string &LogFilePath) {
+  std::ifstream LogFile(LogFilePath);
+  std::stringstream Log;
+  Log << LogFile.rdbuf();
+  return Log.str();
+}
+
+const char *const LogFilePath = "ModelTests.log";
+const char *const OtherLogFilePath = "ModelTests2.log";
+
+const std::string StartLine =
+    "====================rvdash start====================";
+const std::string CompleteLine =
+    "===================rvdash complete==================";
+
+/**
+ * @brief runTrapProgram - the model gets the state that a new one does not
+ *                         have: the program and a data word in memory,
+ *                         registers, PC, instret, mtvec, mepc and mscratch.
+ */
+void runTrapProgram(Model &Cpu) {
+  Cpu.load(TrapProgram);
+  Cpu.load({0x12345678}, 0x100);
+  Cpu.setCSR(MscratchCsr, 0x55);
+  uint64_t Retired = 0;
+  Cpu.batch(6, RVM_NO_STOP_PC, Retired);
+  ASSERT_EQ(Cpu.readPC(), 0xc);
+  ASSERT_EQ(Cpu.readCSR(MtvecCsr), 0x20);
+}
+
+size_t countLines(const std::string &Log, const std::string &Line) {
+  size_t Count = 0;
+  for (auto Pos = Log.find(Line); Pos != std::string::npos;
+       Pos = Log.find(Line, Pos + 1))
+    ++Count;
+  return Count;
+}
+
+} // namespace
+
+//-----------------------------------EXECUTE_BATCH---------------------------------------
+
+TEST(SnippyModel, BatchStopsAtCount) {
+  Model Cpu(makeConfig(LogFilePath));
+  Cpu.load(CountProgram);
+  uint64_t Retired = 0;
+  EXPECT_EQ(Cpu.batch(2, RVM_NO_STOP_PC, Retired), RVM_STOP_COUNT);
+  EXPECT_EQ(Retired, 2);
+  EXPECT_EQ(Cpu.readPC(), 0x8);
+  EXPECT_EQ(Cpu.readXReg(10), 2);
+  EXPECT_EQ(Cpu.readCSR(RVM_CSR_INSTRET), 2);
+}
+
+TEST(SnippyModel, BatchStopsAtPc) {
+  Model Cpu(makeConfig(LogFilePath));
+  Cpu.load(CountProgram);
+  uint64_t Retired = 0;
+  EXPECT_EQ(Cpu.batch(100, 0xc, Retired), RVM_STOP_PC);
+  EXPECT_EQ(Retired, 3);
+  EXPECT_EQ(Cpu.readPC(), 0xc);
+  // The instruction at StopPc is executed by the next batch
+  EXPECT_EQ(Cpu.batch(1, 0xc, Retired), RVM_STOP_COUNT);
+  EXPECT_EQ(Retired, 1);
+  EXPECT_EQ(Cpu.readXReg(10), 4);
+}
+
+TEST(SnippyModel, BatchStopsAtExit) {
+  Model Cpu(makeConfig(LogFilePath));
+  Cpu.load(CountProgram);
+  uint64_t Retired = 0;
+  EXPECT_EQ(Cpu.batch(100, RVM_NO_STOP_PC, Retired), RVM_STOP_EXIT);
+  EXPECT_EQ(Cpu.readXReg(10), 4);
+  EXPECT_EQ(Retired, Cpu.readCSR(RVM_CSR_INSTRET));
+  EXPECT_EQ(Cpu.batch(100, RVM_NO_STOP_PC, Retired), RVM_STOP_EXIT);
+  EXPECT_EQ(Retired, 0);
+}
+
+TEST(SnippyModel, BatchStopsAtUnhandledTrap) {
+  {
+    Model Cpu(makeConfig(LogFilePath));
+    Cpu.load({0x00100513, Illegal, Ebreak});
+    uint64_t Retired = 0;
+    EXPECT_EQ(Cpu.batch(100, RVM_NO_STOP_PC, Retired), RVM_STOP_TRAP);
+    // The illegal instruction is not retired, the model stays at it
+    EXPECT_EQ(Retired, 1);
+    EXPECT_EQ(Cpu.readPC(), 0x4);
+    EXPECT_EQ(Cpu.readCSR(RVM_CSR_INSTRET), 1);
+  }
+  EXPECT_NE(readLog(LogFilePath).find("Illegal instruction"),
+            std::string::npos);
+}
+
+TEST(SnippyModel, BatchDoesNotCountHandledTraps) {
+  Model Cpu(makeConfig(LogFilePath));
+  Cpu.load(TrapProgram);
+  uint64_t Retired = 0;
+  // addi, csrrw, then the handler: csrrs, addi, csrrw, mret
+  EXPECT_EQ(Cpu.batch(6, RVM_NO_STOP_PC, Retired), RVM_STOP_COUNT);
+  EXPECT_EQ(Retired, 6);
+  EXPECT_EQ(Cpu.readPC(), 0xc);
+  EXPECT_EQ(Cpu.readCSR(RVM_CSR_INSTRET), 6);
+  EXPECT_EQ(Cpu.readCSR(MepcCsr), 0xc);
+}
+
+//------------------------------------MODEL_POOL-----------------------------------------
+
+TEST(SnippyModel, PoolReusesModelWithSameLayout) {
+  {
+    Model Cpu(makeConfig(LogFilePath));
+    runTrapProgram(Cpu);
+  }
+  {
+    // The same RAM, the idle model is given again with a new log file
+    Model Cpu(makeConfig(OtherLogFilePath));
+    Cpu.expectCleared();
+  }
+  auto FirstLog = readLog(LogFilePath);
+  EXPECT_EQ(countLines(FirstLog, StartLine), 1);
+  EXPECT_EQ(countLines(FirstLog, CompleteLine), 1);
+  auto SecondLog = readLog(OtherLogFilePath);
+  EXPECT_EQ(SecondLog.rfind(StartLine, 0), 0);
+  EXPECT_EQ(countLines(SecondLog, StartLine), 1);
+  EXPECT_EQ(countLines(SecondLog, CompleteLine), 1);
+}
+
+TEST(SnippyModel, PoolRecreatesModelWithOtherLayout) {
+  {
+    Model Cpu(makeConfig(LogFilePath));
+    runTrapProgram(Cpu);
+    EXPECT_ANY_THROW(Cpu.load({0x12345678}, 0x18000));
+  }
+  Model Cpu(makeConfig(LogFilePath, /* RamSize */ 0x20000));
+  Cpu.expectCleared();
+  Cpu.load({0x12345678}, 0x18000);
+  EXPECT_EQ(Cpu.readWord(0x18000), 0x12345678);
+}
+
+TEST(SnippyModel, ResetClearsModel) {
+  {
+    Model Cpu(makeConfig(LogFilePath));
+    runTrapProgram(Cpu);
+    Cpu.reset();
+    Cpu.expectCleared();
+  }
+  // The log goes on in the same file
+  auto Log = readLog(LogFilePath);
+  EXPECT_EQ(countLines(Log, StartLine), 2);
+  EXPECT_EQ(countLines(Log, CompleteLine), 2);
+}
+
+//------------------------------------CALLBACKS------------------------------------------
+
+TEST(SnippyModel, CallbacksReportEachChangeOnce) {
+  RVMCallbackHandler Handler;
+  auto Config = makeConfig(LogFilePath);
+  Config.CallbackHandler = &Handler;
+  Config.XRegUpdateCallback = onXRegUpdate;
+  Config.MemUpdateCallback = onMemUpdate;
+  Config.PCUpdateCallback = onPCUpdate;
+  Model Cpu(Config);
+  // addi ra, zero, 0x123; addi zero, zero, 1; sw ra, 0x100(zero);
+  // sh ra, 0x104(zero); sb ra, 0x106(zero); lw a2, 0x100(zero);
+  // addi t0, zero, 0x40; csrrw zero, mtvec, t0; .word 0xffffffff
+  Cpu.load({0x12300093, 0x00100013, 0x10102023, 0x10101223, 0x10100323,
+            0x10002603, 0x04000293, 0x30529073, Illegal});
+  using Updates = std::vector<std::string>;
+
+  EXPECT_EQ(Cpu.step(), 0);
+  EXPECT_EQ(Handler.take(), Updates({"x1 0x123", "pc 0x4"}));
+  // The write to X0 is not reported
+  EXPECT_EQ(Cpu.step(), 0);
+  EXPECT_EQ(Handler.take(), Updates({"pc 0x8"}));
+  // One callback per store with its bytes in the memory order
+  EXPECT_EQ(Cpu.step(), 0);
+  EXPECT_EQ(Handler.take(), Updates({"mem 0x100: 23 01 00 00", "pc 0xc"}));
+  EXPECT_EQ(Cpu.step(), 0);
+  EXPECT_EQ(Handler.take(), Updates({"mem 0x104: 23 01", "pc 0x10"}));
+  EXPECT_EQ(Cpu.step(), 0);
+  EXPECT_EQ(Handler.take(), Updates({"mem 0x106: 23", "pc 0x14"}));
+  EXPECT_EQ(Cpu.step(), 0);
+  EXPECT_EQ(Handler.take(), Updates({"x12 0x123", "pc 0x18"}));
+  EXPECT_EQ(Cpu.step(), 0);
+  EXPECT_EQ(Handler.take(), Updates({"x5 0x40", "pc 0x1c"}));
+  EXPECT_EQ(Cpu.step(), 0);
+  EXPECT_EQ(Handler.take(), Updates({"pc 0x20"}));
+  // The trap changes only the PC, to the handler at mtvec
+  EXPECT_EQ(Cpu.step(), 0);
+  EXPECT_EQ(Handler.take(), Updates({"pc 0x40"}));
+}
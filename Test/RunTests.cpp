@@ -28,8 +28,10 @@ template <size_t Sz>
 void generateProcess(const std::vector<Register<CHAR_BIT>> &Program,
                      std::ostream &ResultFile) {
   Memory<Sz> Mem;
-  CPU<decltype(Mem), InstrSet<decltype(Mem), RV32I::RV32IInstrSet>> Cpu{
-      Mem, ResultFile, /* IsForTests */ true};
+  CPU<decltype(Mem),
+      InstrSet<decltype(Mem), TraceLevel::Full, RV32I::RV32IInstrSet,
+               Zicsr::ZicsrInstrSet, Machine::MachineInstrSet>>
+      Cpu{Mem, ResultFile, /* IsForTests */ true};
   Cpu.execute(0 /* pc */, Program);
 }
 
@@ -44,7 +46,7 @@ void generateProcess(const std::vector<Register<CHAR_BIT>> &Program,
  */
 static void compileAsm(const std::string NameAsm, const std::string NameData) {
   auto Cmd1 =
-      "riscv64-unknown-linux-gnu-as -march=rv32i -mabi=ilp32 -o tmp.o " +
+      "riscv64-unknown-linux-gnu-as -march=rv32i_zicsr -mabi=ilp32 -o tmp.o " +
       NameAsm;
   decltype(Cmd1) Cmd2 = "riscv64-unknown-linux-gnu-ld -march=rv32i -m "
                         "elf32lriscv_ilp32 -o tmp.elf tmp.o";
@@ -104,3 +106,22 @@ void runOneSnippyModelTest(const std::string NameYaml,
   if (system(Cmd.c_str()) != 0)
     rvdash::failWithError("Error during snippy model-plugin test");
 }
+
+/**
+ * @brief runOneToolTest - it runs the commands of NameScript with bash,
+ *                         their output goes to NameResult. The script gets
+ *                         the paths of the simulator (RVDASH), of the trace
+ *                         tool (RVDASH_TRACE), of libSnippyRVdash.so
+ *                         (RVDASH_MODEL, if it is built), of the test binary
+ *                         (BIN) and of its ELF file (ELF).
+ */
+void runOneToolTest(const std::string NameScript, const std::string NameData,
+                    const std::string &NameResult) {
+  auto Cmd = std::string("RVDASH=") + RVDASH_SIM_PATH +
+             " RVDASH_TRACE=" + RVDASH_TRACE_PATH + " BIN=" + NameData +
+             " ELF=tmp.elf bash " + NameScript + " > " + NameResult + " 2>&1";
+#ifdef RVDASH_MODEL_PATH
+  Cmd = std::string("RVDASH_MODEL=") + RVDASH_MODEL_PATH + " " + Cmd;
+#endif
+  system(Cmd.c_str());
+}
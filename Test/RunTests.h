@@ -8,6 +8,8 @@ void compileOneTest(const std::string CurrTestDir, unsigned NumTest,
 void runOneTest(const std::string NameData, std::ostream &ResultFile);
 void runOneSnippyModelTest(const std::string NameYaml,
                            const std::string &NameResult);
+void runOneToolTest(const std::string NameScript, const std::string NameData,
+                    const std::string &NameResult);
 
 namespace rvdash {
 void failWithError(const std::string &Msg);
@@ -20,6 +22,7 @@ const std::string TestDir = "../../Test";
 const std::string rvdashTestsDir = TestDir + "/rvdashTests";
 const std::string ErrorHandlingTestsDir = TestDir + "/ErrorHandlingTests";
 const std::string SnippyRVdashTestsDir = TestDir + "/SnippyRVdashTests";
+const std::string ToolTestsDir = TestDir + "/ToolTests";
 const std::string SnippyPath = TestDir + "/Snippy/snippy-1.0/llvm-snippy";
 
 #endif // RUN_TESTS_H
@@ -30,6 +30,13 @@ const std::string getNameData(unsigned NumTest, const std::string Dir) {
   return DataDir + std::to_string(NumTest) + File;
 }
 
+static const std::string getNameScript(unsigned NumTest,
+                                        const std::string Dir) {
+  const auto DataDir = Dir + "/Data/";
+  const auto File = "_TestData.sh";
+  return DataDir + std::to_string(NumTest) + File;
+}
+
 const std::string getNameAsm(unsigned NumTest, const std::string Dir) {
   const auto DataDir = Dir + "/Data/";
   const auto File = "_TestData.S";
@@ -141,3 +148,30 @@ static void compileTest(const std::string CurrTestDir, unsigned NumTest,
 #include "SnippyRVdashTests/GenTests.h"
 
 #undef ADD_SNIPPY_MODEL_TEST
+
+/**
+ * @brief ADD_TOOL_TEST - these tests compile the program of the test and run
+ *                        the commands of its script (the simulator options,
+ *                        rvdash-trace) on it. The output of the commands is
+ *                        checked.
+ *
+ */
+#define ADD_TOOL_TEST(Num, TestsName)                                          \
+  TEST(TestsName, Test##Num) {                                                 \
+    auto CurrTestDir = TestsName##TestsDir;                                    \
+    auto NameData = getNameData(Num, CurrTestDir);                             \
+    auto NameResult = getNameResults(Num, CurrTestDir);                        \
+    {                                                                          \
+      std::ofstream ResultFile(NameResult);                                    \
+      if (!ResultFile.is_open())                                               \
+        rvdash::failWithError("Can't open file " + NameResult);                \
+      compileTest(CurrTestDir, Num, ResultFile);                               \
+    }                                                                          \
+    runOneToolTest(getNameScript(Num, CurrTestDir), NameData, NameResult);     \
+    EXPECT_TRUE(checkTrace(Num, CurrTestDir));                                 \
+  }
+
+//-------------------------------------TOOL_TESTS----------------------------------------
+#include "ToolTests/GenTests.h"
+
+#undef ADD_TOOL_TEST
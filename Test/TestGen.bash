@@ -2,7 +2,8 @@
 
 # This script runs from the CMakeLists.txt. 
 # Its first argument $1 is the path to the Test directory. 
-# It generates in each test subdirectory (rvdashTests, ErrorHandlingTests)
+# It generates in each test subdirectory (rvdashTests, ErrorHandlingTests,
+# ToolTests)
 # a header file GenTests.h with ADD_TEST macros. 
 # This file is included in the test file Test.cpp and Google test
 # functions TEST are created for each file from the Data directory.
@@ -40,6 +41,22 @@ fi
 echo "All tests for rvdash Error Handling are generated!"
 
 
+# generation ToolTests
+if [ -f "$1/ToolTests/GenTests.h" ]; then
+  rm $1/ToolTests/GenTests.h
+fi
+NumTest=1
+for i in $( ls $1/ToolTests/Data/*.S ); do
+  echo "ADD_TOOL_TEST("$NumTest", Tool)" >> GenTests.h
+  let NumTest=NumTest+1
+done
+mv GenTests.h $1/ToolTests
+if [ ! -d "$1/ToolTests/Results" ]; then
+  mkdir $1/ToolTests/Results
+fi
+echo "All tests for rvdash tools are generated!"
+
+
 # generation SnippyRVdashTests
 if [ ! -d "$1/Snippy" ]; then
   echo "Downloading Snippy from GitHub"
@@ -0,0 +1,6 @@
+# 10 Test: the instruction that takes a trap is not counted by --stats
+#
+# 9 instructions retire, the illegal one is not in the mix and the run is
+# not reported as sampled.
+
+$RVDASH --trace-level=none --stats $BIN
@@ -0,0 +1,18 @@
+# 11 Test: reverse steps across a handled trap
+#
+# The illegal instruction at 0xc does not retire, so a step from it takes
+# the trap and retires the first instruction of the handler. step and
+# reverse-step with the same count go back to the same state. The
+# snapshot after 3 instructions is before the trap, so the steps back to
+# the handler replay the trap.
+
+$RVDASH --debug - --reverse-interval 3 --trace-level=none $BIN <<END
+step 3
+step 1
+reverse-step 1
+step 1
+continue
+reverse-step 4
+reverse-continue 28
+step 2
+END
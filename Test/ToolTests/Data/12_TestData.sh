@@ -0,0 +1,13 @@
+# 12 Test: the Spike trace of a trap, of the CSR writes and of mret
+#
+# The illegal instruction has no commit line, Spike prints the exception
+# and its tval instead. The CSR writes are printed with the CSR number and
+# name, mret writes mstatus. The binary trace keeps them too, rvdash-trace
+# renders the same Spike trace from it.
+
+$RVDASH --trace-format=spike -t spike.txt $BIN
+$RVDASH --trace-format=binary -t trace.rvt $BIN
+$RVDASH_TRACE trace.rvt -f spike > rendered.txt
+cmp spike.txt rendered.txt && echo "The traces are the same"
+cat spike.txt
+rm spike.txt trace.rvt rendered.txt
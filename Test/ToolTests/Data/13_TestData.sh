@@ -0,0 +1,9 @@
+# 13 Test: the Spike commit log (--trace-format=spike)
+#
+# A commit line has the PC, the instruction word, the register write and
+# the memory access. The load address is printed at the full trace level
+# only, the commit level prints the loaded register.
+
+$RVDASH --trace-format=spike $BIN
+echo "Commit level"
+$RVDASH --trace-format=spike --trace-level=commit $BIN
@@ -0,0 +1,10 @@
+# 14 Test: the run statistics (--stats)
+#
+# The loop runs 10 times, 53 instructions retire. The mix is sorted by the
+# count, the instructions with the same count by the mnemonic. The program
+# and its data are on one page. The JSON report has the same counters.
+
+$RVDASH --trace-level=none --stats $BIN
+$RVDASH --trace-level=none --stats=stats.json $BIN
+cat stats.json
+rm stats.json
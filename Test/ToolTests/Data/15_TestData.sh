@@ -0,0 +1,12 @@
+# 15 Test: the profile by call stacks (--call-graph)
+#
+# _start calls foo 3 times, foo calls bar. Every instruction is counted
+# for the stack it runs on, the call is counted for the caller. Without
+# --symbols the functions are printed as addresses.
+
+$RVDASH --trace-level=none --call-graph stacks.txt --symbols $ELF $BIN
+cat stacks.txt
+echo "Without symbols"
+$RVDASH --trace-level=none --call-graph stacks.txt $BIN
+cat stacks.txt
+rm stacks.txt
@@ -0,0 +1,10 @@
+# 16 Test: the L1 cache models (--icache, --dcache)
+#
+# The loop of 18 instructions is on 2 lines of the I-cache, they miss once.
+# In the direct-mapped D-cache the store to 0x100 and the load from 0x140
+# evict each other: all 8 accesses miss and the dirty line is written back
+# 4 times. In the 2-way cache both lines stay, only the first accesses
+# miss. --stats reports the hit rates too.
+
+$RVDASH --trace-level=none --icache 64:1:16 --dcache 64:1:16 $BIN
+$RVDASH --trace-level=none --icache 64:1:16 --dcache 128:2:16 --stats $BIN
@@ -0,0 +1,8 @@
+# 17 Test: the branch predictor models (--branch-predictors)
+#
+# The inner loop branch runs 40 times and is not taken 10 times, the outer
+# one runs 10 times and is not taken once. The static predictor (backward
+# is taken) misses exactly the not taken ones: 11 of 112 instructions. The
+# counts of all models are deterministic.
+
+$RVDASH --trace-level=none --branch-predictors static,bimodal,gshare,tage,btb $BIN
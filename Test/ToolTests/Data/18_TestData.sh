@@ -0,0 +1,11 @@
+# 18 Test: the pipeline timing model (--timing)
+#
+# 22 instructions take 22 cycles, 4 more fill the pipeline. Every load is
+# used at once (1 stall with the load latency 2) and every taken branch
+# costs 2 cycles. With a predictor only its misprediction is paid. With
+# the I-cache the 2 misses cost 20 cycles each, the cycles are also given
+# per function of the ELF symbols.
+
+$RVDASH --trace-level=none --timing $BIN
+$RVDASH --trace-level=none --timing=1:3:20:4:20 --branch-predictors static $BIN
+$RVDASH --trace-level=none --timing --icache 64:1:16 --symbols $ELF $BIN
@@ -0,0 +1,11 @@
+# 19 Test: the sampled simulation (--sample)
+#
+# 112 instructions: 10 are fast-forwarded, then every 20 instructions 5
+# warm up and 8 are detailed. The window at 110 has only 2 warm-up
+# instructions before the end. The analyses and the --stats counts are for
+# the 40 detailed instructions. Without the period only one window is
+# traced.
+
+$RVDASH --trace-level=none --sample=10:5:8:20 --stats --branch-predictors static $BIN
+echo "One window"
+$RVDASH --sample=100:0:3 $BIN
@@ -0,0 +1,8 @@
+# 1 Test: rvdash-trace renders the binary trace as the text trace (ecall)
+
+$RVDASH -t text.txt $BIN
+$RVDASH --trace-format=binary -t trace.rvt $BIN
+$RVDASH_TRACE trace.rvt > rendered.txt
+cmp text.txt rendered.txt && echo "The traces are the same"
+cat rendered.txt
+rm text.txt trace.rvt rendered.txt
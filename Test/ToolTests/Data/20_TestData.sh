@@ -0,0 +1,18 @@
+# 20 Test: lockstep with an interval between the comparisons
+#
+# The stores made between two comparisons are all checked, so the result
+# does not depend on the interval. The last instruction is always compared
+# even if the interval is not over. Zero interval is an error.
+
+if [ -z "$RVDASH_MODEL" ]; then
+  echo "The reference model is not built"
+  exit 1
+fi
+$RVDASH --lockstep $RVDASH_MODEL --lockstep-interval 1 --trace-level=none $BIN
+echo "Exit code $?"
+$RVDASH --lockstep $RVDASH_MODEL --lockstep-interval 7 --trace-level=none $BIN
+echo "Exit code $?"
+$RVDASH --lockstep $RVDASH_MODEL --lockstep-interval 1000 --trace-level=none $BIN
+echo "Exit code $?"
+$RVDASH --lockstep $RVDASH_MODEL --lockstep-interval 0 $BIN 2>&1
+echo "Exit code $?"
@@ -0,0 +1,11 @@
+# 2 Test: reverse execution restores the machine CSRs (mepc)
+#
+# The snapshot before the first mret is restored after the second trap
+# changed mepc, mret must return after the first illegal instruction.
+
+$RVDASH --debug - --reverse-interval 2 -t trace.txt $BIN <<END
+continue
+reverse-step 6
+step
+END
+rm trace.txt
@@ -0,0 +1,11 @@
+# 3 Test: checkpoint keeps the machine CSRs (mepc)
+#
+# The checkpoint is saved in the trap handler right before mret, the
+# restored run must return after the first illegal instruction and come to
+# the state of the full run.
+
+$RVDASH --state-hash --checkpoint-at 6 --checkpoint-out checkpoint.bin \
+        -t trace.txt $BIN
+$RVDASH --restore checkpoint.bin --state-hash -t restored.txt
+cat restored.txt
+rm trace.txt checkpoint.bin restored.txt
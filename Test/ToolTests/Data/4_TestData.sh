@@ -0,0 +1,8 @@
+# 4 Test: lockstep, the syscalls are done once (read, write)
+#
+# The reference model takes the results of the syscalls from rvdash: the
+# input is read once, the output is written once and the log of the
+# reference is not printed.
+
+echo "Echo from rvdash" | $RVDASH --lockstep $RVDASH_MODEL --trace-level=none $BIN
+echo "Exit code $?"
@@ -0,0 +1,5 @@
+# 5 Test: syscalls return their results in a0 (read, write, brk, fstat)
+#
+# The trace goes to stdout too, so the output follows its trace line.
+
+echo "Input of rvdash" | $RVDASH $BIN
@@ -0,0 +1,13 @@
+# 6 Test: record and replay of the syscalls
+#
+# The replay takes the input from the log, not from stdin. The replay that
+# starts from the second instruction comes to the read earlier than the
+# recorded run and stops.
+
+echo "Recorded input" | $RVDASH --record syscalls.log --trace-level=none $BIN
+echo "Other input" | $RVDASH --replay syscalls.log --trace-level=none $BIN
+echo "Other input" | $RVDASH --replay syscalls.log --skip-output \
+                             --trace-level=none $BIN
+echo "Skipped output"
+echo "Other input" | $RVDASH --replay syscalls.log --trace-level=none -p 4 $BIN
+rm syscalls.log
@@ -0,0 +1,16 @@
+# 7 Test: debugger, step, continue, reverse-step and reverse-continue
+#
+# The write is executed again after the reverse steps, its output is
+# printed once.
+
+$RVDASH --debug - --reverse-interval 4 --trace-level=none $BIN <<END
+step 3
+continue 20
+reverse-continue 8
+regs
+reverse-step 2
+step
+continue
+reverse-step 6
+continue
+END
@@ -0,0 +1,8 @@
+# 8 Test: ELF file, the entry point and the symbols
+#
+# The ELF file is run without objcopy, the profile finds the functions in
+# its symbol table.
+
+$RVDASH --profile -t trace.txt $ELF
+head -n 2 trace.txt
+rm trace.txt
@@ -0,0 +1,10 @@
+# 9 Test: checkpoint save and restore, the same state at the end
+#
+# The checkpoint is saved in the middle of the loop, the restored run
+# writes the rest of the buffer and comes to the state hash of the full
+# run.
+
+$RVDASH --state-hash --checkpoint-at 10 --checkpoint-out checkpoint.bin \
+        --trace-level=none $BIN
+$RVDASH --restore checkpoint.bin --state-hash --trace-level=none
+rm checkpoint.bin
@@ -0,0 +1,237 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <array>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Error.h"
+
+namespace rvdash {
+
+//-------------------------------------CacheConfig---------------------------------------
+
+enum class ReplacementKind { LRU, PLRU, Random };
+
+/**
+ * @brief struct CacheConfig - geometry and replacement policy of one cache.
+ *                             LineSz and the number of sets must be powers
+ *                             of two, PLRU also needs the power of two
+ *                             associativity (at most 64).
+ */
+struct CacheConfig {
+  uint64_t Size = 32 * 1024 /* bytes */;
+  unsigned Assoc = 8;
+  unsigned LineSz = 64 /* bytes */;
+  ReplacementKind Policy = ReplacementKind::LRU;
+};
+
+//--------------------------------------CacheModel---------------------------------------
+
+/**
+ * @brief class CacheModel - tags of a set-associative write-back,
+ *                           write-allocate cache. It does not keep the data
+ *                           (the functional memory has it), only the hit,
+ *                           miss and writeback counters.
+ */
+class CacheModel {
+  CacheConfig Config;
+  unsigned NumSets;
+  unsigned LineBits;
+
+  struct Line {
+    uint64_t Tag = 0;
+    // Last access for LRU
+    uint64_t Stamp = 0;
+    bool Valid = false;
+    bool Dirty = false;
+  };
+  std::vector<Line> Lines;
+  // Tree bits of PLRU, one word per set
+  std::vector<uint64_t> PlruTrees;
+  uint64_t Clock = 0;
+  uint64_t RandomState = 0x9e3779b97f4a7c15ull;
+  // Counters saved while the counting is off
+  std::optional<std::array<uint64_t, 5>> SavedCounters;
+
+public:
+  uint64_t Reads = 0;
+  uint64_t Writes = 0;
+  uint64_t ReadMisses = 0;
+  uint64_t WriteMisses = 0;
+  uint64_t Writebacks = 0;
+
+  CacheModel(const CacheConfig &Cfg) : Config(Cfg) {
+    auto IsPow2 = [](uint64_t Value) {
+      return Value != 0 && (Value & (Value - 1)) == 0;
+    };
+    if (!IsPow2(Config.LineSz))
+      failWithError("Cache line size must be a power of two");
+    if (Config.Assoc == 0)
+      failWithError("Zero cache associativity");
+    if (Config.Size < uint64_t(Config.LineSz) * Config.Assoc)
+      failWithError("Cache is smaller than one set");
+    NumSets = Config.Size / Config.LineSz / Config.Assoc;
+    if (!IsPow2(NumSets) || uint64_t(NumSets) * Config.LineSz * Config.Assoc !=
+                                Config.Size)
+      failWithError("Number of cache sets must be a power of two");
+    if (Config.Policy == ReplacementKind::PLRU &&
+        (!IsPow2(Config.Assoc) || Config.Assoc > 64))
+      failWithError("PLRU needs a power of two associativity up to 64");
+    LineBits = __builtin_ctzll(Config.LineSz);
+    Lines.resize(uint64_t(NumSets) * Config.Assoc);
+    PlruTrees.resize(NumSets);
+  }
+
+  const CacheConfig &getConfig() const { return Config; }
+
+  /**
+   * @brief setCounting - when the counting is off, the accesses change the
+   *                      contents of the cache, but not its counters (the
+   *                      warm-up of the sampled simulation).
+   */
+  void setCounting(bool Enable) {
+    if (!Enable && !SavedCounters.has_value()) {
+      SavedCounters = {Reads, Writes, ReadMisses, WriteMisses, Writebacks};
+    } else if (Enable && SavedCounters.has_value()) {
+      auto &Saved = SavedCounters.value();
+      Reads = Saved[0];
+      Writes = Saved[1];
+      ReadMisses = Saved[2];
+      WriteMisses = Saved[3];
+      Writebacks = Saved[4];
+      SavedCounters.reset();
+    }
+  }
+  uint64_t getAccesses() const { return Reads + Writes; }
+  uint64_t getMisses() const { return ReadMisses + WriteMisses; }
+
+  /**
+   * @brief access - it models the access of Size bytes at Addr and returns
+   *                 the number of missed lines (an access can cross a line
+   *                 boundary).
+   */
+  unsigned access(uint64_t Addr, unsigned Size, bool IsWrite) {
+    auto First = Addr >> LineBits;
+    auto Last = (Addr + Size - 1) >> LineBits;
+    unsigned Misses = 0;
+    for (auto LineAddr = First; LineAddr <= Last; ++LineAddr)
+      Misses += !accessLine(LineAddr, IsWrite);
+    (IsWrite ? Writes : Reads) += 1;
+    (IsWrite ? WriteMisses : ReadMisses) += Misses != 0;
+    return Misses;
+  }
+
+  void report(std::ostream &Stream, const std::string &Name) const {
+    auto OldFlags = Stream.flags();
+    auto OldPrecision = Stream.precision();
+    Stream << std::fixed << std::setprecision(3);
+    Stream << Name << " (" << Config.Size << " bytes, " << Config.Assoc
+           << "-way, " << Config.LineSz << " byte lines, "
+           << getPolicyName() << "):\n";
+    Stream << "  Reads:        " << Reads << " (misses " << ReadMisses
+           << ")\n";
+    Stream << "  Writes:       " << Writes << " (misses " << WriteMisses
+           << ")\n";
+    Stream << "  Hit rate:     "
+           << (getAccesses() == 0
+                   ? 0.0
+                   : 100.0 * (getAccesses() - getMisses()) / getAccesses())
+           << "%\n";
+    Stream << "  Writebacks:   " << Writebacks << "\n";
+    Stream.flags(OldFlags);
+    Stream.precision(OldPrecision);
+  }
+
+  const char *getPolicyName() const {
+    switch (Config.Policy) {
+    case ReplacementKind::LRU:
+      return "LRU";
+    case ReplacementKind::PLRU:
+      return "PLRU";
+    case ReplacementKind::Random:
+      return "random";
+    }
+    return "";
+  }
+
+private:
+  bool accessLine(uint64_t LineAddr, bool IsWrite) {
+    unsigned SetIdx = LineAddr & (NumSets - 1);
+    uint64_t Tag = LineAddr / NumSets;
+    auto *Set = &Lines[uint64_t(SetIdx) * Config.Assoc];
+    ++Clock;
+    for (unsigned Way = 0; Way < Config.Assoc; ++Way)
+      if (Set[Way].Valid && Set[Way].Tag == Tag) {
+        touch(SetIdx, Set, Way);
+        Set[Way].Dirty |= IsWrite;
+        return true;
+      }
+    auto Way = findVictim(SetIdx, Set);
+    Writebacks += Set[Way].Valid && Set[Way].Dirty;
+    Set[Way] = {Tag, Clock, /* Valid */ true, IsWrite};
+    touch(SetIdx, Set, Way);
+    return false;
+  }
+
+  void touch(unsigned SetIdx, Line *Set, unsigned Way) {
+    switch (Config.Policy) {
+    case ReplacementKind::LRU:
+      Set[Way].Stamp = Clock;
+      break;
+    case ReplacementKind::PLRU: {
+      // Every node on the path points away from the accessed way
+      auto &Tree = PlruTrees[SetIdx];
+      unsigned Node = 0;
+      for (unsigned Bit = Config.Assoc >> 1; Bit != 0; Bit >>= 1) {
+        bool Right = Way & Bit;
+        Tree = Right ? Tree & ~(1ull << Node) : Tree | (1ull << Node);
+        Node = 2 * Node + 1 + Right;
+      }
+      break;
+    }
+    case ReplacementKind::Random:
+      break;
+    }
+  }
+
+  unsigned findVictim(unsigned SetIdx, Line *Set) {
+    for (unsigned Way = 0; Way < Config.Assoc; ++Way)
+      if (!Set[Way].Valid)
+        return Way;
+    switch (Config.Policy) {
+    case ReplacementKind::LRU: {
+      unsigned Victim = 0;
+      for (unsigned Way = 1; Way < Config.Assoc; ++Way)
+        if (Set[Way].Stamp < Set[Victim].Stamp)
+          Victim = Way;
+      return Victim;
+    }
+    case ReplacementKind::PLRU: {
+      auto Tree = PlruTrees[SetIdx];
+      unsigned Node = 0, Way = 0;
+      for (unsigned Bit = Config.Assoc >> 1; Bit != 0; Bit >>= 1) {
+        bool Right = Tree & (1ull << Node);
+        Way |= Right ? Bit : 0;
+        Node = 2 * Node + 1 + Right;
+      }
+      return Way;
+    }
+    case ReplacementKind::Random:
+      // xorshift64, the same sequence in every run
+      RandomState ^= RandomState << 13;
+      RandomState ^= RandomState >> 7;
+      RandomState ^= RandomState << 17;
+      return RandomState % Config.Assoc;
+    }
+    return 0;
+  }
+};
+
+} // namespace rvdash
+
+#endif // CACHE_H
@@ -0,0 +1,91 @@
+#ifndef CACHED_MEMORY_H
+#define CACHED_MEMORY_H
+
+#include <optional>
+
+#include "Memory/Cache.h"
+
+namespace rvdash {
+
+//------------------------------------HasCacheModel--------------------------------------
+
+/**
+ * @brief concept HasCacheModel - the memory type has the cache model, the
+ *                                instruction set reports its fetches and
+ *                                data accesses to it. Plain Memory does not,
+ *                                so the functional model pays nothing.
+ */
+template <typename MemoryType>
+concept HasCacheModel = requires(MemoryType &Mem) {
+  Mem.accessICache(0ull, 0u);
+  Mem.accessDCache(0ull, 0u, false);
+};
+
+//------------------------------------CachedMemory---------------------------------------
+
+/**
+ * @brief class CachedMemory - MemoryType (functional memory) with the models
+ *                             of the L1 instruction and data caches. Any of
+ *                             them can be absent. Only the accesses of the
+ *                             instructions go through the caches: loading
+ *                             of the program and the model interface work
+ *                             with the memory directly.
+ */
+template <typename MemoryType> class CachedMemory : public MemoryType {
+  std::optional<CacheModel> ICache;
+  std::optional<CacheModel> DCache;
+  // Lines missed by the last fetch and the last data access
+  unsigned LastIMisses = 0;
+  unsigned LastDMisses = 0;
+
+public:
+  CachedMemory(std::optional<CacheConfig> ICfg,
+               std::optional<CacheConfig> DCfg,
+               unsigned long long RamStrt = 0 /* bytes */,
+               unsigned long long RamSz = 1ull << 20 /* 1 MB */)
+      : MemoryType(RamStrt, RamSz) {
+    if (ICfg.has_value())
+      ICache.emplace(ICfg.value());
+    if (DCfg.has_value())
+      DCache.emplace(DCfg.value());
+  }
+
+  void accessICache(unsigned long long Addr, unsigned Size) {
+    if (ICache.has_value())
+      LastIMisses = ICache->access(Addr, Size, /* IsWrite */ false);
+  }
+
+  void accessDCache(unsigned long long Addr, unsigned Size, bool IsWrite) {
+    if (DCache.has_value())
+      LastDMisses = DCache->access(Addr, Size, IsWrite);
+  }
+
+  /**
+   * @brief setCacheCounting - it turns the counters of both caches on or off
+   *                           (see CacheModel::setCounting).
+   */
+  void setCacheCounting(bool Enable) {
+    if (ICache.has_value())
+      ICache->setCounting(Enable);
+    if (DCache.has_value())
+      DCache->setCounting(Enable);
+  }
+
+  unsigned getLastIMisses() const { return LastIMisses; }
+  unsigned getLastDMisses() const { return LastDMisses; }
+  const std::optional<CacheModel> &getICache() const { return ICache; }
+  const std::optional<CacheModel> &getDCache() const { return DCache; }
+
+  void reportCaches(std::ostream &Stream) const {
+    Stream << "====================rvdash caches===================\n";
+    if (ICache.has_value())
+      ICache->report(Stream, "L1 I-cache");
+    if (DCache.has_value())
+      DCache->report(Stream, "L1 D-cache");
+    Stream << "====================================================\n";
+  }
+};
+
+} // namespace rvdash
+
+#endif // CACHED_MEMORY_H
@@ -1,13 +1,18 @@
 #ifndef MEMORY_H
 #define MEMORY_H
 
+#include <algorithm>
 #include <bitset>
 #include <climits>
 #include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
 #include <set>
 #include <vector>
 
 #include "Error.h"
+#include "StateHash.h"
 
 namespace rvdash {
 
@@ -20,6 +25,8 @@ namespace rvdash {
 template <unsigned PageSz> struct Page {
   unsigned long long FirstAddr;
   mutable std::bitset<PageSz> Space;
+  // It was written after the last snapshot of the memory
+  mutable bool Dirty = false;
 
   Page(unsigned long long First) : FirstAddr(First) { Space = 0; };
 
@@ -51,6 +58,24 @@ template <unsigned PageSz> struct Page {
       failWithError("Storing addresses not belonging to this page");
     for (auto Idx = Begin - FirstAddr; Idx < End - FirstAddr; ++Idx, ++It)
       Space[Idx] = *It;
+    Dirty = true;
+  }
+
+  /**
+   * @brief getByte, setByte - the byte at Offset bytes from the beginning of
+   *                           the page.
+   */
+  unsigned char getByte(unsigned long long Offset) const {
+    unsigned char Byte = 0;
+    for (unsigned Bit = 0; Bit < CHAR_BIT; ++Bit)
+      Byte |= Space[Offset * CHAR_BIT + Bit] << Bit;
+    return Byte;
+  }
+
+  void setByte(unsigned long long Offset, unsigned char Byte) const {
+    for (unsigned Bit = 0; Bit < CHAR_BIT; ++Bit)
+      Space[Offset * CHAR_BIT + Bit] = (Byte >> Bit) & 1;
+    Dirty = true;
   }
 
   void dump(std::ostream &Stream) const {
@@ -91,6 +116,76 @@ std::ostream &operator<<(std::ostream &Stream, const Page<PageSz> &Pg) {
   return Stream;
 }
 
+//-----------------------------------PageSource------------------------------------------
+
+/**
+ * @brief class PageSource - contents of the pages that are not in Memory yet
+ *                           (for example, mapped from a checkpoint file).
+ *                           Memory takes a page from it when the page is
+ *                           allocated, so untouched pages cost nothing.
+ */
+class PageSource {
+public:
+  virtual ~PageSource() = default;
+  /**
+   * @brief findPage - bytes of the page starting at Addr (in bytes) or
+   *                   nullptr if the source does not have it.
+   */
+  virtual const unsigned char *findPage(unsigned long long Addr) const = 0;
+  virtual std::vector<unsigned long long> getPageAddrs() const = 0;
+};
+
+//----------------------------------MemorySnapshot---------------------------------------
+
+/**
+ * @brief class MemorySnapshot - contents of Memory at some moment (see
+ *                               Memory::takeSnapshot). The pages that did
+ *                               not change since the previous snapshot are
+ *                               shared with it, the pages that were never
+ *                               written are taken from the source below it
+ *                               (the program or a checkpoint).
+ */
+class MemorySnapshot : public PageSource {
+public:
+  using PageBytes = std::shared_ptr<const std::vector<unsigned char>>;
+
+private:
+  // By the address in bytes
+  std::map<unsigned long long, PageBytes> Pages;
+  std::shared_ptr<const PageSource> Below;
+  uint64_t StateHash;
+
+public:
+  MemorySnapshot(std::map<unsigned long long, PageBytes> SnapshotPages,
+                 std::shared_ptr<const PageSource> Source, uint64_t Hash)
+      : Pages(std::move(SnapshotPages)), Below(std::move(Source)),
+        StateHash(Hash) {}
+
+  const std::map<unsigned long long, PageBytes> &getPages() const {
+    return Pages;
+  }
+  const std::shared_ptr<const PageSource> &getBelow() const { return Below; }
+  uint64_t getStateHash() const { return StateHash; }
+
+  const unsigned char *findPage(unsigned long long Addr) const override {
+    auto It = Pages.find(Addr);
+    if (It != Pages.end())
+      return It->second->data();
+    return Below == nullptr ? nullptr : Below->findPage(Addr);
+  }
+
+  std::vector<unsigned long long> getPageAddrs() const override {
+    std::vector<unsigned long long> Addrs;
+    if (Below != nullptr)
+      Addrs = Below->getPageAddrs();
+    for (auto &[Addr, Bytes] : Pages)
+      Addrs.push_back(Addr);
+    std::sort(Addrs.begin(), Addrs.end());
+    Addrs.erase(std::unique(Addrs.begin(), Addrs.end()), Addrs.end());
+    return Addrs;
+  }
+};
+
 //-------------------------------------Memory--------------------------------------------
 
 /**
@@ -108,12 +203,16 @@ class Memory {
   unsigned long long RamStart /* bits */;
   unsigned long long RamSize /* bits */;
   std::set<Page<PageSz>> Pages;
+  // Xor of hashStateElem for all bytes, updated by every store
+  uint64_t StateHash = 0;
+  // Pages that are filled on the first access
+  std::shared_ptr<const PageSource> LazyPages;
 
 public:
   Memory(unsigned long long RamStrt = 0 /* bytes */,
          unsigned long long RamSz = 1ull << 20 /* 1 MB */)
       : RamStart(RamStrt * CHAR_BIT), RamSize(RamSz * CHAR_BIT) {
-    if ((RamStart + RamSize) >= (1ull << AddrSz))
+    if ((RamStart + RamSize) / CHAR_BIT > (1ull << AddrSz))
       failWithError("RAM addresses exceeds addr space size " +
                     std::to_string(1ull << AddrSz));
   };
@@ -122,7 +221,128 @@ public:
   constexpr static unsigned long long getPageSz() { return PageSz; }
   constexpr static unsigned long long getDefaultRamStart() { return 0; }
   constexpr static unsigned long long getDefaultRamSz() { return 1ull << 20; }
+  unsigned long long getRamStart() const { return RamStart / CHAR_BIT; }
+  unsigned long long getRamSize() const { return RamSize / CHAR_BIT; }
   const std::set<Page<PageSz>> &getPages() const { return Pages; }
+  uint64_t getStateHash() const { return StateHash; }
+
+  /**
+   * @brief setLazyPages - the pages of Source become the contents of the
+   *                       memory. They are copied on the first access, Hash
+   *                       is the state hash of the memory with them.
+   */
+  void setLazyPages(std::shared_ptr<const PageSource> Source, uint64_t Hash) {
+    Pages.clear();
+    LazyPages = std::move(Source);
+    StateHash = Hash;
+  }
+
+  /**
+   * @brief isAccessible - Size bytes at Addr are in RAM. The instruction
+   *                       accesses check it and raise an access fault
+   *                       instead of the error of validate.
+   */
+  bool isAccessible(unsigned long long Addr, unsigned long long Size) const {
+    auto Begin = Addr * CHAR_BIT;
+    return Begin >= RamStart && Begin < RamStart + RamSize &&
+           Size * CHAR_BIT <= RamStart + RamSize - Begin;
+  }
+
+  /**
+   * @brief reset - the memory is empty again, as after the construction. It
+   *                costs the pages that were touched.
+   */
+  void reset() { setLazyPages(nullptr, 0); }
+
+  /**
+   * @brief loadLazyPages - it copies all pages that are still in the page
+   *                        source (before the pages are saved).
+   */
+  void loadLazyPages() {
+    if (LazyPages == nullptr)
+      return;
+    for (auto Addr : LazyPages->getPageAddrs())
+      allocate(Addr * CHAR_BIT, PageSz);
+  }
+
+  /**
+   * @brief takeSnapshot - it saves the contents of the memory. Only the pages
+   *                       written after the previous snapshot are copied,
+   *                       the rest is shared with it, so a snapshot costs
+   *                       the pages the program has changed. The snapshot
+   *                       becomes the page source of the memory.
+   */
+  std::shared_ptr<const MemorySnapshot> takeSnapshot() {
+    std::map<unsigned long long, MemorySnapshot::PageBytes> SnapshotPages;
+    auto Below = LazyPages;
+    if (auto Prev =
+            std::dynamic_pointer_cast<const MemorySnapshot>(LazyPages)) {
+      SnapshotPages = Prev->getPages();
+      Below = Prev->getBelow();
+    }
+    for (auto &Pg : Pages)
+      if (Pg.Dirty) {
+        SnapshotPages[Pg.FirstAddr / CHAR_BIT] =
+            std::make_shared<const std::vector<unsigned char>>(
+                getPageBytes(Pg));
+        Pg.Dirty = false;
+      }
+    auto Snapshot = std::make_shared<const MemorySnapshot>(
+        std::move(SnapshotPages), std::move(Below), StateHash);
+    LazyPages = Snapshot;
+    return Snapshot;
+  }
+
+  /**
+   * @brief restoreSnapshot - the contents of Snapshot become the contents of
+   *                          the memory, the pages are copied back on the
+   *                          first access.
+   */
+  void restoreSnapshot(std::shared_ptr<const MemorySnapshot> Snapshot) {
+    auto Hash = Snapshot->getStateHash();
+    setLazyPages(std::move(Snapshot), Hash);
+  }
+
+  /**
+   * @brief getPageBytes - contents of Pg, byte by byte.
+   */
+  static std::vector<unsigned char> getPageBytes(const Page<PageSz> &Pg) {
+    std::vector<unsigned char> Bytes(PageSz / CHAR_BIT);
+    for (size_t Byte = 0; Byte < Bytes.size(); ++Byte)
+      Bytes[Byte] = Pg.getByte(Byte);
+    return Bytes;
+  }
+
+  /**
+   * @brief loadBytes, storeBytes - bulk accesses of Size bytes at Addr for
+   *                                the host side (the buffers of the
+   *                                syscalls): the range is checked and the
+   *                                page is found once per page, not per
+   *                                byte.
+   */
+  void loadBytes(unsigned long long Addr, unsigned long long Size,
+                 unsigned char *Bytes) {
+    forEachPagePart(Addr, Size, [&](const Page<PageSz> &Pg, auto Offset,
+                                    auto Count) {
+      for (decltype(Count) Idx = 0; Idx < Count; ++Idx)
+        *Bytes++ = Pg.getByte(Offset + Idx);
+    });
+  }
+
+  void storeBytes(unsigned long long Addr, unsigned long long Size,
+                  const unsigned char *Bytes) {
+    forEachPagePart(Addr, Size, [&](const Page<PageSz> &Pg, auto Offset,
+                                    auto Count) {
+      auto ByteAddr = Pg.FirstAddr / CHAR_BIT + Offset;
+      for (decltype(Count) Idx = 0; Idx < Count; ++Idx, ++Bytes) {
+        StateHash ^=
+            hashStateElem(MEMORY_HASH_DOMAIN, ByteAddr + Idx,
+                          Pg.getByte(Offset + Idx)) ^
+            hashStateElem(MEMORY_HASH_DOMAIN, ByteAddr + Idx, *Bytes);
+        Pg.setByte(Offset + Idx, *Bytes);
+      }
+    });
+  }
 
   template <typename RegisterType>
   void load(unsigned long long Addr, unsigned long long Size,
@@ -137,13 +357,6 @@ public:
       Reg[Idx] = Bits[Idx];
   }
 
-  template <typename RegisterType>
-  void load(unsigned long long Addr, unsigned long long Size, RegisterType &Reg,
-            std::ostream &LogFile) {
-    load(Addr, Size, Reg);
-    logGet(Addr * CHAR_BIT, Size * CHAR_BIT, Reg, LogFile);
-  }
-
   std::vector<bool> load(unsigned long long Addr, unsigned long long Size) {
     Addr *= CHAR_BIT;
     Size *= CHAR_BIT;
@@ -163,21 +376,16 @@ public:
     Bits.reserve(Reg.size());
     for (auto Idx = 0; Idx < Size; ++Idx)
       Bits.push_back(Reg[Idx]);
+    updateStateHash(Addr, Bits);
     setBits(Addr, Bits);
   }
 
-  template <typename RegisterType>
-  void store(unsigned long long Addr, unsigned long long Size,
-             const RegisterType &Reg, std::ostream &LogFile) {
-    store(Addr, Size, Reg);
-    logChange(Addr * CHAR_BIT, Size * CHAR_BIT, Reg, LogFile);
-  }
-
   void store(unsigned long long Addr, unsigned long long Size) {
     Addr *= CHAR_BIT;
     Size *= CHAR_BIT;
     validate(Addr, Size);
     std::vector<bool> Bits(Size, 1);
+    updateStateHash(Addr, Bits);
     setBits(Addr, Bits);
   }
 
@@ -207,6 +415,44 @@ public:
   void print() const { dump(std::cout); }
 
 private:
+  /**
+   * @brief forEachPagePart - it splits [Addr, Addr + Size) (in bytes) by
+   *                          the pages and calls Func with the page, the
+   *                          offset in it and the number of bytes.
+   */
+  template <typename FuncType>
+  void forEachPagePart(unsigned long long Addr, unsigned long long Size,
+                       FuncType Func) {
+    constexpr unsigned long long PageBytes = PageSz / CHAR_BIT;
+    while (Size != 0) {
+      auto Offset = Addr % PageBytes;
+      auto Count = std::min(Size, PageBytes - Offset);
+      validate(Addr * CHAR_BIT, Count * CHAR_BIT);
+      Func(*getFirstPage(Addr * CHAR_BIT), Offset, Count);
+      Addr += Count;
+      Size -= Count;
+    }
+  }
+
+  /**
+   * @brief updateStateHash - replaces the contributions of the bytes at Addr
+   *                          (in bits) with the contributions of NewBits.
+   */
+  void updateStateHash(unsigned long long Addr,
+                       const std::vector<bool> &NewBits) {
+    auto OldBits = getBits(Addr, NewBits.size());
+    for (size_t Byte = 0; Byte < NewBits.size() / CHAR_BIT; ++Byte) {
+      uint64_t Old = 0, New = 0;
+      for (unsigned Bit = 0; Bit < CHAR_BIT; ++Bit) {
+        Old |= uint64_t(OldBits[Byte * CHAR_BIT + Bit]) << Bit;
+        New |= uint64_t(NewBits[Byte * CHAR_BIT + Bit]) << Bit;
+      }
+      auto ByteAddr = Addr / CHAR_BIT + Byte;
+      StateHash ^= hashStateElem(MEMORY_HASH_DOMAIN, ByteAddr, Old) ^
+                   hashStateElem(MEMORY_HASH_DOMAIN, ByteAddr, New);
+    }
+  }
+
   std::vector<bool> getBits(unsigned long long Addr,
                             unsigned long long Size) const {
     const auto First = getFirstPage(Addr);
@@ -246,30 +492,6 @@ private:
     }
   }
 
-  template <typename RegisterType>
-  void printBits(unsigned long long Size, const RegisterType &Bits,
-                 std::ostream &LogFile) const {
-    LogFile << " 0x" << std::hex << Bits.to_ulong() << std::dec << "\n";
-  }
-
-  template <typename RegisterType>
-  void logChange(unsigned long long Addr, unsigned long long Size,
-                 const RegisterType &Bits, std::ostream &LogFile) const {
-    LogFile << "Changed memory bytes [" << std::hex << "0x" << Addr / CHAR_BIT
-            << ", "
-            << "0x" << (Addr + Size) / CHAR_BIT << "] <-" << std::dec;
-    printBits(Size, Bits, LogFile);
-  }
-
-  template <typename RegisterType>
-  void logGet(unsigned long long Addr, unsigned long long Size,
-              const RegisterType &Bits, std::ostream &LogFile) const {
-    LogFile << "Read memory bytes [" << std::hex << "0x" << Addr / CHAR_BIT
-            << ", "
-            << "0x" << (Addr + Size) / CHAR_BIT << "] ->" << std::dec;
-    printBits(Size, Bits, LogFile);
-  }
-
   void validate(unsigned long long Addr, unsigned long long Size) {
     if (Addr >= (RamStart + RamSize) || Addr < RamStart)
       failWithError("Invalid memory access, address " + std::to_string(Addr) +
@@ -285,7 +507,14 @@ private:
 
   void allocate(unsigned long long Addr, unsigned long long Size) {
     auto StartAddr = Addr / PageSz * PageSz;
-    Pages.insert(Page<PageSz>(StartAddr));
+    auto [PageIt, Inserted] = Pages.insert(Page<PageSz>(StartAddr));
+    if (Inserted && LazyPages != nullptr)
+      if (auto *Bytes = LazyPages->findPage(StartAddr / CHAR_BIT)) {
+        for (unsigned Byte = 0; Byte < PageSz / CHAR_BIT; ++Byte)
+          PageIt->setByte(Byte, Bytes[Byte]);
+        // The same as in the source, a snapshot does not need it
+        PageIt->Dirty = false;
+      }
 
     auto Allocated = StartAddr + PageSz - Addr;
     if (Allocated < Size)
@@ -0,0 +1,62 @@
+//===-- RVMExt.h ------------------------------------------------*- C++ -*-===//
+//
+// Extensions of the RVM interface that SnippyRVdash exports besides
+// RVMVTable. A harness that knows about them finds RVMExtVTable with dlsym,
+// the models without it are used through RVMVTable only. The table starts
+// with its version and size, a harness uses it only if they are the ones it
+// was built with.
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+#include "RVM.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#define RVMEXT_ENTRY_POINT_SYMBOL RVMExtVTable
+#define RVMEXT_CURRENT_VERSION 1
+
+// StopPC of rvm_executeBatch that is never reached
+#define RVM_NO_STOP_PC (~0ull)
+
+typedef enum {
+  // MaxCount instructions are retired
+  RVM_STOP_COUNT,
+  // The next instruction is at StopPC
+  RVM_STOP_PC,
+  // The program is finished (EBREAK, exit or exit_group syscall)
+  RVM_STOP_EXIT,
+  // The instruction could not be executed, it is not retired
+  RVM_STOP_TRAP,
+} RVMStopReason;
+
+// The whole X register file and the pc
+typedef struct {
+  RVMRegT XRegs[32];
+  uint64_t PC;
+} RVMXRegSnapshot;
+
+// Up to MaxCount retired instructions in one call. An instruction that traps
+// to the handler at mtvec is not counted, as it is not in Retired (the
+// minstret delta). No callbacks (MemUpdate, XRegUpdate, PCUpdate) are called
+// for them and nothing is written to the log, even if rvm_queryCallbackSupportPresent returns 1: it is about
+// rvm_executeInstr. A harness that needs the changes reads the state after
+// the batch or executes the instructions one by one.
+RVMStopReason rvm_executeBatch(RVMState *State, uint64_t MaxCount,
+                               uint64_t StopPC, uint64_t *Retired);
+
+// The model is as after rvm_modelCreate with the same config
+void rvm_modelReset(RVMState *State);
+
+void rvm_readXRegSnapshot(const RVMState *State, RVMXRegSnapshot *Snapshot);
+
+typedef RVMStopReason (*rvm_executeBatch_t)(RVMState *, uint64_t, uint64_t,
+                                            uint64_t *);
+typedef void (*rvm_modelReset_t)(RVMState *);
+typedef void (*rvm_readXRegSnapshot_t)(const RVMState *, RVMXRegSnapshot *);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
@@ -8,6 +8,7 @@
 
 #pragma once
 #include "RVM.h"
+#include "RVMExt.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -44,6 +45,16 @@ struct RVM_FunctionPointers {
   rvm_queryCallbackSupportPresent_t queryCallbackSupportPresent;
 };
 
+struct RVMExt_FunctionPointers {
+  // RVMEXT_CURRENT_VERSION and sizeof(RVMExt_FunctionPointers)
+  uint32_t Version;
+  uint32_t Size;
+
+  rvm_executeBatch_t executeBatch;
+  rvm_modelReset_t modelReset;
+  rvm_readXRegSnapshot_t readXRegSnapshot;
+};
+
 #ifdef __cplusplus
 }
 } // namespace rvm
@@ -0,0 +1,45 @@
+#ifndef STATE_HASH_H
+#define STATE_HASH_H
+
+#include <cstdint>
+
+namespace rvdash {
+
+//-----------------------------------StateHash-------------------------------------------
+
+/**
+ * @brief enum StateHashDomain - separates the keys of different parts of the
+ *                               architectural state (a memory address and a
+ *                               register number may be equal).
+ */
+enum StateHashDomain : uint64_t {
+  MEMORY_HASH_DOMAIN = 0x6d656d,
+  XREG_HASH_DOMAIN = 0x787265,
+  PC_HASH_DOMAIN = 0x7063,
+};
+
+inline uint64_t splitMix64(uint64_t Value) {
+  Value += 0x9e3779b97f4a7c15ull;
+  Value = (Value ^ (Value >> 30)) * 0xbf58476d1ce4e5b9ull;
+  Value = (Value ^ (Value >> 27)) * 0x94d049bb133111ebull;
+  return Value ^ (Value >> 31);
+}
+
+/**
+ * @brief hashStateElem - contribution of one element (register, memory byte)
+ *                        to the state hash. The state hash is the xor of all
+ *                        contributions, so a write updates it with
+ *                        Hash ^= hashStateElem(Old) ^ hashStateElem(New).
+ *                        Zero elements do not contribute, so untouched
+ *                        memory and reset registers cost nothing.
+ */
+inline uint64_t hashStateElem(StateHashDomain Domain, uint64_t Key,
+                              uint64_t Value) {
+  if (Value == 0)
+    return 0;
+  return splitMix64(splitMix64(Key ^ (uint64_t(Domain) << 40)) ^ Value);
+}
+
+} // namespace rvdash
+
+#endif // STATE_HASH_H
@@ -1,7 +1,13 @@
 #ifndef CPU_H
 #define CPU_H
 
+#include "StateHash.h"
+#include "rvdash/InstructionSet/Extensions.h"
 #include "rvdash/InstructionSet/Instruction.h"
+#include "rvdash/InstructionSet/SyscallEmulator.h"
+#include "rvdash/InstructionSet/Trap.h"
+#include "rvdash/InstructionSet/Zicsr/InstructionSet.h"
+#include "rvdash/Trace/TextTraceSink.h"
 
 #define DEBUG
 #undef DEBUG
@@ -13,11 +19,14 @@ namespace rvdash {
 /**
  * @brief class CPU - a class that controls the simulation process from writing
  *                    a program into virtual memory to executing instructions
- *                    (this is the model hart).
+ *                    (this is the model hart). The trace level is taken
+ *                    from InstrSetType.
  */
 template <typename MemoryType, typename InstrSetType> class CPU {
 
 private:
+  // The default text trace, when no sink is given
+  std::unique_ptr<TraceSink> OwnSink;
   MemoryType &VirtualMemory;
   InstrSetType ExtSet;
 
@@ -26,8 +35,20 @@ private:
 public:
   CPU(MemoryType &Mem, std::ostream &LogFile = std::cout,
       bool IsForTests = false)
-      : VirtualMemory(Mem), ExtSet(Mem, LogFile, IsForTests), LogFile(LogFile) {
-  }
+      : OwnSink(std::make_unique<TextTraceSink>(LogFile)), VirtualMemory(Mem),
+        ExtSet(Mem, *OwnSink, LogFile, IsForTests), LogFile(LogFile) {}
+
+  CPU(MemoryType &Mem, TraceSink &Sink, std::ostream &LogFile = std::cout,
+      bool IsForTests = false)
+      : VirtualMemory(Mem), ExtSet(Mem, Sink, LogFile, IsForTests),
+        LogFile(LogFile) {}
+
+  /**
+   * @brief CPU - one more model of the hart that is already created, for
+   *              example with another trace level (see SharedHart).
+   */
+  CPU(MemoryType &Mem, TraceSink &Sink, SharedHart Tag)
+      : VirtualMemory(Mem), ExtSet(Mem, Sink, Tag), LogFile(std::cout) {}
 
   void dump() const { dump(LogFile); }
   void dump(std::ostream &Stream) const {
@@ -40,6 +61,11 @@ public:
   }
   void print() const { dump(std::cout); }
 
+  /**
+   * @brief storeProgramInVirtualMemory - it stores Program at address 0, the
+   *                                      heap of the program (brk) starts
+   *                                      after it.
+   */
   void
   storeProgramInVirtualMemory(const std::vector<Register<CHAR_BIT>> &Program) {
     unsigned long long NumStore = 0;
@@ -47,6 +73,8 @@ public:
       VirtualMemory.store(NumStore, /* Size */ 1, Byte);
       NumStore++;
     }
+    if (!Program.empty())
+      setProgramBreak(Program.size());
   }
 
   void storeByte(uint64_t Addr, const Register<CHAR_BIT> &Byte) const {
@@ -59,8 +87,16 @@ public:
     return Byte;
   }
 
+  /**
+   * @brief execute - it stores Program at address 0 and executes it from Pc.
+   *                  AfterStep(Retired) is called after every instruction
+   *                  (see InstrSet::executeProgram). A trap without a
+   *                  handler is the error of the simulation.
+   */
+  template <typename HookType = typename InstrSetType::NoHook>
   void execute(unsigned long long Pc,
-               const std::vector<Register<CHAR_BIT>> &Program) {
+               const std::vector<Register<CHAR_BIT>> &Program,
+               HookType AfterStep = {}) {
     if (Pc % Instruction::Sz_b != 0)
       failWithError("Pc start address is not aligned to 4 bytes");
 
@@ -69,19 +105,123 @@ public:
     std::ofstream File("Mem_debug.dump");
     VirtualMemory.dump(File);
 #endif
-    LogFile << "====================Simulation started====================\n";
-    ExtSet.executeProgram(Pc);
-    LogFile << "===================Simulation completed===================\n";
+    if constexpr (InstrSetType::TraceCommits)
+      ExtSet.Trace.beginSimulation();
+    ExtSet.executeProgram(Pc, AfterStep);
+    checkUnhandledTrap();
+    if constexpr (InstrSetType::TraceCommits)
+      ExtSet.Trace.endSimulation();
   }
 
-  void step() { ExtSet.step(); }
+  /**
+   * @brief run - it executes up to Count retired instructions from the
+   *              current PC of the program that is already in memory (see
+   *              InstrSet::executeInstrs). The trace is not started or
+   *              finished, it is done by beginTrace and endTrace. A trap
+   *              without a handler is an error, as in execute.
+   */
+  template <typename HookType = typename InstrSetType::NoHook>
+  uint64_t run(uint64_t Count, HookType AfterStep = {}) {
+    auto Executed = ExtSet.executeInstrs(Count, AfterStep);
+    checkUnhandledTrap();
+    return Executed;
+  }
+
+  /**
+   * @brief runUntil - run that also stops before the instruction at StopPc
+   *                   (see InstrSet::executeUntil). A trap without a
+   *                   handler only stops it, the caller gets it from
+   *                   getUnhandledTrap.
+   */
+  template <typename HookType = typename InstrSetType::NoHook>
+  uint64_t runUntil(uint64_t Count, uint64_t StopPc, HookType AfterStep = {}) {
+    return ExtSet.executeUntil(Count, StopPc, AfterStep);
+  }
+
+  std::optional<TrapInfo> getUnhandledTrap() const {
+    return ExtSet.getUnhandledTrap();
+  }
+
+  /**
+   * @brief checkUnhandledTrap - the error with the message of the trap that
+   *                             stopped the execution, if there is one.
+   */
+  void checkUnhandledTrap() const {
+    if (auto Trap = getUnhandledTrap()) [[unlikely]]
+      failWithError(describeTrap(Trap.value()));
+  }
+
+  void beginTrace() {
+    if constexpr (InstrSetType::TraceCommits)
+      ExtSet.Trace.beginSimulation();
+  }
+  void endTrace() {
+    if constexpr (InstrSetType::TraceCommits)
+      ExtSet.Trace.endSimulation();
+  }
+
+  /**
+   * @brief continueFrom - Other is the model of the same hart (SharedHart),
+   *                       so the registers are already common, it takes
+   *                       the instret counter and the stop flag.
+   */
+  template <typename OtherCPU> void continueFrom(const OtherCPU &Other) {
+    setInstret(Other.getInstret());
+    ExtSet.Stop = Other.isStopped();
+  }
+
+  /**
+   * @brief stateHash - 64-bit hash of the architectural state (X registers,
+   *                    pc and memory). The register and memory parts are
+   *                    updated on every write, so it is cheap to call often.
+   *                    Equal states have equal hashes.
+   */
+  uint64_t stateHash() const {
+    return ExtSet.getStateHash() ^ VirtualMemory.getStateHash() ^
+           hashStateElem(PC_HASH_DOMAIN, 0, ExtSet.readPC().to_ullong());
+  }
+
+  bool step() { return ExtSet.step(); }
+  bool isStopped() const { return ExtSet.Stop; }
+  void resume() { ExtSet.resume(); }
+  void reset() { ExtSet.reset(); }
+  void flushTrace() { ExtSet.Trace.flush(); }
   void increasePC() const { ExtSet.increasePC(); }
   Register<InstrSetType::AddrSz> readPC() const { return ExtSet.readPC(); }
   void setPC(unsigned long long PcValue) const { ExtSet.setPC(PcValue); }
   uint64_t readXReg(unsigned Reg) const { return ExtSet.readXReg(Reg); }
+  /**
+   * @brief readXRegs - all 32 X registers into Values in one call.
+   */
+  void readXRegs(uint64_t *Values) const { ExtSet.readXRegs(Values); }
+  std::optional<uint64_t> readCSR(unsigned Csr) const {
+    return ExtSet.readCSR(Csr);
+  }
+  bool writeCSR(unsigned Csr, uint64_t Value) {
+    return ExtSet.writeCSR(Csr, Value);
+  }
+  std::vector<CSRValue> saveCSRs() const { return ExtSet.saveCSRs(); }
+  void restoreCSRs(const std::vector<CSRValue> &Values) {
+    ExtSet.restoreCSRs(Values);
+  }
+  uint64_t getInstret() const { return ExtSet.getInstret(); }
+  void setInstret(uint64_t Value) { ExtSet.setInstret(Value); }
+  typename InstrSetType::ExecuteFuncT getLastExecuted() const {
+    return ExtSet.getLastExecuted();
+  }
+  uint32_t getLastInstr() const { return ExtSet.getLastInstr(); }
+  const char *getMnemonic(typename InstrSetType::ExecuteFuncT Func) const {
+    return ExtSet.getMnemonic(Func);
+  }
+  uint64_t getPagesTouched() const { return VirtualMemory.getPages().size(); }
   void setXReg(unsigned Reg, uint64_t NewValue) const {
     ExtSet.setXReg(Reg, NewValue);
   }
+  void setProgramBreak(uint64_t Addr) const {
+    ExtSet.getSyscalls().setBrk(Addr);
+  }
+  uint64_t getProgramBreak() const { return ExtSet.getSyscalls().getBrk(); }
+  SyscallEmulator &getSyscalls() const { return ExtSet.getSyscalls(); }
 };
 
 } // namespace rvdash
@@ -0,0 +1,146 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "Memory/Memory.h"
+#include "rvdash/InstructionSet/Zicsr/InstructionSet.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace rvdash {
+
+//----------------------------------CheckpointHeader-------------------------------------
+
+/**
+ * @brief struct CheckpointHeader - the beginning of a checkpoint file. It is
+ *                                  followed by NumPages entries of the page
+ *                                  table and the page contents, every page
+ *                                  starts at a file offset aligned to
+ *                                  CheckpointAlign, so the file is mapped
+ *                                  as is. All fields are little-endian.
+ */
+struct CheckpointHeader {
+  static constexpr char MagicValue[8] = {'R', 'V', 'D', 'C', 'K', 'P', 'T', 0};
+  static constexpr uint32_t CurrentVersion = 3;
+  static constexpr unsigned MaxCSRs = 64;
+
+  char Magic[8];
+  uint32_t Version;
+  uint32_t AddrSz;
+  uint64_t PageSz /* bytes */;
+  uint64_t RamStart;
+  uint64_t RamSize;
+  uint64_t Pc;
+  uint64_t Instret;
+  uint64_t MemoryHash;
+  uint64_t ProgramBreak;
+  uint64_t XRegs[32];
+  uint64_t NumCSRs;
+  CSRValue CSRs[MaxCSRs];
+  uint64_t NumPages;
+};
+
+struct CheckpointPage {
+  uint64_t Addr;
+  uint64_t Offset;
+};
+
+constexpr uint64_t CheckpointAlign = 4096;
+
+//-----------------------------------CheckpointFile--------------------------------------
+
+/**
+ * @brief class CheckpointFile - checkpoint mapped into memory (--restore).
+ *                               The pages are not read until the model
+ *                               touches them: Memory takes them from here
+ *                               as a PageSource.
+ */
+class CheckpointFile : public PageSource {
+  const unsigned char *Data = nullptr;
+  size_t Size = 0;
+  const CheckpointHeader *Header = nullptr;
+  // Sorted by address
+  const CheckpointPage *PageTable = nullptr;
+
+public:
+  explicit CheckpointFile(const std::string &Path);
+  CheckpointFile(const CheckpointFile &) = delete;
+  CheckpointFile &operator=(const CheckpointFile &) = delete;
+  ~CheckpointFile();
+
+  const CheckpointHeader &getHeader() const { return *Header; }
+  const unsigned char *findPage(unsigned long long Addr) const override;
+  std::vector<unsigned long long> getPageAddrs() const override;
+};
+
+/**
+ * @brief writeCheckpoint - it writes Header and Pages (address and contents
+ *                          of every page, sorted by address) into Path.
+ */
+void writeCheckpoint(
+    const std::string &Path, const CheckpointHeader &Header,
+    const std::vector<std::pair<uint64_t, std::vector<unsigned char>>> &Pages);
+
+/**
+ * @brief saveCheckpoint - it saves the PC, the X registers, the CSRs, the
+ *                         instret counter, the program break and all
+ *                         allocated pages of Mem.
+ */
+template <typename CPUType, typename MemoryType>
+void saveCheckpoint(const std::string &Path, const CPUType &Cpu,
+                    MemoryType &Mem) {
+  CheckpointHeader Header{};
+  std::copy(std::begin(CheckpointHeader::MagicValue),
+            std::end(CheckpointHeader::MagicValue), Header.Magic);
+  Header.Version = CheckpointHeader::CurrentVersion;
+  Header.AddrSz = MemoryType::getAddrSz();
+  Header.PageSz = MemoryType::getPageSz() / CHAR_BIT;
+  Header.RamStart = Mem.getRamStart();
+  Header.RamSize = Mem.getRamSize();
+  Header.Pc = Cpu.readPC().to_ullong();
+  Header.Instret = Cpu.getInstret();
+  Header.MemoryHash = Mem.getStateHash();
+  Header.ProgramBreak = Cpu.getProgramBreak();
+  Cpu.readXRegs(Header.XRegs);
+  auto CSRs = Cpu.saveCSRs();
+  if (CSRs.size() > CheckpointHeader::MaxCSRs)
+    failWithError("Too many CSRs for a checkpoint");
+  Header.NumCSRs = CSRs.size();
+  std::copy(CSRs.begin(), CSRs.end(), Header.CSRs);
+  // Pages of a restored run that were never touched are saved too
+  Mem.loadLazyPages();
+  std::vector<std::pair<uint64_t, std::vector<unsigned char>>> Pages;
+  for (auto &Pg : Mem.getPages())
+    Pages.emplace_back(Pg.FirstAddr / CHAR_BIT, MemoryType::getPageBytes(Pg));
+  writeCheckpoint(Path, Header, Pages);
+}
+
+/**
+ * @brief restoreCheckpoint - it sets the registers of Cpu from the
+ *                            checkpoint and makes its pages the contents of
+ *                            Mem. Execution continues from the saved PC.
+ */
+template <typename CPUType, typename MemoryType>
+void restoreCheckpoint(const std::shared_ptr<const CheckpointFile> &Checkpoint,
+                       CPUType &Cpu, MemoryType &Mem) {
+  auto &Header = Checkpoint->getHeader();
+  if (Header.AddrSz != MemoryType::getAddrSz() ||
+      Header.PageSz != MemoryType::getPageSz() / CHAR_BIT)
+    failWithError("Checkpoint was saved for another address space or page "
+                  "size");
+  for (unsigned Reg = 1; Reg < 32; ++Reg)
+    Cpu.setXReg(Reg, Header.XRegs[Reg]);
+  Cpu.restoreCSRs({Header.CSRs, Header.CSRs + Header.NumCSRs});
+  Cpu.setInstret(Header.Instret);
+  Cpu.setProgramBreak(Header.ProgramBreak);
+  Mem.setLazyPages(Checkpoint, Header.MemoryHash);
+}
+
+} // namespace rvdash
+
+#endif // CHECKPOINT_H
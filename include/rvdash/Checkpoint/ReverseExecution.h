@@ -0,0 +1,156 @@
+#ifndef REVERSE_EXECUTION_H
+#define REVERSE_EXECUTION_H
+
+#include "Memory/Memory.h"
+#include "rvdash/InstructionSet/Zicsr/InstructionSet.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace rvdash {
+
+//----------------------------------ReverseExecution-------------------------------------
+
+/**
+ * @brief class ReverseExecution - steps back in the execution of Cpu. Every
+ *                                 Interval instructions it takes a snapshot
+ *                                 in memory: the PC, the X registers, the
+ *                                 CSRs and Memory::takeSnapshot (only the pages
+ *                                 written since the previous snapshot are
+ *                                 copied). To go back it restores the
+ *                                 nearest snapshot before the target and
+ *                                 executes the rest again on Fast, the model
+ *                                 of the same hart without the trace. The
+ *                                 syscalls are replayed from their history,
+ *                                 so the re-execution does not touch the
+ *                                 host and comes to the same state.
+ */
+template <typename CPUType, typename FastCPUType, typename MemoryType>
+class ReverseExecution {
+  struct Snapshot {
+    uint64_t Instret;
+    uint64_t Pc;
+    std::array<uint64_t, 32> XRegs;
+    std::vector<CSRValue> CSRs;
+    std::shared_ptr<const MemorySnapshot> Memory;
+  };
+
+  CPUType &Cpu;
+  FastCPUType &Fast;
+  MemoryType &Mem;
+  uint64_t Interval;
+  // Sorted by instret, the first one is the beginning of the execution
+  std::vector<Snapshot> Snapshots;
+
+  void takeSnapshot() {
+    Snapshot Snap{Cpu.getInstret(), Cpu.readPC().to_ullong(), {},
+                  Cpu.saveCSRs(), nullptr};
+    Cpu.readXRegs(Snap.XRegs.data());
+    Snap.Memory = Mem.takeSnapshot();
+    Snapshots.push_back(std::move(Snap));
+  }
+
+  /**
+   * @brief restoreBefore - it restores the latest snapshot taken not after
+   *                        Instret, Fast continues from it.
+   */
+  const Snapshot &restoreBefore(uint64_t Instret) {
+    auto It = std::upper_bound(
+        Snapshots.begin(), Snapshots.end(), Instret,
+        [](uint64_t Value, const Snapshot &Snap) {
+          return Value < Snap.Instret;
+        });
+    auto &Snap = *std::prev(It);
+    Mem.restoreSnapshot(Snap.Memory);
+    for (unsigned Reg = 1; Reg < Snap.XRegs.size(); ++Reg)
+      Cpu.setXReg(Reg, Snap.XRegs[Reg]);
+    Cpu.restoreCSRs(Snap.CSRs);
+    Cpu.setPC(Snap.Pc);
+    Fast.setInstret(Snap.Instret);
+    Fast.resume();
+    Cpu.getSyscalls().rewindHistory(Snap.Instret);
+    return Snap;
+  }
+
+public:
+  /**
+   * @brief ReverseExecution - the execution can go back to the current
+   *                           state of Cpu and later.
+   */
+  ReverseExecution(CPUType &Model, FastCPUType &FastModel, MemoryType &Memory,
+                   uint64_t SnapshotInterval)
+      : Cpu(Model), Fast(FastModel), Mem(Memory), Interval(SnapshotInterval) {
+    Cpu.getSyscalls().keepHistory();
+    takeSnapshot();
+  }
+
+  uint64_t getStartInstret() const { return Snapshots.front().Instret; }
+  size_t getNumSnapshots() const { return Snapshots.size(); }
+
+  /**
+   * @brief afterStep - it is called after every retired instruction of Cpu.
+   */
+  void afterStep() {
+    if (Cpu.getInstret() >= Snapshots.back().Instret + Interval)
+      takeSnapshot();
+  }
+
+  /**
+   * @brief goTo - the state right after the instruction that retired as
+   *               Instret, it is not later than the current one. The
+   *               replay runs until the instret of Fast reaches it, the
+   *               traps on the way do not count.
+   */
+  void goTo(uint64_t Instret) {
+    restoreBefore(Instret);
+    Fast.run(Instret - Fast.getInstret());
+    Cpu.continueFrom(Fast);
+  }
+
+  /**
+   * @brief reverseStep - Count instructions back, but not before the
+   *                      beginning. It returns the number of instructions.
+   */
+  uint64_t reverseStep(uint64_t Count) {
+    Count = std::min(Count, Cpu.getInstret() - getStartInstret());
+    goTo(Cpu.getInstret() - Count);
+    return Count;
+  }
+
+  /**
+   * @brief reverseContinue - back to the latest earlier state for which
+   *                          IsStop(Fast) is true. Without it the execution
+   *                          goes back to the beginning and false is
+   *                          returned. The intervals between the snapshots
+   *                          are executed again from the last one.
+   */
+  template <typename PredType> bool reverseContinue(PredType IsStop) {
+    auto End = Cpu.getInstret();
+    while (End > getStartInstret()) {
+      auto &Snap = restoreBefore(End - 1);
+      std::optional<uint64_t> Found;
+      if (IsStop(Fast))
+        Found = Snap.Instret;
+      // Only the states after a retired instruction can be reached by goTo
+      Fast.run(End - 1 - Snap.Instret, [&](bool Retired) {
+        if (Retired && IsStop(Fast))
+          Found = Fast.getInstret();
+      });
+      if (Found.has_value()) {
+        goTo(Found.value());
+        return true;
+      }
+      End = Snap.Instret;
+    }
+    goTo(getStartInstret());
+    return false;
+  }
+};
+
+} // namespace rvdash
+
+#endif // REVERSE_EXECUTION_H
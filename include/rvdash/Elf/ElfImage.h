@@ -0,0 +1,68 @@
+#ifndef ELF_IMAGE_H
+#define ELF_IMAGE_H
+
+#include "Memory/Memory.h"
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace rvdash {
+
+//--------------------------------------ElfImage-----------------------------------------
+
+/**
+ * @brief class ElfImage - PT_LOAD segments of an ELF32 or ELF64 RISC-V
+ *                         executable cut into the guest pages. Memory takes
+ *                         the pages from it on the first access, the pages
+ *                         of .bss (memsz beyond filesz) are not stored at
+ *                         all: untouched memory is zero. So loading costs
+ *                         only the contents of the segments, not the
+ *                         distance between them.
+ */
+class ElfImage : public PageSource {
+
+public:
+  struct Segment {
+    uint64_t Addr;
+    uint64_t FileSz;
+    uint64_t MemSz;
+  };
+
+private:
+  uint64_t PageSz /* bytes */;
+  uint64_t Entry = 0;
+  std::vector<Segment> Segments;
+  std::map<uint64_t, std::vector<unsigned char>> Pages;
+  // Memory part of the state hash for the loaded contents
+  uint64_t StateHash = 0;
+
+  void addSegment(const unsigned char *Data, uint64_t Addr, uint64_t FileSz,
+                  uint64_t MemSz);
+
+public:
+  ElfImage(const std::string &ElfPath, uint64_t PageBytes);
+
+  /**
+   * @brief isElfFile - the file starts with the ELF magic (a raw binary
+   *                    can't, 0x7f is not an opcode of RV32I).
+   */
+  static bool isElfFile(const std::string &Path);
+
+  uint64_t getEntry() const { return Entry; }
+  uint64_t getStateHash() const { return StateHash; }
+  const std::vector<Segment> &getSegments() const { return Segments; }
+
+  /**
+   * @brief getEnd - the address after the last byte of all segments.
+   */
+  uint64_t getEnd() const;
+
+  const unsigned char *findPage(unsigned long long Addr) const override;
+  std::vector<unsigned long long> getPageAddrs() const override;
+};
+
+} // namespace rvdash
+
+#endif // ELF_IMAGE_H
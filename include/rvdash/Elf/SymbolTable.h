@@ -0,0 +1,53 @@
+#ifndef SYMBOL_TABLE_H
+#define SYMBOL_TABLE_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace rvdash {
+
+//-------------------------------------SymbolTable---------------------------------------
+
+/**
+ * @brief class SymbolTable - code symbols (functions and labels) of an
+ *                            ELF32 or ELF64 file, sorted by address. It maps
+ *                            guest PCs to "function+offset" for the reports
+ *                            of the profilers.
+ */
+class SymbolTable {
+
+public:
+  struct Symbol {
+    uint64_t Addr;
+    // Zero for the labels of assembler files, they last until the next symbol
+    uint64_t Size;
+    std::string Name;
+  };
+
+private:
+  std::vector<Symbol> Symbols;
+
+public:
+  SymbolTable() = default;
+  explicit SymbolTable(const std::string &ElfPath);
+
+  /**
+   * @brief lookup - the symbol containing Addr or nullptr.
+   */
+  const Symbol *lookup(uint64_t Addr) const;
+
+  /**
+   * @brief symbolize - "name+0xoff" for Addr, or "0xaddr" when there is no
+   *                    symbol for it.
+   */
+  std::string symbolize(uint64_t Addr) const;
+
+  bool empty() const { return Symbols.empty(); }
+  const std::vector<Symbol> &getSymbols() const { return Symbols; }
+};
+
+} // namespace rvdash
+
+#endif // SYMBOL_TABLE_H
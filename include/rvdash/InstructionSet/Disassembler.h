@@ -0,0 +1,24 @@
+#ifndef DISASSEMBLER_H
+#define DISASSEMBLER_H
+
+#include <cstdint>
+#include <iostream>
+
+namespace rvdash {
+
+//-----------------------------------Disassembler----------------------------------------
+
+/**
+ * @brief disassemble - print Instr in the rvdash trace syntax
+ *                      ("addi X10, X0, 0x1"). The line is finished with '\n'
+ *                      for all instructions except ecall, which is completed
+ *                      by the syscall description. The first version writes
+ *                      into Out (at most TraceFormat::MaxLineSz bytes) and
+ *                      returns the new end.
+ */
+char *disassemble(char *Out, uint32_t Instr);
+void disassemble(std::ostream &Stream, uint32_t Instr);
+
+} // namespace rvdash
+
+#endif // DISASSEMBLER_H
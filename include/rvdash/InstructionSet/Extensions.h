@@ -9,6 +9,8 @@ namespace rvdash {
 
 enum class Extensions {
   RV32I,
+  Zicsr,
+  Machine,
 };
 
 //---------------------------------ExecuteFuncType---------------------------------------
@@ -16,6 +18,16 @@ enum class Extensions {
 template <typename InstrSetType>
 using ExecuteFuncType = void (*)(Instruction, InstrSetType &Set);
 
+//-------------------------------------SharedHart----------------------------------------
+
+/**
+ * @brief struct SharedHart - constructor tag of the extensions: the new model
+ *                            is another instantiation (for example, with
+ *                            another trace level) of the hart that already
+ *                            exists, so it uses the same registers.
+ */
+struct SharedHart {};
+
 } // namespace rvdash
 
 #endif // EXTENSIONS_H
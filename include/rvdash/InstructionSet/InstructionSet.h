@@ -4,8 +4,14 @@
 #include <type_traits>
 #include <variant>
 
+#include "Memory/CachedMemory.h"
 #include "rvdash/InstructionSet/Instruction.h"
+#include "rvdash/InstructionSet/Machine/InstructionSet.h"
 #include "rvdash/InstructionSet/RV32I/InstructionSet.h"
+#include "rvdash/InstructionSet/Trap.h"
+#include "rvdash/InstructionSet/Zicsr/InstructionSet.h"
+#include "rvdash/Trace/TraceLevel.h"
+#include "rvdash/Trace/TraceSink.h"
 
 namespace rvdash {
 
@@ -16,7 +22,7 @@ concept HasPc = requires(Set *S) {
   S->getPC();
 };
 
-template <typename Set> bool isBaseSet(Set) {
+template <typename Set> bool isBaseSet(const Set &) {
   if constexpr (HasPc<Set>)
     return true;
   return false;
@@ -29,6 +35,77 @@ std::optional<Register<PcSz> *> getPC(Set *S) {
   return std::nullopt;
 }
 
+//----------------------------------ExtractStateHash-------------------------------------
+
+template <typename Set>
+concept HasStateHash = requires(const Set *S) {
+  S->getStateHash();
+};
+
+template <typename Set> uint64_t getStateHash(const Set *S) {
+  if constexpr (HasStateHash<Set>)
+    return S->getStateHash();
+  return 0;
+}
+
+//-------------------------------------ReadCSR-------------------------------------------
+
+template <typename Set, typename MainSet>
+std::optional<uint64_t> tryReadCSR(const Set *S, unsigned Csr,
+                                   const MainSet &Main) {
+  if constexpr (requires { S->readCSR(Csr, Main); })
+    return S->readCSR(Csr, Main);
+  return std::nullopt;
+}
+
+//------------------------------------TakeTrap-------------------------------------------
+
+template <typename Set>
+std::optional<uint64_t> tryTakeTrap(Set *S, const TrapInfo &Trap) {
+  if constexpr (requires { S->takeTrap(Trap); })
+    return S->takeTrap(Trap);
+  return std::nullopt;
+}
+
+template <typename Set, typename MainSet>
+bool tryWriteCSR(Set *S, unsigned Csr, uint64_t Value, MainSet &Main) {
+  if constexpr (requires { S->writeCSR(Csr, Value, Main); })
+    return S->writeCSR(Csr, Value, Main);
+  return false;
+}
+
+//----------------------------------SaveCSRs--------------------------------------------
+
+template <typename Set>
+void trySaveCSRs(const Set *S, std::vector<CSRValue> &Values) {
+  if constexpr (requires { S->saveCSRs(Values); })
+    S->saveCSRs(Values);
+}
+
+template <typename Set> bool tryRestoreCSR(Set *S, const CSRValue &Saved) {
+  if constexpr (requires { S->restoreCSR(Saved); })
+    return S->restoreCSR(Saved);
+  return false;
+}
+
+//--------------------------------------Reset--------------------------------------------
+
+template <typename Set> void tryReset(Set *S) {
+  if constexpr (requires { S->reset(); })
+    S->reset();
+}
+
+//-----------------------------------FindMnemonic----------------------------------------
+
+template <typename Set, typename MainSet>
+std::optional<const char *>
+tryFindMnemonic(const Set *S, typename MainSet::ExecuteFuncT Func,
+                const MainSet &Main) {
+  if constexpr (requires { S->findMnemonic(Func, Main); })
+    return S->findMnemonic(Func, Main);
+  return std::nullopt;
+}
+
 template <size_t Sz>
 std::optional<Register<Sz>*> operator^(std::optional<Register<Sz>*> Lhs, std::optional<Register<Sz>*> Rhs) {
   if (Lhs.has_value() && Rhs.has_value())
@@ -54,36 +131,80 @@ operator^(std::optional<std::tuple<Instruction, T1>> Lhs,
  * @brief class InstrSet - main part of CPU, contains (private inheritance) all
  *                         possible extensions (the basic set too). AddrSz
  *                         means size of address space and program counter
- *                         register PC.
+ *                         register PC. Level selects what is reported to
+ *                         the trace (see TraceLevel).
  */
-template <typename MemoryType, typename... Exts>
+template <typename MemoryType, TraceLevel Level, typename... Exts>
 class InstrSet : private Exts... {
 
 public:
   static constexpr size_t AddrSz = MemoryType::getAddrSz();
+  static constexpr TraceLevel TraceLvl = Level;
+  static constexpr bool TraceCommits = Level != TraceLevel::None;
+  static constexpr bool TraceAll = Level == TraceLevel::Full;
 
 protected:
   Register<AddrSz> *PC;
   MemoryType &Memory;
+  // Retired instructions, it is the base for the counter CSRs
+  uint64_t InstrRet = 0;
+  // Handler and encoding of the last executed instruction, they identify the
+  // instruction for the statistics and profilers
+  ExecuteFuncType<InstrSet> LastExecuted = nullptr;
+  uint32_t LastInstr = 0;
+  // The trap of the current instruction (TrapRaised) and the last one that
+  // had no handler and stopped the execution (Trapped)
+  TrapInfo Trap;
+  bool TrapRaised = false;
+  bool Trapped = false;
 
 public:
   volatile bool Stop = false;
   std::ostream &LogFile;
+  TraceSink &Trace;
 
   using ExecuteFuncT = ExecuteFuncType<InstrSet>;
 
-  InstrSet(MemoryType &Mem, std::ostream &File = std::cout,
+  InstrSet(MemoryType &Mem, TraceSink &Sink, std::ostream &File = std::cout,
            bool IsForTests = false)
-      : Exts(IsForTests)..., Memory(Mem), LogFile(File) {
+      : Exts(IsForTests)..., Memory(Mem), LogFile(File), Trace(Sink) {
     if (!isThereBase())
       failWithError("One base set must be selected");
     PC = extractPC();
   }
 
+  /**
+   * @brief InstrSet - one more model of the hart that already exists: it
+   *                   shares the registers and the PC with it, the other
+   *                   state (instret, the stop flag) is its own.
+   */
+  InstrSet(MemoryType &Mem, TraceSink &Sink, SharedHart Tag)
+      : Exts(Tag)..., Memory(Mem), LogFile(std::cout), Trace(Sink) {
+    PC = extractPC();
+  }
+
   /**
    * @brief stop - function to stop execution of the machine cycle.
    */
   void stop() { Stop = true; }
+  void resume() {
+    Stop = false;
+    Trapped = false;
+  }
+
+  /**
+   * @brief reset - the state of the hart as after the construction, the
+   *                extensions with reset() clear their own state.
+   */
+  void reset() {
+    (tryReset(static_cast<Exts *>(this)), ...);
+    InstrRet = 0;
+    LastExecuted = nullptr;
+    LastInstr = 0;
+    Stop = false;
+    TrapRaised = false;
+    Trapped = false;
+  }
 
   /**
    * @brief extractPC - function to find the basic set and get the program
@@ -126,13 +247,14 @@ public:
    *                 returns Instruction and a pointer to the function to
    *                 execute. If the given instruction does not belong to
    *                 this extension, then it returns std::nullopt and this
-   *                 nullopt is ignored by the overloaded ^ operator.
+   *                 nullopt is ignored by the overloaded ^ operator. The
+   *                 function is nullptr if no extension knows Instr.
    */
   std::tuple<Instruction, ExecuteFuncT>
   decode(Register<Instruction::Sz> Instr) {
     auto Result = (static_cast<Exts &>(*this).tryDecode(Instr, *this) ^ ...);
     if (!Result.has_value())
-      failWithError("Illegal instruction: " + Instr.to_string());
+      return {Instruction(), nullptr};
     return Result.value();
   }
 
@@ -149,6 +271,113 @@ public:
       failWithError("Fail execution");
   }
 
+  /**
+   * @brief getInstret, getCycle - counters of the main loop. There is no
+   *                               timing model, so every instruction takes
+   *                               one cycle.
+   */
+  uint64_t getInstret() const { return InstrRet; }
+  void setInstret(uint64_t Value) { InstrRet = Value; }
+  uint64_t getCycle() const { return InstrRet; }
+
+  /**
+   * @brief readCSR - it asks all extensions for Csr, std::nullopt means
+   *                  that no extension has it.
+   */
+  std::optional<uint64_t> readCSR(unsigned Csr) const {
+    std::optional<uint64_t> Result;
+    ((Result = Result.has_value()
+                   ? Result
+                   : tryReadCSR(static_cast<const Exts *>(this), Csr, *this)),
+     ...);
+    return Result;
+  }
+
+  /**
+   * @brief writeCSR - it gives Value to the extension that has Csr, false if
+   *                   no extension can write it.
+   */
+  bool writeCSR(unsigned Csr, uint64_t Value) {
+    return (tryWriteCSR(static_cast<Exts *>(this), Csr, Value, *this) ||
+            ...);
+  }
+
+  /**
+   * @brief saveCSRs, restoreCSRs - the CSRs kept by the extensions, for the
+   *                                snapshots and the checkpoints. They are
+   *                                restored as is, without the write masks.
+   */
+  std::vector<CSRValue> saveCSRs() const {
+    std::vector<CSRValue> Values;
+    (trySaveCSRs(static_cast<const Exts *>(this), Values), ...);
+    return Values;
+  }
+
+  void restoreCSRs(const std::vector<CSRValue> &Values) {
+    for (auto &Saved : Values)
+      if (!(tryRestoreCSR(static_cast<Exts *>(this), Saved) || ...))
+        failWithError("Can't restore CSR " + std::to_string(Saved.Addr) +
+                      ", the model does not have it");
+  }
+
+  /**
+   * @brief raiseTrap - the current instruction takes a trap, the handler
+   *                    returns right after it without changing the state.
+   *                    The trap is taken at the end of step, so raising it
+   *                    costs a few stores and no exception.
+   */
+  void raiseTrap(TrapCause Cause, uint64_t Tval, const char *Reason = nullptr,
+                 uint64_t Info = 0) {
+    Trap = {Cause, PC->to_ullong(), Tval, Reason, Info};
+    TrapRaised = true;
+  }
+
+  /**
+   * @brief getUnhandledTrap - the trap without a handler that stopped the
+   *                           execution. The PC stays at the instruction, so
+   *                           after resume() it is executed again.
+   */
+  std::optional<TrapInfo> getUnhandledTrap() const {
+    if (!Trapped)
+      return std::nullopt;
+    return Trap;
+  }
+
+  /**
+   * @brief getLastExecuted, getLastInstr, getMnemonic - the handler and the
+   *                                                     encoding of the last
+   *                                                     executed instruction
+   *                                                     and the name of the
+   *                                                     instruction (as in
+   *                                                     DefineInstrs.h) for a
+   *                                                     handler.
+   */
+  ExecuteFuncT getLastExecuted() const { return LastExecuted; }
+  uint32_t getLastInstr() const { return LastInstr; }
+  const char *getMnemonic(ExecuteFuncT Func) const {
+    std::optional<const char *> Result;
+    ((Result = Result.has_value()
+                   ? Result
+                   : tryFindMnemonic(static_cast<const Exts *>(this), Func,
+                                     *this)),
+     ...);
+    return Result.value_or("unknown");
+  }
+
+  /**
+   * @brief getStateHash - xor of the register hashes of all extensions.
+   */
+  uint64_t getStateHash() const {
+    return (rvdash::getStateHash(static_cast<const Exts *>(this)) ^ ...);
+  }
+
+  /**
+   * @brief NoHook - default AfterStep of executeProgram, it does nothing.
+   */
+  struct NoHook {
+    void operator()(bool Retired) const {}
+  };
+
   /**
    * @brief executeProgram - function to excution of the main machine cycle,
    *                         using sequential substitution of its extensions.
@@ -156,52 +385,209 @@ public:
    *                         it returns Instr and a pointer to the function to
    *                         execute (Func). If the given instruction does not
    *                         belong to this extension, then it returns
-   *                         std::nullopt.
+   *                         std::nullopt. AfterStep(Retired) is called
+   *                         after every step, Retired is false for the
+   *                         instruction that took a trap, the PC is at the
+   *                         handler then.
    */
-  void executeProgram(unsigned long long PcValue) {
+  template <typename HookType = NoHook>
+  void executeProgram(unsigned long long PcValue, HookType AfterStep = {}) {
     setPC(PcValue);
     // Machine cycle
     do {
-      step();
+      bool Retired = step();
       increasePC();
+      AfterStep(Retired);
     } while (!Stop);
     std::ofstream File("Mem.dump");
     Memory.dump(File);
   }
 
   /**
-   * @brief step - function for one step of the machine cycle.
+   * @brief executeInstrs - the same machine cycle from the current PC, but
+   *                        it returns after Count retired instructions or
+   *                        when the program stops. The traps taken on the
+   *                        way are not counted. It returns the number of
+   *                        retired instructions.
+   */
+  template <typename HookType = NoHook>
+  uint64_t executeInstrs(uint64_t Count, HookType AfterStep = {}) {
+    uint64_t Executed = 0;
+    while (Executed < Count && !Stop) {
+      bool Retired = step();
+      increasePC();
+      Executed += Retired;
+      AfterStep(Retired);
+    }
+    return Executed;
+  }
+
+  /**
+   * @brief executeUntil - executeInstrs, but it also returns when the next
+   *                       instruction is at StopPc. StopPc is checked after
+   *                       every instruction, so the one at the current PC is
+   *                       always executed, and a trap to the handler at
+   *                       StopPc stops too. Like in executeInstrs, Count is
+   *                       the number of retired instructions.
+   */
+  template <typename HookType = NoHook>
+  uint64_t executeUntil(uint64_t Count, uint64_t StopPc,
+                        HookType AfterStep = {}) {
+    uint64_t Executed = 0;
+    while (Executed < Count && !Stop) {
+      bool Retired = step();
+      increasePC();
+      Executed += Retired;
+      AfterStep(Retired);
+      if (PC->to_ullong() == StopPc)
+        break;
+    }
+    return Executed;
+  }
+
+  /**
+   * @brief step - function for one step of the machine cycle. It returns
+   *               false if the instruction took a trap and did not retire.
    */
-  void step() {
+  bool step() {
     if (Stop)
       failWithError("Step is impossible");
     Register<Instruction::Sz> Cmd;
     // Fetch
+    if (!Memory.isAccessible(PC->to_ulong(), Instruction::Sz_b)) [[unlikely]] {
+      raiseTrap(TrapCause::InstrAccessFault, PC->to_ullong());
+      // The trace record of the fault has no instruction bits
+      if constexpr (TraceCommits)
+        Trace.beginInstr(PC->to_ulong(), /* Instr */ 0);
+      takeTrap();
+      if constexpr (TraceCommits)
+        Trace.endInstr();
+      return false;
+    }
     Memory.load(PC->to_ulong(), /* Size */ Instruction::Sz_b, Cmd);
-    // Decode
+    if constexpr (HasCacheModel<MemoryType>)
+      Memory.accessICache(PC->to_ulong(), Instruction::Sz_b);
+    if constexpr (TraceCommits)
+      Trace.beginInstr(PC->to_ulong(), Cmd.to_ulong());
+    // Decode and execute, an illegal instruction traps
     auto [Instr, Func] = decode(Cmd);
-    // Execute
-    execute(Instr, Func);
+    if (Func != nullptr) [[likely]]
+      execute(Instr, Func);
+    else
+      raiseTrap(TrapCause::IllegalInstr, Cmd.to_ulong());
+    if (TrapRaised) [[unlikely]] {
+      takeTrap();
+      if constexpr (TraceCommits)
+        Trace.endInstr();
+      return false;
+    }
+    LastExecuted = Func;
+    LastInstr = Cmd.to_ulong();
+    ++InstrRet;
+    if constexpr (TraceCommits)
+      Trace.endInstr();
+    return true;
+  }
+
+  /**
+   * @brief takeTrap - the end of the instruction with a trap: it does not
+   *                   retire. The extension with the trap CSRs gives the
+   *                   handler address, the execution goes on from it. Without
+   *                   a handler the PC stays at the instruction and the
+   *                   execution stops (see getUnhandledTrap).
+   */
+  void takeTrap() {
+    TrapRaised = false;
+    if constexpr (TraceCommits)
+      Trace.trap(Trap.Cause, Trap.Tval);
+    std::optional<uint64_t> Vector;
+    ((Vector = Vector.has_value()
+                   ? Vector
+                   : tryTakeTrap(static_cast<Exts *>(this), Trap)),
+     ...);
+    // The main loop increases the PC after the step
+    if (Vector.has_value()) {
+      *PC = Vector.value() - Instruction::Sz_b;
+      if constexpr (TraceCommits)
+        Trace.pcWrite(PC->to_ulong());
+      return;
+    }
+    *PC = Trap.Pc - Instruction::Sz_b;
+    Trapped = true;
+    Stop = true;
+  }
+
+  /**
+   * @brief loadData, storeData - data memory accesses of the instructions.
+   *                              Stores are reported to the commit trace,
+   *                              loads only to the full one. With the cache
+   *                              model they go through the data cache. An
+   *                              access outside RAM raises the access fault
+   *                              and returns false.
+   */
+  template <typename RegisterType>
+  bool loadData(unsigned long long Addr, unsigned Size, RegisterType &Reg) {
+    if (!Memory.isAccessible(Addr, Size)) [[unlikely]] {
+      raiseTrap(TrapCause::LoadAccessFault, Addr);
+      return false;
+    }
+    Memory.load(Addr, Size, Reg);
+    if constexpr (HasCacheModel<MemoryType>)
+      Memory.accessDCache(Addr, Size, /* IsWrite */ false);
+    if constexpr (TraceAll)
+      Trace.memRead(Addr, Size, Reg.to_ullong());
+    return true;
+  }
+
+  template <typename RegisterType>
+  bool storeData(unsigned long long Addr, unsigned Size,
+                 const RegisterType &Reg) {
+    if (!Memory.isAccessible(Addr, Size)) [[unlikely]] {
+      raiseTrap(TrapCause::StoreAccessFault, Addr);
+      return false;
+    }
+    Memory.store(Addr, Size, Reg);
+    if constexpr (HasCacheModel<MemoryType>)
+      Memory.accessDCache(Addr, Size, /* IsWrite */ true);
+    if constexpr (TraceCommits)
+      Trace.memWrite(Addr, Size, Reg.to_ullong());
+    return true;
   }
 
   void increasePC() const { ++*PC; }
   Register<AddrSz> readPC() const { return *PC; }
   void setPC(unsigned long long PcValue) const { *PC = PcValue; }
 
-  uint64_t readXReg(unsigned Reg) const {
-    auto RV32ISet = dynamic_cast<const RV32I::RV32IInstrSet *>(this);
-    if (RV32ISet == nullptr)
-      failWithError(
-          "Request for X registers that do not exist in this architecture");
-    return RV32ISet->readXReg(Reg);
-  }
+  /**
+   * @brief readXReg, setXReg, readXRegs - the X registers of the base set.
+   *                                       The base set is found at compile
+   *                                       time, a request to an architecture
+   *                                       without X registers does not
+   *                                       compile.
+   */
+  uint64_t readXReg(unsigned Reg) const { return getBaseXSet().readXReg(Reg); }
 
   void setXReg(unsigned Reg, uint64_t NewValue) const {
-    auto RV32ISet = dynamic_cast<const RV32I::RV32IInstrSet *>(this);
-    if (RV32ISet == nullptr)
-      failWithError(
-          "Request for X registers that do not exist in this architecture");
-    RV32ISet->setXReg(Reg, NewValue);
+    getBaseXSet().setXReg(Reg, NewValue);
+  }
+
+  void readXRegs(uint64_t *Values) const { getBaseXSet().readXRegs(Values); }
+
+  /**
+   * @brief getSyscalls - the syscall emulator of ECALL, setBrk of it is the
+   *                      end of the loaded program.
+   */
+  SyscallEmulator &getSyscalls() const { return getBaseXSet().getSyscalls(); }
+
+private:
+  static constexpr bool HasXRegs =
+      (std::is_same_v<Exts, RV32I::RV32IInstrSet> || ...);
+
+  const RV32I::RV32IInstrSet &getBaseXSet() const {
+    static_assert(HasXRegs,
+                  "Request for X registers that do not exist in this "
+                  "architecture");
+    return *this;
   }
 };
 
@@ -0,0 +1,23 @@
+#ifdef ADD_CSR
+
+// ADD_CSR(Name, Address, WriteMask, ResetValue), the bits out of WriteMask
+// keep their value on a write (WARL). The machine counters are not here,
+// they are the counters of the main loop (see MachineInstrSet::readCSR).
+ADD_CSR(MSTATUS, 0x300, 0x00000088, 0x00001800)
+ADD_CSR(MISA, 0x301, 0x00000000, 0x40000100)
+ADD_CSR(MIE, 0x304, 0x00000888, 0x00000000)
+ADD_CSR(MTVEC, 0x305, 0xfffffffd, 0x00000000)
+ADD_CSR(MSTATUSH, 0x310, 0x00000000, 0x00000000)
+// The counters can't be stopped, all bits are read-only zero
+ADD_CSR(MCOUNTINHIBIT, 0x320, 0x00000000, 0x00000000)
+ADD_CSR(MSCRATCH, 0x340, 0xffffffff, 0x00000000)
+ADD_CSR(MEPC, 0x341, 0xfffffffc, 0x00000000)
+ADD_CSR(MCAUSE, 0x342, 0xffffffff, 0x00000000)
+ADD_CSR(MTVAL, 0x343, 0xffffffff, 0x00000000)
+ADD_CSR(MIP, 0x344, 0x00000000, 0x00000000)
+ADD_CSR(MVENDORID, 0xF11, 0x00000000, 0x00000000)
+ADD_CSR(MARCHID, 0xF12, 0x00000000, 0x00000000)
+ADD_CSR(MIMPID, 0xF13, 0x00000000, 0x00000000)
+ADD_CSR(MHARTID, 0xF14, 0x00000000, 0x00000000)
+
+#endif // ADD_CSR
@@ -0,0 +1,6 @@
+#ifdef ADD_INSTR
+
+ADD_INSTR(MRET, 0b001100000010'00000'000'00000'1110011, 0xffffffff, I)
+ADD_INSTR(WFI, 0b000100000101'00000'000'00000'1110011, 0xffffffff, I)
+
+#endif // ADD_INSTR
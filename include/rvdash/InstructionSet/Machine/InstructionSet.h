@@ -0,0 +1,342 @@
+#ifndef MACHINE_INSTRUCTION_SET_H
+#define MACHINE_INSTRUCTION_SET_H
+
+#include "rvdash/InstructionSet/Extensions.h"
+#include "rvdash/InstructionSet/Instruction.h"
+#include "rvdash/InstructionSet/RV32I/InstructionSet.h"
+#include "rvdash/InstructionSet/Trap.h"
+#include "rvdash/InstructionSet/Zicsr/InstructionSet.h"
+
+#include <array>
+
+namespace rvdash {
+namespace Machine {
+
+//-------------------------------------CSRFile-------------------------------------------
+
+/**
+ * @brief enum CSRIdx - index of a machine CSR in the CSR file, in the order of
+ *                      DefineCSRs.h.
+ */
+enum CSRIdx : uint8_t {
+#define ADD_CSR(Name, Addr, WriteMask, ResetValue) Name,
+#include "DefineCSRs.h"
+#undef ADD_CSR
+  NumCSRs,
+  NoCSR = 0xff,
+};
+
+struct CSRDesc {
+  unsigned Addr;
+  uint32_t WriteMask;
+  uint32_t ResetValue;
+};
+
+inline constexpr CSRDesc CSRDescs[NumCSRs] = {
+#define ADD_CSR(Name, Addr, WriteMask, ResetValue)                             \
+  {Addr, WriteMask, ResetValue},
+#include "DefineCSRs.h"
+#undef ADD_CSR
+};
+
+// The CSR address is 12 bits
+inline constexpr unsigned CSRAddrSpaceSz = 1 << 12;
+
+/**
+ * @brief CSRMap - CSR address to the index in the CSR file, NoCSR for the
+ *                 addresses without a machine CSR. It is built at compile
+ *                 time, so an access is one load from the table.
+ */
+inline constexpr auto CSRMap = []() {
+  std::array<uint8_t, CSRAddrSpaceSz> Map{};
+  Map.fill(NoCSR);
+  for (unsigned Idx = 0; Idx < NumCSRs; ++Idx)
+    Map[CSRDescs[Idx].Addr] = Idx;
+  return Map;
+}();
+
+// mstatus fields, RISC-V privileged spec, figure 3.7. Only M-mode exists, so
+// MPP is always 0b11.
+inline constexpr uint32_t MSTATUS_MIE = 1u << 3;
+inline constexpr uint32_t MSTATUS_MPIE = 1u << 7;
+
+//------------------------------MachineInstrExecutor-------------------------------------
+
+/**
+ * @brief class MachineInstrExecutor - executor of the M-mode privileged
+ *                                     instructions. The CSR file belongs to
+ *                                     the hart, like the X registers, and
+ *                                     it is a dense array: the CSRs are found
+ *                                     by CSRMap.
+ */
+class MachineInstrExecutor {
+
+public:
+  static std::array<uint32_t, NumCSRs> CSRs;
+
+  template <typename InstrSetType>
+  void execute(Instruction Instr, ExecuteFuncType<InstrSetType> Func,
+               InstrSetType &Set) {
+    Func(Instr, Set);
+  }
+
+  static void resetCSRs() {
+    for (unsigned Idx = 0; Idx < NumCSRs; ++Idx)
+      CSRs[Idx] = CSRDescs[Idx].ResetValue;
+  }
+
+  static CSRIdx findCSR(unsigned Csr) {
+    if (Csr >= CSRAddrSpaceSz)
+      return NoCSR;
+    return static_cast<CSRIdx>(CSRMap[Csr]);
+  }
+
+  static std::optional<uint32_t> readCSR(unsigned Csr) {
+    auto Idx = findCSR(Csr);
+    if (Idx == NoCSR)
+      return std::nullopt;
+    return CSRs[Idx];
+  }
+
+  /**
+   * @brief writeCSR - it writes the bits of WriteMask of Csr, false if Csr is
+   *                   read-only or there is no such CSR.
+   */
+  static bool writeCSR(unsigned Csr, uint32_t Value) {
+    auto Idx = findCSR(Csr);
+    if (Idx == NoCSR || Zicsr::isReadOnlyCSR(Csr))
+      return false;
+    auto Mask = CSRDescs[Idx].WriteMask;
+    CSRs[Idx] = (CSRs[Idx] & ~Mask) | (Value & Mask);
+    return true;
+  }
+
+  /**
+   * @brief takeTrap - trap entry: mepc, mcause and mtval are set, MIE goes
+   *                   to MPIE and interrupts are disabled. It returns the
+   *                   address of the handler or std::nullopt without it
+   *                   (the base of mtvec is zero), then nothing is changed.
+   *                   In the vectored mode only interrupts go to
+   *                   base + 4 * cause, the model has no interrupts, so all
+   *                   traps go to the base.
+   */
+  static std::optional<uint64_t> takeTrap(const TrapInfo &Info) {
+    uint32_t Base = CSRs[MTVEC] & ~0b11u;
+    if (Base == 0)
+      return std::nullopt;
+    CSRs[MEPC] = Info.Pc;
+    CSRs[MCAUSE] = static_cast<uint32_t>(Info.Cause);
+    CSRs[MTVAL] = Info.Tval;
+    auto &Status = CSRs[MSTATUS];
+    Status = (Status & ~(MSTATUS_MIE | MSTATUS_MPIE)) |
+             (Status & MSTATUS_MIE ? MSTATUS_MPIE : 0);
+    return Base;
+  }
+
+  //---------------------------------------------------------------------------------------
+
+  /**
+   * @brief executeMRET - trap exit: MPIE goes back to MIE and the execution
+   *                      goes on from mepc.
+   */
+  template <typename InstrSetType>
+  static void executeMRET(Instruction Instr, InstrSetType &Set) {
+    auto &Status = CSRs[MSTATUS];
+    Status = (Status & ~MSTATUS_MIE) |
+             (Status & MSTATUS_MPIE ? MSTATUS_MIE : 0) | MSTATUS_MPIE;
+    if constexpr (InstrSetType::TraceCommits)
+      Set.Trace.csrWrite(CSRDescs[MSTATUS].Addr, Status);
+    RV32I::RV32IInstrExecutor::writePC(CSRs[MEPC] - Instruction::Sz_b, Set);
+  }
+
+  /**
+   * @brief executeWFI - there are no interrupts to wait for, so wfi is a nop
+   *                     (the spec allows it).
+   */
+  template <typename InstrSetType>
+  static void executeWFI(Instruction Instr, InstrSetType &Set) {}
+};
+
+//-------------------------------MachineInstrDecoder-------------------------------------
+
+/**
+ * @brief class MachineInstrDecoder - the decoder works like the RV32I one:
+ *                                    masks of all instructions of the table
+ *                                    are sequentially applied to the
+ *                                    instruction.
+ */
+class MachineInstrDecoder {
+
+public:
+  template <typename InstrSetType>
+  struct InstMapElem {
+    Instruction Instr;
+    std::bitset<Instruction::Sz> Mask;
+    ExecuteFuncType<InstrSetType> Func;
+    // Name from DefineInstrs.h, for the statistics
+    const char *Mnemonic;
+  };
+
+  template <typename InstrSetType>
+  static std::vector<InstMapElem<InstrSetType>> registerInstrs() {
+    std::vector<InstMapElem<InstrSetType>> InstrMap;
+
+#define ADD_INSTR(Name, Instr, Mask, EncodingType)                             \
+  Instruction Name(Instr, InstrEncodingType::EncodingType,                     \
+                   Extensions::Machine);                                       \
+  InstrMap.emplace_back(Name, Mask,                                            \
+                        &MachineInstrExecutor::execute##Name<InstrSetType>,    \
+                        #Name);
+#include "DefineInstrs.h"
+#undef ADD_INSTR
+
+    return InstrMap;
+  }
+
+  template <typename InstrSetType>
+  static const std::vector<InstMapElem<InstrSetType>> &getInstrMap() {
+    static const std::vector<InstMapElem<InstrSetType>> InstrMap =
+        registerInstrs<InstrSetType>();
+    return InstrMap;
+  }
+
+  /**
+   * @brief findMnemonic - name of the instruction executed by Func.
+   */
+  template <typename InstrSetType>
+  static std::optional<const char *>
+  findMnemonic(ExecuteFuncType<InstrSetType> Func) {
+    for (auto &SetInstr : getInstrMap<InstrSetType>())
+      if (SetInstr.Func == Func)
+        return SetInstr.Mnemonic;
+    return std::nullopt;
+  }
+
+  template <typename InstrSetType>
+  std::optional<std::tuple<Instruction, ExecuteFuncType<InstrSetType>>>
+  tryDecode(Register<Instruction::Sz> Instr) {
+    for (auto &SetInstr : getInstrMap<InstrSetType>()) {
+      if (isSame(Instr, SetInstr.Instr.Bits, SetInstr.Mask))
+        return std::tuple{
+            Instruction(Instr, SetInstr.Instr.Type, Extensions::Machine),
+            SetInstr.Func};
+    }
+    return std::nullopt;
+  }
+};
+
+//---------------------------------MachineInstrSet---------------------------------------
+
+/**
+ * @brief class MachineInstrSet - the M-mode privileged architecture: the
+ *                                machine CSRs of DefineCSRs.h (read and
+ *                                written by the Zicsr instructions), the
+ *                                trap entry with mtvec, mret and wfi.
+ */
+class MachineInstrSet {
+
+  MachineInstrDecoder Decoder;
+  MachineInstrExecutor Executor;
+
+public:
+  MachineInstrSet(bool IsForTests = false) { reset(); }
+  MachineInstrSet(SharedHart) {}
+
+  /**
+   * @brief readCSR, writeCSR - the CSR file and the machine counters. There
+   *                            is one counter in the main loop (see
+   *                            getCycle), so mcycle and minstret are the
+   *                            same and a write of one changes the other.
+   */
+  template <typename InstrSetType>
+  std::optional<uint64_t> readCSR(unsigned Csr, const InstrSetType &Set) const {
+    switch (Csr) {
+    case Zicsr::CSR_MCYCLE:
+    case Zicsr::CSR_MINSTRET:
+      return static_cast<uint32_t>(Set.getInstret());
+    case Zicsr::CSR_MCYCLEH:
+    case Zicsr::CSR_MINSTRETH:
+      return static_cast<uint32_t>(Set.getInstret() >> 32);
+    default:
+      return MachineInstrExecutor::readCSR(Csr);
+    }
+  }
+
+  template <typename InstrSetType>
+  bool writeCSR(unsigned Csr, uint64_t Value, InstrSetType &Set) {
+    uint64_t Counter = Set.getInstret();
+    switch (Csr) {
+    case Zicsr::CSR_MCYCLE:
+    case Zicsr::CSR_MINSTRET:
+      Set.setInstret((Counter & ~0xffffffffull) |
+                     static_cast<uint32_t>(Value));
+      return true;
+    case Zicsr::CSR_MCYCLEH:
+    case Zicsr::CSR_MINSTRETH:
+      Set.setInstret((static_cast<uint64_t>(Value) << 32) |
+                     static_cast<uint32_t>(Counter));
+      return true;
+    default:
+      return MachineInstrExecutor::writeCSR(Csr, Value);
+    }
+  }
+
+  /**
+   * @brief saveCSRs, restoreCSR - the CSR file as is, the write masks are
+   *                               not applied.
+   */
+  void saveCSRs(std::vector<CSRValue> &Values) const {
+    for (unsigned Idx = 0; Idx < NumCSRs; ++Idx)
+      Values.push_back({CSRDescs[Idx].Addr, MachineInstrExecutor::CSRs[Idx]});
+  }
+
+  bool restoreCSR(const CSRValue &Saved) {
+    auto Idx = MachineInstrExecutor::findCSR(Saved.Addr);
+    if (Idx == NoCSR)
+      return false;
+    MachineInstrExecutor::CSRs[Idx] = Saved.Value;
+    return true;
+  }
+
+  std::optional<uint64_t> takeTrap(const TrapInfo &Info) {
+    return MachineInstrExecutor::takeTrap(Info);
+  }
+
+  void reset() { MachineInstrExecutor::resetCSRs(); }
+
+  void dump(std::ostream &Stream) const {
+    Stream << "\n\tMachineInstrSet: machine CSRs, mret, wfi\n";
+  }
+  void print() const { dump(std::cout); }
+
+  template <typename InstrSetType>
+  std::optional<std::tuple<Instruction, ExecuteFuncType<InstrSetType>>>
+  tryDecode(Register<Instruction::Sz> Instr, InstrSetType &MainSet) {
+    return Decoder.tryDecode<InstrSetType>(Instr);
+  }
+
+  template <typename InstrSetType>
+  std::optional<const char *>
+  findMnemonic(ExecuteFuncType<InstrSetType> Func,
+               const InstrSetType &MainSet) const {
+    return Decoder.template findMnemonic<InstrSetType>(Func);
+  }
+
+  template <typename InstrSetType>
+  bool tryExecute(Instruction Instr, ExecuteFuncType<InstrSetType> Funct,
+                  InstrSetType &MainSet) {
+    if (Instr.Ex != Extensions::Machine)
+      return true;
+    Executor.execute(Instr, Funct, MainSet);
+    return false;
+  }
+};
+
+} // namespace Machine
+
+std::ostream &operator<<(std::ostream &Stream,
+                         const typename Machine::MachineInstrSet &Set);
+
+} // namespace rvdash
+
+#endif // MACHINE_INSTRUCTION_SET_H
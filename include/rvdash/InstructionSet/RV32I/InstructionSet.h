@@ -3,6 +3,8 @@
 
 #include "rvdash/InstructionSet/Extensions.h"
 #include "rvdash/InstructionSet/Instruction.h"
+#include "rvdash/InstructionSet/SyscallEmulator.h"
+#include "rvdash/InstructionSet/Trap.h"
 
 namespace rvdash {
 namespace RV32I {
@@ -27,13 +29,7 @@ public:
   void setRegister(unsigned RegIdx, const Register<32> &NewValue) override {
     if (RegIdx == 0)
       return;
-    OwnRegs.at(RegIdx) = NewValue;
-  }
-
-  void setRegister(unsigned RegIdx, const Register<32> &NewValue,
-                   std::ostream &LogFile) override {
-    setRegister(RegIdx, NewValue);
-    logChange(RegIdx, NewValue, LogFile);
+    RegistersSet::setRegister(RegIdx, NewValue);
   }
 };
 
@@ -47,14 +43,43 @@ public:
 class RV32IInstrExecutor {
 
   static std::shared_ptr<RV32IRegistersSet> Registers;
+  // Host side of ECALL, it belongs to the hart as the registers do
+  static std::shared_ptr<SyscallEmulator> Syscalls;
+  // The hart was created by this executor (not SharedHart), it is released
+  // with it, so the next model of the process can be created
+  bool OwnsHart = false;
 
 public:
-  RV32IInstrExecutor(bool IsForTests = false) {
+  RV32IInstrExecutor(bool IsForTests = false) : OwnsHart(true) {
     if (Registers != nullptr && !IsForTests)
       failWithError("RV32I Registers already instantiated");
     Registers = std::make_shared<RV32IRegistersSet>();
+    Syscalls = std::make_shared<SyscallEmulator>();
   };
 
+  RV32IInstrExecutor(SharedHart) {
+    if (Registers == nullptr)
+      failWithError("No RV32I Registers to share");
+  }
+
+  RV32IInstrExecutor(const RV32IInstrExecutor &) = delete;
+  RV32IInstrExecutor &operator=(const RV32IInstrExecutor &) = delete;
+
+  ~RV32IInstrExecutor() {
+    if (OwnsHart) {
+      Registers.reset();
+      Syscalls.reset();
+    }
+  }
+
+  /**
+   * @brief resetSyscalls - a new syscall emulator, the open files and the
+   *                        program break of the old one are forgotten.
+   */
+  static void resetSyscalls() {
+    Syscalls = std::make_shared<SyscallEmulator>();
+  }
+
   template <typename InstrSetType>
   void execute(Instruction Instr, ExecuteFuncType<InstrSetType> Func,
                InstrSetType &Set) {
@@ -62,6 +87,50 @@ public:
   }
 
   std::shared_ptr<RV32IRegistersSet> getRegisters() const { return Registers; }
+  std::shared_ptr<SyscallEmulator> getSyscalls() const { return Syscalls; }
+
+  /**
+   * @brief readXReg - X register value for the other extensions.
+   */
+  static uint32_t readXReg(unsigned RegIdx) {
+    return Registers->getRegister(RegIdx).to_ulong();
+  }
+
+  /**
+   * @brief writeXReg, writePC - register writes of the instructions.
+   *                             They are reported to the commit trace.
+   */
+  template <typename InstrSetType>
+  static void writeXReg(unsigned RegIdx, Register<32> Value,
+                        InstrSetType &Set) {
+    Registers->setRegister(RegIdx, Value);
+    if constexpr (InstrSetType::TraceCommits)
+      Set.Trace.regWrite(RegIdx, Value.to_ulong());
+  }
+
+  template <typename InstrSetType>
+  static void writePC(Register<32> Value, InstrSetType &Set) {
+    Registers->setNamedRegister("pc", Value);
+    if constexpr (InstrSetType::TraceCommits)
+      Set.Trace.pcWrite(Value.to_ulong());
+  }
+
+  /**
+   * @brief isAlignedTarget - the target of a jump (DistAddr is the target
+   *                          minus the instruction size, as for writePC) is
+   *                          aligned to the instruction size. Otherwise the
+   *                          misaligned exception is raised, Reason names
+   *                          the instruction in its message.
+   */
+  template <typename InstrSetType>
+  static bool isAlignedTarget(int DistAddr, const char *Reason,
+                              InstrSetType &Set) {
+    if (DistAddr % Instruction::Sz_b == 0)
+      return true;
+    Set.raiseTrap(TrapCause::InstrAddrMisaligned,
+                  static_cast<uint32_t>(DistAddr + Instruction::Sz_b), Reason);
+    return false;
+  }
 
   //---------------------------------------------------------------------------------------
 
@@ -73,10 +142,7 @@ public:
     auto Rs1Value = Registers->getRegister(Rs1).to_ulong();
     auto Rs2Value = Registers->getRegister(Rs2).to_ulong();
     auto Result = Rs1Value + Rs2Value;
-    Set.LogFile << "add "
-                << "X" << int(Rd) << ", X" << int(Rs1) << ", X" << int(Rs2)
-                << "\n";
-    Registers->setRegister(Rd, Result, Set.LogFile);
+    writeXReg(Rd, Result, Set);
 #ifdef DEBUG
     Set.LogFile << "Debug: " << std::dec << "rd (X" << int(Rd)
                 << ") = " << Result << ", rs1 (X" << int(Rs1)
@@ -93,10 +159,7 @@ public:
     auto Rs1Value = Registers->getRegister(Rs1).to_ulong();
     auto Rs2Value = Registers->getRegister(Rs2).to_ulong();
     auto Result = Rs1Value - Rs2Value;
-    Set.LogFile << "sub "
-                << "X" << int(Rd) << ", X" << int(Rs1) << ", X" << int(Rs2)
-                << "\n";
-    Registers->setRegister(Rd, Result, Set.LogFile);
+    writeXReg(Rd, Result, Set);
 #ifdef DEBUG
     Set.LogFile << "Debug: " << std::dec << "rd (X" << int(Rd)
                 << ") = " << Result << ", rs1 (X" << int(Rs1)
@@ -113,10 +176,7 @@ public:
     auto Rs1Value = Registers->getRegister(Rs1);
     auto Rs2Value = Registers->getRegister(Rs2);
     auto Result = Rs1Value ^ Rs2Value;
-    Set.LogFile << "xor "
-                << "X" << int(Rd) << ", X" << int(Rs1) << ", X" << int(Rs2)
-                << "\n";
-    Registers->setRegister(Rd, Result, Set.LogFile);
+    writeXReg(Rd, Result, Set);
 #ifdef DEBUG
     Set.LogFile << "Debug: " << std::dec << "rd (X" << int(Rd)
                 << ") = " << Result << ", rs1 (X" << int(Rs1)
@@ -133,10 +193,7 @@ public:
     auto Rs1Value = Registers->getRegister(Rs1);
     auto Rs2Value = Registers->getRegister(Rs2);
     auto Result = Rs1Value | Rs2Value;
-    Set.LogFile << "or "
-                << "X" << int(Rd) << ", X" << int(Rs1) << ", X" << int(Rs2)
-                << "\n";
-    Registers->setRegister(Rd, Result, Set.LogFile);
+    writeXReg(Rd, Result, Set);
 #ifdef DEBUG
     Set.LogFile << "Debug: " << std::dec << "rd (X" << int(Rd)
                 << ") = " << Result << ", rs1 (X" << int(Rs1)
@@ -153,10 +210,7 @@ public:
     auto Rs1Value = Registers->getRegister(Rs1);
     auto Rs2Value = Registers->getRegister(Rs2);
     auto Result = Rs1Value & Rs2Value;
-    Set.LogFile << "and "
-                << "X" << int(Rd) << ", X" << int(Rs1) << ", X" << int(Rs2)
-                << "\n";
-    Registers->setRegister(Rd, Result, Set.LogFile);
+    writeXReg(Rd, Result, Set);
 #ifdef DEBUG
     Set.LogFile << "Debug: " << std::dec << "rd (X" << int(Rd)
                 << ") = " << Result.to_ulong() << ", rs1 (X" << int(Rs1)
@@ -173,10 +227,7 @@ public:
     auto Rs1Value = Registers->getRegister(Rs1);
     std::bitset<5> Rs2Value = Registers->getRegister(Rs2).to_ulong();
     auto Result = Rs1Value << Rs2Value.to_ulong();
-    Set.LogFile << "sll "
-                << "X" << int(Rd) << ", X" << int(Rs1) << ", X" << int(Rs2)
-                << "\n";
-    Registers->setRegister(Rd, Result, Set.LogFile);
+    writeXReg(Rd, Result, Set);
 #ifdef DEBUG
     Set.LogFile << "Debug: " << std::dec << "rd (X" << int(Rd)
                 << ") = " << Result.to_ulong() << ", rs1 (X" << int(Rs1)
@@ -193,10 +244,7 @@ public:
     auto Rs1Value = Registers->getRegister(Rs1);
     std::bitset<5> Rs2Value = Registers->getRegister(Rs2).to_ulong();
     auto Result = Rs1Value >> Rs2Value.to_ulong();
-    Set.LogFile << "slr "
-                << "X" << int(Rd) << ", X" << int(Rs1) << ", X" << int(Rs2)
-                << "\n";
-    Registers->setRegister(Rd, Result, Set.LogFile);
+    writeXReg(Rd, Result, Set);
 #ifdef DEBUG
     Set.LogFile << "Debug: " << std::dec << "rd (X" << int(Rd)
                 << ") = " << Result << ", rs1 (X" << int(Rs1)
@@ -214,10 +262,7 @@ public:
     std::bitset<5> Rs2Value = Registers->getRegister(Rs2).to_ulong();
     std::bitset<Instruction::Sz> Result =
         int(Rs1Value.to_ulong()) >> Rs2Value.to_ulong();
-    Set.LogFile << "sra "
-                << "X" << int(Rd) << ", X" << int(Rs1) << ", X" << int(Rs2)
-                << "\n";
-    Registers->setRegister(Rd, Result, Set.LogFile);
+    writeXReg(Rd, Result, Set);
 #ifdef DEBUG
     Set.LogFile << "Debug: " << std::dec << "rd (X" << int(Rd)
                 << ") = " << Result << ", rs1 (X" << int(Rs1)
@@ -234,10 +279,7 @@ public:
     int Rs1Value = Registers->getRegister(Rs1).to_ulong();
     int Rs2Value = Registers->getRegister(Rs2).to_ulong();
     bool Result = Rs1Value < Rs2Value;
-    Set.LogFile << "slt "
-                << "X" << int(Rd) << ", X" << int(Rs1) << ", X" << int(Rs2)
-                << "\n";
-    Registers->setRegister(Rd, int(Result), Set.LogFile);
+    writeXReg(Rd, int(Result), Set);
 #ifdef DEBUG
     Set.LogFile << "Debug: " << std::dec << "rd (X" << int(Rd)
                 << ") = " << Result << ", rs1 (X" << int(Rs1)
@@ -254,10 +296,7 @@ public:
     unsigned Rs1Value = Registers->getRegister(Rs1).to_ulong();
     unsigned Rs2Value = Registers->getRegister(Rs2).to_ulong();
     bool Result = Rs1Value < Rs2Value;
-    Set.LogFile << "sltu "
-                << "X" << int(Rd) << ", X" << int(Rs1) << ", X" << int(Rs2)
-                << "\n";
-    Registers->setRegister(Rd, int(Result), Set.LogFile);
+    writeXReg(Rd, int(Result), Set);
 #ifdef DEBUG
     Set.LogFile << "Debug: " << std::dec << "rd (X" << int(Rd)
                 << ") = " << Result << ", rs1 (X" << int(Rs1)
@@ -273,17 +312,12 @@ public:
     auto Rd = Instr.extractRd();
     auto Rs1 = Instr.extractRs1();
     int Imm = signExtend<12, 32>(Instr.extractImm_11_0());
-    if (Rd == 0 && Rs1 == 0 && Imm == 0) {
-      Set.LogFile << "nop\n";
+    // nop
+    if (Rd == 0 && Rs1 == 0 && Imm == 0)
       return;
-    }
     int Rs1Value = Registers->getRegister(Rs1).to_ulong();
     auto Result = Rs1Value + Imm;
-    Set.LogFile << "addi "
-                << "X" << int(Rd) << ", X" << int(Rs1) << ", 0x" << std::hex
-                << Imm << "\n";
-    Set.LogFile << std::dec;
-    Registers->setRegister(Rd, Result, Set.LogFile);
+    writeXReg(Rd, Result, Set);
 #ifdef DEBUG
     Set.LogFile << "Debug: " << std::dec << "rd (X" << int(Rd)
                 << ") = " << Result << ", rs1 (X" << int(Rs1)
@@ -298,11 +332,7 @@ public:
     int Imm = signExtend<12, 32>(Instr.extractImm_11_0());
     int Rs1Value = Registers->getRegister(Rs1).to_ulong();
     auto Result = Rs1Value ^ Imm;
-    Set.LogFile << "xori "
-                << "X" << int(Rd) << ", X" << int(Rs1) << ", 0x" << std::hex
-                << Imm << "\n";
-    Set.LogFile << std::dec;
-    Registers->setRegister(Rd, Result, Set.LogFile);
+    writeXReg(Rd, Result, Set);
 #ifdef DEBUG
     Set.LogFile << "Debug: " << std::dec << "rd (X" << int(Rd)
                 << ") = " << Result << ", rs1 (X" << int(Rs1)
@@ -317,11 +347,7 @@ public:
     int Imm = signExtend<12, 32>(Instr.extractImm_11_0());
     int Rs1Value = Registers->getRegister(Rs1).to_ulong();
     auto Result = Rs1Value | Imm;
-    Set.LogFile << "ori "
-                << "X" << int(Rd) << ", X" << int(Rs1) << ", 0x" << std::hex
-                << Imm << "\n";
-    Set.LogFile << std::dec;
-    Registers->setRegister(Rd, Result, Set.LogFile);
+    writeXReg(Rd, Result, Set);
 #ifdef DEBUG
     Set.LogFile << "Debug: " << std::dec << "rd (X" << int(Rd)
                 << ") = " << Result << ", rs1 (X" << int(Rs1)
@@ -336,11 +362,7 @@ public:
     int Imm = signExtend<12, 32>(Instr.extractImm_11_0());
     int Rs1Value = Registers->getRegister(Rs1).to_ulong();
     auto Result = Rs1Value & Imm;
-    Set.LogFile << "andi "
-                << "X" << int(Rd) << ", X" << int(Rs1) << ", 0x" << std::hex
-                << Imm << "\n";
-    Set.LogFile << std::dec;
-    Registers->setRegister(Rd, Result, Set.LogFile);
+    writeXReg(Rd, Result, Set);
 #ifdef DEBUG
     Set.LogFile << "Debug: " << std::dec << "rd (X" << int(Rd)
                 << ") = " << Result << ", rs1 (X" << int(Rs1)
@@ -355,11 +377,7 @@ public:
     unsigned Rs1Value = Registers->getRegister(Rs1).to_ulong();
     std::bitset<5> Imm = Instr.extractImm_11_0();
     auto Result = Rs1Value << Imm.to_ulong();
-    Set.LogFile << "slli "
-                << "X" << int(Rd) << ", X" << int(Rs1) << ", 0x" << std::hex
-                << Imm.to_ulong() << "\n";
-    Set.LogFile << std::dec;
-    Registers->setRegister(Rd, Result, Set.LogFile);
+    writeXReg(Rd, Result, Set);
 #ifdef DEBUG
     Set.LogFile << "Debug: " << std::dec << "rd (X" << int(Rd)
                 << ") = " << Result << ", rs1 (X" << int(Rs1)
@@ -375,11 +393,7 @@ public:
     unsigned Rs1Value = Registers->getRegister(Rs1).to_ulong();
     std::bitset<5> Imm = Instr.extractImm_11_0();
     auto Result = Rs1Value >> Imm.to_ulong();
-    Set.LogFile << "srli "
-                << "X" << int(Rd) << ", X" << int(Rs1) << ", 0x" << std::hex
-                << Imm.to_ulong() << "\n";
-    Set.LogFile << std::dec;
-    Registers->setRegister(Rd, Result, Set.LogFile);
+    writeXReg(Rd, Result, Set);
 #ifdef DEBUG
     Set.LogFile << "Debug: " << std::dec << "rd (X" << int(Rd)
                 << ") = " << Result << ", rs1 (X" << int(Rs1)
@@ -395,11 +409,7 @@ public:
     int Rs1Value = Registers->getRegister(Rs1).to_ulong();
     std::bitset<5> Imm = Instr.extractImm_11_0();
     auto Result = int(Rs1Value) >> Imm.to_ulong();
-    Set.LogFile << "srai "
-                << "X" << int(Rd) << ", X" << int(Rs1) << ", 0x" << std::hex
-                << Imm.to_ulong() << "\n";
-    Set.LogFile << std::dec;
-    Registers->setRegister(Rd, Result, Set.LogFile);
+    writeXReg(Rd, Result, Set);
 #ifdef DEBUG
     Set.LogFile << "Debug: " << std::dec << "rd (X" << int(Rd)
                 << ") = " << Result << ", rs1 (X" << int(Rs1)
@@ -415,11 +425,7 @@ public:
     int Imm = signExtend<12, 32>(Instr.extractImm_11_0());
     int Rs1Value = Registers->getRegister(Rs1).to_ulong();
     bool Result = Rs1Value < Imm;
-    Set.LogFile << "slti "
-                << "X" << int(Rd) << ", X" << int(Rs1) << ", 0x" << std::hex
-                << Imm << "\n";
-    Set.LogFile << std::dec;
-    Registers->setRegister(Rd, int(Result), Set.LogFile);
+    writeXReg(Rd, int(Result), Set);
 #ifdef DEBUG
     Set.LogFile << "Debug: " << std::dec << "rd (X" << int(Rd)
                 << ") = " << Result << ", rs1 (X" << int(Rs1)
@@ -434,11 +440,7 @@ public:
     unsigned Imm = signExtend<12, 32>(Instr.extractImm_11_0());
     unsigned Rs1Value = Registers->getRegister(Rs1).to_ulong();
     bool Result = Rs1Value < Imm;
-    Set.LogFile << "sltiu "
-                << "X" << int(Rd) << ", X" << int(Rs1) << ", 0x" << std::hex
-                << Imm << "\n";
-    Set.LogFile << std::dec;
-    Registers->setRegister(Rd, int(Result), Set.LogFile);
+    writeXReg(Rd, int(Result), Set);
 #ifdef DEBUG
     Set.LogFile << "Debug: " << std::dec << "rd (X" << int(Rd)
                 << ") = " << Result << ", rs1 (X" << int(Rs1)
@@ -456,12 +458,9 @@ public:
     int Imm = signExtend<12, 32>(Instr.extractImm_11_0());
     auto ResultAddr = Rs1Value + Imm;
     Register<Instruction::Sz> Result;
-    Set.LogFile << "lbu "
-                << "X" << int(Rd) << ", " << std::hex << "0x" << Imm << "(X"
-                << std::dec << int(Rs1) << ")\n";
-    Set.LogFile << std::dec;
-    Set.getMemory().load(ResultAddr, /* Size */ 1, Result, Set.LogFile);
-    Registers->setRegister(Rd, Result, Set.LogFile);
+    if (!Set.loadData(ResultAddr, /* Size */ 1, Result))
+      return;
+    writeXReg(Rd, Result, Set);
 #ifdef DEBUG
     Set.LogFile << "Debug: " << std::dec << "rd (X" << int(Rd)
                 << ") = " << Result << ", rs1 (X" << int(Rs1)
@@ -477,12 +476,9 @@ public:
     int Imm = signExtend<12, 32>(Instr.extractImm_11_0());
     auto ResultAddr = Rs1Value + Imm;
     Register<Instruction::Sz> Result;
-    Set.LogFile << "lhu "
-                << "X" << int(Rd) << ", " << std::hex << "0x" << Imm << "(X"
-                << std::dec << int(Rs1) << ")\n";
-    Set.LogFile << std::dec;
-    Set.getMemory().load(ResultAddr, /* Size */ 2, Result, Set.LogFile);
-    Registers->setRegister(Rd, Result, Set.LogFile);
+    if (!Set.loadData(ResultAddr, /* Size */ 2, Result))
+      return;
+    writeXReg(Rd, Result, Set);
 #ifdef DEBUG
     Set.LogFile << "Debug: " << std::dec << "rd (X" << int(Rd)
                 << ") = " << Result << ", rs1 (X" << int(Rs1)
@@ -498,13 +494,10 @@ public:
     int Imm = signExtend<12, 32>(Instr.extractImm_11_0());
     auto ResultAddr = Rs1Value + Imm;
     Register<Instruction::Sz> Result;
-    Set.LogFile << "lb "
-                << "X" << int(Rd) << ", " << std::hex << "0x" << Imm << "(X"
-                << std::dec << int(Rs1) << ")\n";
-    Set.LogFile << std::dec;
-    Set.getMemory().load(ResultAddr, /* Size */ 1, Result, Set.LogFile);
+    if (!Set.loadData(ResultAddr, /* Size */ 1, Result))
+      return;
     Result = signExtend<CHAR_BIT, 32>(Result.to_ulong());
-    Registers->setRegister(Rd, Result, Set.LogFile);
+    writeXReg(Rd, Result, Set);
 #ifdef DEBUG
     Set.LogFile << "Debug: " << std::dec << "rd (X" << int(Rd)
                 << ") = " << Result << ", rs1 (X" << int(Rs1)
@@ -520,13 +513,10 @@ public:
     int Imm = signExtend<12, 32>(Instr.extractImm_11_0());
     auto ResultAddr = Rs1Value + Imm;
     Register<Instruction::Sz> Result;
-    Set.LogFile << "lh "
-                << "X" << int(Rd) << ", " << std::hex << "0x" << Imm << "(X"
-                << std::dec << int(Rs1) << ")\n";
-    Set.LogFile << std::dec;
-    Set.getMemory().load(ResultAddr, /* Size */ 2, Result, Set.LogFile);
+    if (!Set.loadData(ResultAddr, /* Size */ 2, Result))
+      return;
     Result = signExtend<2 * CHAR_BIT, 32>(Result.to_ulong());
-    Registers->setRegister(Rd, Result, Set.LogFile);
+    writeXReg(Rd, Result, Set);
 #ifdef DEBUG
     Set.LogFile << "Debug: " << std::dec << "rd (X" << int(Rd)
                 << ") = " << Result << ", rs1 (X" << int(Rs1)
@@ -542,12 +532,9 @@ public:
     int Imm = signExtend<12, 32>(Instr.extractImm_11_0());
     auto ResultAddr = Rs1Value + Imm;
     Register<Instruction::Sz> Result;
-    Set.LogFile << "lw "
-                << "X" << int(Rd) << ", " << std::hex << "0x" << Imm << "(X"
-                << std::dec << int(Rs1) << ")\n";
-    Set.LogFile << std::dec;
-    Set.getMemory().load(ResultAddr, /* Size */ 4, Result, Set.LogFile);
-    Registers->setRegister(Rd, Result, Set.LogFile);
+    if (!Set.loadData(ResultAddr, /* Size */ 4, Result))
+      return;
+    writeXReg(Rd, Result, Set);
 #ifdef DEBUG
     Set.LogFile << "Debug: " << std::dec << "rd (X" << int(Rd)
                 << ") = " << Result << ", rs1 (X" << int(Rs1)
@@ -564,13 +551,8 @@ public:
     auto Rs2 = Instr.extractRs2();
     int Imm = signExtend<12, 32>(Instr.extractImm_S());
     auto ResultAddr = Rs1Value + Imm;
-    Set.LogFile << "sb "
-                << "X" << int(Rs2) << ", " << std::hex << "0x" << Imm << "(X"
-                << std::dec << int(Rs1) << ")\n";
-    Set.LogFile << std::dec;
-    Set.getMemory().store(
-        ResultAddr, /* Size */ 1,
-        std::bitset<8>(Registers->getRegister(Rs2).to_ulong()), Set.LogFile);
+    Set.storeData(ResultAddr, /* Size */ 1,
+                  std::bitset<8>(Registers->getRegister(Rs2).to_ulong()));
 #ifdef DEBUG
     auto Rs2Value = Registers->getRegister(Rs2).to_ulong();
     Set.LogFile << "Debug: " << std::dec << "rs1 (X" << int(Rs1)
@@ -586,13 +568,8 @@ public:
     auto Rs2 = Instr.extractRs2();
     int Imm = signExtend<12, 32>(Instr.extractImm_S());
     auto ResultAddr = Rs1Value + Imm;
-    Set.LogFile << "sh "
-                << "X" << int(Rs2) << ", " << std::hex << "0x" << Imm << "(X"
-                << std::dec << int(Rs1) << ")\n";
-    Set.LogFile << std::dec;
-    Set.getMemory().store(
-        ResultAddr, /* Size */ 2,
-        std::bitset<16>(Registers->getRegister(Rs2).to_ulong()), Set.LogFile);
+    Set.storeData(ResultAddr, /* Size */ 2,
+                  std::bitset<16>(Registers->getRegister(Rs2).to_ulong()));
 #ifdef DEBUG
     auto Rs2Value = Registers->getRegister(Rs2).to_ulong();
     Set.LogFile << "Debug: " << std::dec << "rs1 (X" << int(Rs1)
@@ -608,12 +585,7 @@ public:
     auto Rs2 = Instr.extractRs2();
     int Imm = signExtend<12, 32>(Instr.extractImm_S());
     auto ResultAddr = Rs1Value + Imm;
-    Set.LogFile << "sw "
-                << "X" << int(Rs2) << ", " << std::hex << "0x" << Imm << "(X"
-                << std::dec << int(Rs1) << ")\n";
-    Set.LogFile << std::dec;
-    Set.getMemory().store(ResultAddr, /* Size */ 4, Registers->getRegister(Rs2),
-                          Set.LogFile);
+    Set.storeData(ResultAddr, /* Size */ 4, Registers->getRegister(Rs2));
 #ifdef DEBUG
     auto Rs2Value = Registers->getRegister(Rs2).to_ulong();
     Set.LogFile << "Debug: " << std::dec << "rs1 (X" << int(Rs1)
@@ -633,14 +605,9 @@ public:
     int Imm = signExtend<12, 32>(Instr.extractImm_B());
     auto OldPcValue = Registers->getNamedRegister("pc").to_ulong();
     int DistAddr = OldPcValue + (Imm << 1) - Instruction::Sz_b;
-    if (DistAddr % Instruction::Sz_b != 0)
-      failWithError("Misaligned BEQ : " + std::to_string(DistAddr));
-    Set.LogFile << "beq "
-                << "X" << int(Rs1) << ", X" << int(Rs2) << ", 0x" << std::hex
-                << Imm << "\n";
-    Set.LogFile << std::dec;
-    if (Rs1Value == Rs2Value)
-      Registers->setNamedRegister("pc", DistAddr, Set.LogFile);
+    if (Rs1Value == Rs2Value &&
+        isAlignedTarget(DistAddr, "Misaligned BEQ", Set))
+      writePC(DistAddr, Set);
 #ifdef DEBUG
     Set.LogFile << "Debug: " << std::dec << "rs1 (X" << int(Rs1)
                 << ") = " << Rs1Value << ", rs2 (X" << int(Rs2)
@@ -657,14 +624,9 @@ public:
     int Imm = signExtend<12, 32>(Instr.extractImm_B());
     auto OldPcValue = Registers->getNamedRegister("pc").to_ulong();
     int DistAddr = OldPcValue + (Imm << 1) - Instruction::Sz_b;
-    if (DistAddr % Instruction::Sz_b != 0)
-      failWithError("Misaligned BNE: " + std::to_string(DistAddr));
-    Set.LogFile << "bne "
-                << "X" << int(Rs1) << ", X" << int(Rs2) << ", 0x" << std::hex
-                << Imm << "\n";
-    Set.LogFile << std::dec;
-    if (Rs1Value != Rs2Value)
-      Registers->setNamedRegister("pc", DistAddr, Set.LogFile);
+    if (Rs1Value != Rs2Value &&
+        isAlignedTarget(DistAddr, "Misaligned BNE", Set))
+      writePC(DistAddr, Set);
 #ifdef DEBUG
     Set.LogFile << "Debug: " << std::dec << "rs1 (X" << int(Rs1)
                 << ") = " << Rs1Value << ", rs2 (X" << int(Rs2)
@@ -681,14 +643,9 @@ public:
     int Imm = signExtend<12, 32>(Instr.extractImm_B());
     auto OldPcValue = Registers->getNamedRegister("pc").to_ulong();
     int DistAddr = OldPcValue + (Imm << 1) - Instruction::Sz_b;
-    if (DistAddr % Instruction::Sz_b != 0)
-      failWithError("Misaligned BLT: " + std::to_string(DistAddr));
-    Set.LogFile << "blt "
-                << "X" << int(Rs1) << ", X" << int(Rs2) << ", 0x" << std::hex
-                << Imm << "\n";
-    Set.LogFile << std::dec;
-    if (Rs1Value < Rs2Value)
-      Registers->setNamedRegister("pc", DistAddr, Set.LogFile);
+    if (Rs1Value < Rs2Value &&
+        isAlignedTarget(DistAddr, "Misaligned BLT", Set))
+      writePC(DistAddr, Set);
 #ifdef DEBUG
     Set.LogFile << "Debug: " << std::dec << "rs1 (X" << int(Rs1)
                 << ") = " << Rs1Value << ", rs2 (X" << int(Rs2)
@@ -705,14 +662,9 @@ public:
     int Imm = signExtend<12, 32>(Instr.extractImm_B());
     auto OldPcValue = Registers->getNamedRegister("pc").to_ulong();
     int DistAddr = OldPcValue + (Imm << 1) - Instruction::Sz_b;
-    if (DistAddr % Instruction::Sz_b != 0)
-      failWithError("Misaligned BGE: " + std::to_string(DistAddr));
-    Set.LogFile << "bge "
-                << "X" << int(Rs1) << ", X" << int(Rs2) << ", 0x" << std::hex
-                << Imm << "\n";
-    Set.LogFile << std::dec;
-    if (Rs1Value >= Rs2Value)
-      Registers->setNamedRegister("pc", DistAddr, Set.LogFile);
+    if (Rs1Value >= Rs2Value &&
+        isAlignedTarget(DistAddr, "Misaligned BGE", Set))
+      writePC(DistAddr, Set);
 #ifdef DEBUG
     Set.LogFile << "Debug: " << std::dec << "rs1 (X" << int(Rs1)
                 << ") = " << Rs1Value << ", rs2 (X" << int(Rs2)
@@ -729,14 +681,9 @@ public:
     int Imm = signExtend<12, 32>(Instr.extractImm_B());
     auto OldPcValue = Registers->getNamedRegister("pc").to_ulong();
     int DistAddr = OldPcValue + (Imm << 1) - Instruction::Sz_b;
-    if (DistAddr % Instruction::Sz_b != 0)
-      failWithError("Misaligned BLTU: " + std::to_string(DistAddr));
-    Set.LogFile << "bltu "
-                << "X" << int(Rs1) << ", X" << int(Rs2) << ", 0x" << std::hex
-                << Imm << "\n";
-    Set.LogFile << std::dec;
-    if (Rs1Value < Rs2Value)
-      Registers->setNamedRegister("pc", DistAddr, Set.LogFile);
+    if (Rs1Value < Rs2Value &&
+        isAlignedTarget(DistAddr, "Misaligned BLTU", Set))
+      writePC(DistAddr, Set);
 #ifdef DEBUG
     Set.LogFile << "Debug: " << std::dec << "rs1 (X" << int(Rs1)
                 << ") = " << Rs1Value << ", rs2 (X" << int(Rs2)
@@ -753,15 +700,9 @@ public:
     int Imm = signExtend<12, 32>(Instr.extractImm_B());
     auto OldPcValue = Registers->getNamedRegister("pc").to_ulong();
     int DistAddr = OldPcValue + (Imm << 1) - Instruction::Sz_b;
-    if (DistAddr % Instruction::Sz_b != 0)
-      failWithError("Misaligned BGEU: " +
-                    std::to_string(DistAddr + Instruction::Sz_b));
-    Set.LogFile << "bgeu "
-                << "X" << int(Rs1) << ", X" << int(Rs2) << ", 0x" << std::hex
-                << Imm << "\n";
-    Set.LogFile << std::dec;
-    if (Rs1Value >= Rs2Value)
-      Registers->setNamedRegister("pc", DistAddr, Set.LogFile);
+    if (Rs1Value >= Rs2Value &&
+        isAlignedTarget(DistAddr, "Misaligned BGEU", Set))
+      writePC(DistAddr, Set);
 #ifdef DEBUG
     Set.LogFile << "Debug: " << std::dec << "rs1 (X" << int(Rs1)
                 << ") = " << Rs1Value << ", rs2 (X" << int(Rs2)
@@ -777,15 +718,11 @@ public:
     int Imm = signExtend<20, 32>(Instr.extractImm_J());
     auto OldPcValue = Registers->getNamedRegister("pc").to_ulong();
     int DistAddr = OldPcValue + (Imm << 1) - Instruction::Sz_b;
-    if (DistAddr % Instruction::Sz_b != 0)
-      failWithError("Misaligned JAL: " +
-                    std::to_string(DistAddr + Instruction::Sz_b));
-    Set.LogFile << "jal "
-                << "X" << int(Rd) << ", " << std::hex << "0x" << Imm << "\n";
-    Set.LogFile << std::dec;
+    if (!isAlignedTarget(DistAddr, "Misaligned JAL", Set))
+      return;
     auto RdValue = OldPcValue + Instruction::Sz_b;
-    Registers->setRegister(Rd, RdValue, Set.LogFile);
-    Registers->setNamedRegister("pc", DistAddr, Set.LogFile);
+    writeXReg(Rd, RdValue, Set);
+    writePC(DistAddr, Set);
 #ifdef DEBUG
     Set.LogFile << "Debug: " << std::dec << "jal from " << OldPcValue << " to "
                 << DistAddr + Instruction::Sz_b << "\n";
@@ -800,16 +737,11 @@ public:
     auto Rs1Value = Registers->getRegister(Rs1).to_ulong();
     auto OldPcValue = Registers->getNamedRegister("pc").to_ulong();
     int DistAddr = (Imm + Rs1Value) / 2 * 2 - Instruction::Sz_b;
-    if (DistAddr % Instruction::Sz_b != 0)
-      failWithError("Misaligned JALR: " +
-                    std::to_string(DistAddr + Instruction::Sz_b));
-    Set.LogFile << "jalr "
-                << "X" << int(Rd) << ", " << std::hex << "0x" << Imm << "(X"
-                << std::dec << int(Rs1) << ")\n";
-    Set.LogFile << std::dec;
+    if (!isAlignedTarget(DistAddr, "Misaligned JALR", Set))
+      return;
     auto RdValue = OldPcValue + Instruction::Sz_b;
-    Registers->setRegister(Rd, RdValue, Set.LogFile);
-    Registers->setNamedRegister("pc", DistAddr, Set.LogFile);
+    writeXReg(Rd, RdValue, Set);
+    writePC(DistAddr, Set);
 #ifdef DEBUG
     Set.LogFile << "Debug: " << std::dec << "jalr from " << OldPcValue << " to "
                 << DistAddr + Instruction::Sz_b << "\n";
@@ -822,10 +754,7 @@ public:
   static void executeLUI(Instruction Instr, InstrSetType &Set) {
     auto Rd = Instr.extractRd();
     int Imm = Instr.extractImm_31_12();
-    Set.LogFile << "lui "
-                << "X" << int(Rd) << ", " << std::hex << "0x" << Imm << "\n";
-    Set.LogFile << std::dec;
-    Registers->setRegister(Rd, Imm << 12, Set.LogFile);
+    writeXReg(Rd, Imm << 12, Set);
 #ifdef DEBUG
     Set.LogFile << "Debug: " << std::dec << "rd (X" << int(Rd) << ") = " << Imm
                 << ", Imm = " << Imm << "\n";
@@ -839,10 +768,7 @@ public:
     auto Imm = AsmImm << 12;
     auto OldPcValue = Registers->getNamedRegister("pc").to_ulong();
     auto RdValue = OldPcValue + Imm;
-    Set.LogFile << "auipc "
-                << "X" << int(Rd) << ", " << std::hex << "0x" << AsmImm << "\n";
-    Set.LogFile << std::dec;
-    Registers->setRegister(Rd, RdValue, Set.LogFile);
+    writeXReg(Rd, RdValue, Set);
 #ifdef DEBUG
     Set.LogFile << "Debug: " << std::dec << "auipc addr = " << OldPcValue
                 << ", Rd = " << RdValue << "\n";
@@ -853,44 +779,45 @@ public:
 
   template <typename InstrSetType>
   static void executeECALL(Instruction Instr, InstrSetType &Set) {
-    enum { WRITE_SYSCALL = 64, EXIT_SYSCALL = 93 };
-
-    Set.LogFile << "ecall";
     // In RISC-V the ecall instruction is used to do system call.
     // Calling convention for syscalls:
     //
     //    Syscall arguments are loaded into a0-a5 (X10 - X15)
     //    Syscall number is loaded into a7 (X17)
+    //    Result is returned in a0 (X10)
     //
     auto SysNum = Registers->getRegister(17).to_ulong();
-    // Write system call
-    switch (SysNum) {
-    case WRITE_SYSCALL: {
-      auto Fd = Registers->getRegister(10).to_ulong();
-      auto Ptr = Registers->getRegister(11).to_ulong();
-      auto Size = Registers->getRegister(12).to_ulong();
-      Set.LogFile << " write(" << Fd << ", " << Ptr << ", " << Size << ")\n";
-      std::bitset<CHAR_BIT> Str;
-      for (auto Byte = 0; Byte < static_cast<int>(Size); Byte++, Ptr++) {
-        Set.getMemory().load(Ptr, /* Size */ 1, Str);
-        write(Fd, reinterpret_cast<const void *>(&Str), 1);
-      }
-      break;
-    }
-    case EXIT_SYSCALL: {
-      auto ErCode = Registers->getRegister(10).to_ulong();
-      Set.LogFile << " exit(" << ErCode << ")\n";
+    std::array<uint64_t, 6> Args;
+    for (unsigned Idx = 0; Idx < Args.size(); ++Idx)
+      Args[Idx] = Registers->getRegister(10 + Idx).to_ulong();
+    if constexpr (InstrSetType::TraceCommits)
+      Set.Trace.syscall(SysNum, Args[0], Args[1], Args[2]);
+    if (SysNum == EXIT_SYSCALL || SysNum == EXIT_GROUP_SYSCALL) {
+      Syscalls->flush();
       Set.stop();
-      break;
+      return;
     }
-    default:
-      failWithError("Unknown syscall number " + std::to_string(SysNum));
+    auto Result = Syscalls->emulate(Set.getMemory(), SysNum, Args,
+                                    /* XLen */ 32, Set.getInstret());
+    // A syscall the emulator does not know goes to the trap handler
+    if (!Result.has_value()) {
+      Set.raiseTrap(TrapCause::EcallFromM, /* Tval */ 0,
+                    "Unknown syscall number", SysNum);
+      return;
     }
+    // The output of the program goes right after its trace line, if they
+    // are written to the same stream
+    if constexpr (InstrSetType::TraceCommits)
+      if (Syscalls->isSharedWithTrace()) {
+        Set.Trace.flush();
+        Syscalls->flush();
+      }
+    writeXReg(10, static_cast<uint32_t>(Result.value()), Set);
   }
 
   template <typename InstrSetType>
   static void executeEBREAK(Instruction Instr, InstrSetType &Set) {
-    Set.LogFile << "ebreak\n";
+    Syscalls->flush();
     Set.stop();
   }
 };
@@ -914,6 +841,8 @@ public:
     Instruction Instr;
     std::bitset<Instruction::Sz> Mask;
     ExecuteFuncType<InstrSetType> Func;
+    // Name from DefineInstrs.h, for the statistics
+    const char *Mnemonic;
   };
   
   template <typename InstrSetType>
@@ -923,19 +852,37 @@ public:
 #define ADD_INSTR(Name, Instr, Mask, EncodingType)                             \
   Instruction Name(Instr, InstrEncodingType::EncodingType, Extensions::RV32I); \
   InstrMap.emplace_back(Name, Mask,                                            \
-                        &RV32IInstrExecutor::execute##Name<InstrSetType>);
+                        &RV32IInstrExecutor::execute##Name<InstrSetType>,      \
+                        #Name);
 #include "DefineInstrs.h"
 #undef ADD_INSTR
 
     return InstrMap;
   }
 
+  template <typename InstrSetType>
+  static const std::vector<InstMapElem<InstrSetType>> &getInstrMap() {
+    static const std::vector<InstMapElem<InstrSetType>> InstrMap =
+        registerInstrs<InstrSetType>();
+    return InstrMap;
+  }
+
+  /**
+   * @brief findMnemonic - name of the instruction executed by Func.
+   */
+  template <typename InstrSetType>
+  static std::optional<const char *>
+  findMnemonic(ExecuteFuncType<InstrSetType> Func) {
+    for (auto &SetInstr : getInstrMap<InstrSetType>())
+      if (SetInstr.Func == Func)
+        return SetInstr.Mnemonic;
+    return std::nullopt;
+  }
+
   template <typename InstrSetType>
   std::optional<std::tuple<Instruction, ExecuteFuncType<InstrSetType>>>
   tryDecode(Register<Instruction::Sz> Instr) {
-    static std::vector<InstMapElem<InstrSetType>> InstrMap = registerInstrs<InstrSetType>();
-
-    for (auto &SetInstr : InstrMap) {
+    for (auto &SetInstr : getInstrMap<InstrSetType>()) {
       if (isSame(Instr, SetInstr.Instr.Bits, SetInstr.Mask))
         return std::tuple{
             Instruction(Instr, SetInstr.Instr.Type, Extensions::RV32I),
@@ -964,6 +911,10 @@ public:
     Registers = Executor.getRegisters();
   }
 
+  RV32IInstrSet(SharedHart Tag) : Executor(Tag) {
+    Registers = Executor.getRegisters();
+  }
+
   Register<32> *getPC() { return &Registers->getNamedRegister("pc"); }
 
   uint64_t readXReg(unsigned Reg) const {
@@ -974,6 +925,24 @@ public:
     Registers->setRegister(Reg, NewValue);
   }
 
+  /**
+   * @brief readXRegs - all 32 X registers into Values.
+   */
+  void readXRegs(uint64_t *Values) const { Registers->copyTo(Values); }
+
+  SyscallEmulator &getSyscalls() const { return *Executor.getSyscalls(); }
+
+  /**
+   * @brief reset - the hart as after the construction: zero registers and
+   *                PC, a new syscall emulator.
+   */
+  void reset() {
+    Registers->reset();
+    Executor.resetSyscalls();
+  }
+
+  uint64_t getStateHash() const { return Registers->getStateHash(); }
+
   void dump(std::ostream &Stream) const {
     Stream << "\n\tRV32IInstrSet:\n";
     Registers->dump(Stream);
@@ -986,6 +955,13 @@ public:
     return Decoder.tryDecode<InstrSetType>(Instr);
   }
 
+  template <typename InstrSetType>
+  std::optional<const char *>
+  findMnemonic(ExecuteFuncType<InstrSetType> Func,
+               const InstrSetType &MainSet) const {
+    return Decoder.template findMnemonic<InstrSetType>(Func);
+  }
+
   template <typename InstrSetType>
   bool tryExecute(Instruction Instr, ExecuteFuncType<InstrSetType> Funct,
                   InstrSetType &MainSet) {
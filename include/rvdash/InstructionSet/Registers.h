@@ -13,6 +13,7 @@
 #include <vector>
 
 #include "Error.h"
+#include "StateHash.h"
 
 namespace rvdash {
 
@@ -33,19 +34,6 @@ Register<Sz> operator||(Register<Sz> Lhs, Register<Sz> Rhs) {
 template <size_t Sz>
 class RegistersSet {
 protected:
-  virtual void logChange(unsigned RegIdx, Register<Sz> NewValue,
-                         std::ostream &LogFile) const {
-    LogFile << SetName << std::dec << RegIdx << " <- 0x" << std::hex
-            << NewValue.to_ulong() << "\n";
-    LogFile << std::dec;
-  }
-
-  void logChange(std::string RegName, Register<Sz> NewValue,
-                 std::ostream &LogFile) const {
-    LogFile << RegName << " <- 0x" << std::hex << NewValue.to_ulong() << "\n";
-    LogFile << std::dec;
-  }
-
   virtual const Register<Sz> &operator[](unsigned RegIdx) const {
     return OwnRegs.at(RegIdx);
   }
@@ -76,13 +64,36 @@ public:
   }
 
   virtual void setRegister(unsigned RegIdx, const Register<Sz> &NewValue) {
-    OwnRegs.at(RegIdx) = NewValue;
+    auto &Reg = OwnRegs.at(RegIdx);
+    StateHash ^= hashStateElem(XREG_HASH_DOMAIN, RegIdx, Reg.to_ullong()) ^
+                 hashStateElem(XREG_HASH_DOMAIN, RegIdx, NewValue.to_ullong());
+    Reg = NewValue;
   }
 
-  virtual void setRegister(unsigned RegIdx, const Register<Sz> &NewValue,
-                           std::ostream &LogFile) {
-    setRegister(RegIdx, NewValue);
-    logChange(RegIdx, NewValue, LogFile);
+  /**
+   * @brief getStateHash - xor of hashStateElem for the numbered registers,
+   *                       updated by setRegister. Named registers (pc) are
+   *                       not included, they change on every instruction.
+   */
+  uint64_t getStateHash() const { return StateHash; }
+
+  /**
+   * @brief copyTo - values of all numbered registers into Values, one
+   *                 element for each register.
+   */
+  void copyTo(uint64_t *Values) const {
+    for (size_t Idx = 0; Idx < OwnRegs.size(); ++Idx)
+      Values[Idx] = OwnRegs[Idx].to_ullong();
+  }
+
+  /**
+   * @brief reset - all registers are zero, as after the construction.
+   */
+  virtual void reset() {
+    std::fill(OwnRegs.begin(), OwnRegs.end(), 0);
+    for (auto &[Name, Reg] : NamedRegisters)
+      Reg = 0;
+    StateHash = 0;
   }
 
   virtual void addNamedRegister(const std::string &Name) {
@@ -94,13 +105,6 @@ public:
     NamedRegisters.at(Name) = NewValue;
   }
 
-  virtual void setNamedRegister(const std::string &Name,
-                                const Register<Sz> &NewValue,
-                                std::ostream &LogFile) {
-    setNamedRegister(Name, NewValue);
-    logChange(Name, NewValue, LogFile);
-  }
-
   virtual void dump(std::ostream &Stream) const {
     Stream << "\t\tRegisters Set:\n";
     if (NamedRegisters.size() != 0) {
@@ -119,6 +123,7 @@ protected:
   const char *SetName;
   std::vector<Register<Sz>> OwnRegs;
   std::unordered_map<std::string, Register<Sz>> NamedRegisters;
+  uint64_t StateHash = 0;
 };
 
 template <size_t Sz> std::bitset<Sz> operator++(Register<Sz> &Reg) {
@@ -0,0 +1,356 @@
+#ifndef SYSCALL_EMULATOR_H
+#define SYSCALL_EMULATOR_H
+
+#include "Error.h"
+#include "rvdash/InstructionSet/SyscallLog.h"
+#include "rvdash/InstructionSet/Syscalls.h"
+
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace rvdash {
+
+//-------------------------------------GuestStat-----------------------------------------
+
+/**
+ * @brief struct GuestStat - struct stat of the RISC-V Linux ABI (the
+ *                           asm-generic layout, the same for RV32 and RV64),
+ *                           it is copied into the guest memory as is.
+ */
+struct GuestStat {
+  uint64_t Dev;
+  uint64_t Ino;
+  uint32_t Mode;
+  uint32_t Nlink;
+  uint32_t Uid;
+  uint32_t Gid;
+  uint64_t Rdev;
+  uint64_t Pad1;
+  int64_t Size;
+  int32_t Blksize;
+  int32_t Pad2;
+  int64_t Blocks;
+  int64_t Atime;
+  int64_t AtimeNsec;
+  int64_t Mtime;
+  int64_t MtimeNsec;
+  int64_t Ctime;
+  int64_t CtimeNsec;
+  int32_t Unused[2];
+};
+static_assert(sizeof(GuestStat) == 128, "Wrong layout of the guest stat");
+
+//----------------------------------SyscallEmulator--------------------------------------
+
+/**
+ * @brief class SyscallEmulator - Linux syscalls of the guest (ECALL) done by
+ *                                the host. Guest descriptors are mapped to
+ *                                the host ones, 0, 1 and 2 are the
+ *                                simulator's own. Guest buffers are copied
+ *                                by pages (Memory::loadBytes/storeBytes) and
+ *                                passed to the host in chunks of ChunkSz.
+ *                                The output to stdout and stderr is
+ *                                buffered until flush, a read, a write to
+ *                                another descriptor or the buffer is full.
+ *                                Results are the Linux ones, -errno on
+ *                                failure.
+ *                                A recording run logs what the host gives
+ *                                to the guest, a replaying run takes it from
+ *                                the log and does not touch the host (only
+ *                                the output to stdout and stderr is done,
+ *                                if it is not skipped).
+ */
+class SyscallEmulator {
+
+public:
+  static constexpr uint64_t ChunkSz = 1 << 16;
+  static constexpr uint64_t MaxPathSz = 4096;
+
+private:
+  // Host descriptor of every guest one, -1 for the free ones
+  std::vector<int> HostFds{0, 1, 2};
+  // Buffered output and its host descriptor
+  std::vector<unsigned char> OutBuffer;
+  int OutFd = -1;
+  std::vector<unsigned char> Chunk;
+  uint64_t BrkStart = 0;
+  uint64_t Brk = 0;
+  std::unique_ptr<SyscallLogWriter> Recorder;
+  std::unique_ptr<SyscallLogReader> Replayer;
+  bool SkipOutput = false;
+  // The trace is written to the same stream as the guest output
+  bool SharedWithTrace = false;
+  // The record of the current syscall
+  SyscallRecord Current;
+  // All syscalls for the re-execution after a reverse step, the ones from
+  // HistoryPos on are replayed
+  bool KeepHistory = false;
+  std::vector<SyscallRecord> History;
+  size_t HistoryPos = 0;
+  // The stores of the current syscall are kept for another model
+  bool KeepStores = false;
+
+  int getHostFd(int64_t Fd) const;
+  void bufferOutput(int HostFd, const unsigned char *Data, uint64_t Size);
+
+  template <typename MemoryType>
+  void storeGuest(MemoryType &Mem, uint64_t Addr, uint64_t Size,
+                  const unsigned char *Data);
+  template <typename MemoryType>
+  std::optional<int64_t> emulateHost(MemoryType &Mem, uint64_t SysNum,
+                                     const std::array<uint64_t, 6> &Args,
+                                     unsigned XLen);
+  template <typename MemoryType>
+  int64_t replay(MemoryType &Mem, uint64_t SysNum,
+                 const std::array<uint64_t, 6> &Args, uint64_t Instret,
+                 const SyscallRecord &Record, bool DoOutput);
+
+public:
+  SyscallEmulator() : Chunk(ChunkSz) {}
+  SyscallEmulator(const SyscallEmulator &) = delete;
+  SyscallEmulator &operator=(const SyscallEmulator &) = delete;
+  ~SyscallEmulator() { flush(); }
+
+  /**
+   * @brief flush - it writes the buffered output to the host.
+   */
+  void flush();
+
+  /**
+   * @brief setBrk - the initial program break, the end of the loaded
+   *                 program.
+   */
+  void setBrk(uint64_t Addr) { BrkStart = Brk = Addr; }
+  uint64_t getBrk() const { return Brk; }
+
+  /**
+   * @brief shareWithTrace - the trace goes to stdout too, so the output of
+   *                         every syscall is written right after its trace
+   *                         line (the buffer is flushed by ECALL).
+   */
+  void shareWithTrace() { SharedWithTrace = true; }
+  bool isSharedWithTrace() const { return SharedWithTrace; }
+
+  /**
+   * @brief record, replay - the syscalls are logged into Path or are taken
+   *                         from it. With SkipOutputs the replay writes
+   *                         nothing at all.
+   */
+  void record(const std::string &Path);
+  void replay(const std::string &Path, bool SkipOutputs);
+
+  /**
+   * @brief keepHistory, rewindHistory - the syscalls are kept in memory, so
+   *                                     the execution can go back: after
+   *                                     rewindHistory the ones from the
+   *                                     instruction Instret on are replayed
+   *                                     (without any output) until the
+   *                                     history ends.
+   */
+  void keepHistory() { KeepHistory = true; }
+  void rewindHistory(uint64_t Instret);
+
+  /**
+   * @brief keepStores, getLast - the last syscall with the guest memory it
+   *                              wrote, for a model that does not do the
+   *                              syscalls itself (the lockstep reference).
+   */
+  void keepStores() { KeepStores = true; }
+  const SyscallRecord &getLast() const { return Current; }
+
+  //------------------------------------Host side----------------------------------------
+
+  int64_t writeHost(int64_t Fd, const unsigned char *Data, uint64_t Size);
+  int64_t readHost(int64_t Fd, unsigned char *Data, uint64_t Size);
+  int64_t openat(int64_t DirFd, const std::string &Path, int64_t Flags,
+                 int64_t Mode);
+  int64_t close(int64_t Fd);
+  int64_t lseek(int64_t Fd, int64_t Offset, int64_t Whence);
+  int64_t fstat(int64_t Fd, GuestStat &Stat);
+  int64_t clockGettime(int64_t ClockId, int64_t &Sec, int64_t &Nsec);
+  uint64_t brk(uint64_t Addr);
+
+  //------------------------------------Guest side---------------------------------------
+
+  /**
+   * @brief emulate - it does the syscall SysNum with Args (a0-a5) and
+   *                  returns the value for a0. XLen is the size of the
+   *                  guest registers in bits, the signed arguments are
+   *                  extended from it. Instret is the number of the ECALL
+   *                  for the syscall log. std::nullopt means an unknown
+   *                  syscall. exit and exit_group are done by the caller.
+   */
+  template <typename MemoryType>
+  std::optional<int64_t> emulate(MemoryType &Mem, uint64_t SysNum,
+                                 const std::array<uint64_t, 6> &Args,
+                                 unsigned XLen, uint64_t Instret);
+};
+
+template <typename MemoryType>
+std::optional<int64_t>
+SyscallEmulator::emulate(MemoryType &Mem, uint64_t SysNum,
+                         const std::array<uint64_t, 6> &Args, unsigned XLen,
+                         uint64_t Instret) {
+  // The re-execution, the syscall was done already
+  if (HistoryPos < History.size())
+    return replay(Mem, SysNum, Args, Instret, History[HistoryPos++],
+                  /* DoOutput */ false);
+  std::optional<int64_t> Result;
+  if (Replayer != nullptr) {
+    if (!Replayer->read(Current))
+      failWithError("Replay diverged: syscall " + std::to_string(SysNum) +
+                    " at instruction " + std::to_string(Instret) +
+                    " is not in the log");
+    Result = replay(Mem, SysNum, Args, Instret, Current, !SkipOutput);
+  } else {
+    Current.Instret = Instret;
+    Current.SysNum = SysNum;
+    Current.Stores.clear();
+    Result = emulateHost(Mem, SysNum, Args, XLen);
+    if (!Result.has_value())
+      return Result;
+    Current.Result = Result.value();
+    if (Recorder != nullptr)
+      Recorder->write(Current);
+  }
+  if (KeepHistory) {
+    History.push_back(Current);
+    HistoryPos = History.size();
+  }
+  return Result;
+}
+
+template <typename MemoryType>
+void SyscallEmulator::storeGuest(MemoryType &Mem, uint64_t Addr, uint64_t Size,
+                                 const unsigned char *Data) {
+  Mem.storeBytes(Addr, Size, Data);
+  if (Recorder != nullptr || KeepHistory || KeepStores)
+    Current.Stores.emplace_back(
+        Addr, std::vector<unsigned char>(Data, Data + Size));
+}
+
+template <typename MemoryType>
+int64_t SyscallEmulator::replay(MemoryType &Mem, uint64_t SysNum,
+                                const std::array<uint64_t, 6> &Args,
+                                uint64_t Instret, const SyscallRecord &Record,
+                                bool DoOutput) {
+  if (Record.SysNum != SysNum || Record.Instret != Instret)
+    failWithError("Replay diverged: syscall " + std::to_string(SysNum) +
+                  " at instruction " + std::to_string(Instret) +
+                  ", the log has syscall " + std::to_string(Record.SysNum) +
+                  " at instruction " + std::to_string(Record.Instret));
+  // Only the output to stdout and stderr is done again, files are not opened
+  if (SysNum == WRITE_SYSCALL && DoOutput && Record.Result > 0 &&
+      (Args[0] == 1 || Args[0] == 2))
+    for (uint64_t Done = 0; Done < static_cast<uint64_t>(Record.Result);) {
+      auto Count = std::min<uint64_t>(Record.Result - Done, ChunkSz);
+      Mem.loadBytes(Args[1] + Done, Count, Chunk.data());
+      bufferOutput(Args[0], Chunk.data(), Count);
+      Done += Count;
+    }
+  for (auto &[Addr, Bytes] : Record.Stores)
+    Mem.storeBytes(Addr, Bytes.size(), Bytes.data());
+  if (SysNum == BRK_SYSCALL)
+    Brk = Record.Result;
+  return Record.Result;
+}
+
+template <typename MemoryType>
+std::optional<int64_t>
+SyscallEmulator::emulateHost(MemoryType &Mem, uint64_t SysNum,
+                             const std::array<uint64_t, 6> &Args,
+                             unsigned XLen) {
+  auto Signed = [XLen](uint64_t Value) {
+    return XLen == 64 ? static_cast<int64_t>(Value)
+                      : static_cast<int64_t>(static_cast<int32_t>(Value));
+  };
+  switch (SysNum) {
+  case WRITE_SYSCALL: {
+    auto Ptr = Args[1];
+    int64_t Done = 0;
+    for (auto Left = Args[2]; Left != 0;) {
+      auto Count = std::min(Left, ChunkSz);
+      Mem.loadBytes(Ptr, Count, Chunk.data());
+      auto Written = writeHost(Signed(Args[0]), Chunk.data(), Count);
+      if (Written < 0)
+        return Done == 0 ? Written : Done;
+      Done += Written;
+      if (static_cast<uint64_t>(Written) < Count)
+        break;
+      Ptr += Count;
+      Left -= Count;
+    }
+    return Done;
+  }
+  case READ_SYSCALL: {
+    auto Ptr = Args[1];
+    int64_t Done = 0;
+    for (auto Left = Args[2]; Left != 0;) {
+      auto Count = std::min(Left, ChunkSz);
+      auto Read = readHost(Signed(Args[0]), Chunk.data(), Count);
+      if (Read < 0)
+        return Done == 0 ? Read : Done;
+      storeGuest(Mem, Ptr, Read, Chunk.data());
+      Done += Read;
+      // A short read (a terminal, a pipe, the end of the file) ends it
+      if (static_cast<uint64_t>(Read) < Count)
+        break;
+      Ptr += Count;
+      Left -= Count;
+    }
+    return Done;
+  }
+  case OPENAT_SYSCALL: {
+    std::string Path;
+    for (auto Ptr = Args[1];; ++Ptr) {
+      unsigned char Char;
+      Mem.loadBytes(Ptr, /* Size */ 1, &Char);
+      if (Char == 0)
+        break;
+      if (Path.size() == MaxPathSz)
+        return -36; // ENAMETOOLONG
+      Path.push_back(Char);
+    }
+    return openat(Signed(Args[0]), Path, Args[2], Args[3]);
+  }
+  case CLOSE_SYSCALL:
+    return close(Signed(Args[0]));
+  case LSEEK_SYSCALL:
+    return lseek(Signed(Args[0]), Signed(Args[1]), Args[2]);
+  case FSTAT_SYSCALL: {
+    GuestStat Stat{};
+    auto Result = fstat(Signed(Args[0]), Stat);
+    if (Result == 0)
+      storeGuest(Mem, Args[1], sizeof(Stat),
+                 reinterpret_cast<const unsigned char *>(&Stat));
+    return Result;
+  }
+  case CLOCK_GETTIME_SYSCALL: {
+    int64_t Sec, Nsec;
+    auto Result = clockGettime(Signed(Args[0]), Sec, Nsec);
+    if (Result != 0)
+      return Result;
+    // struct timespec of two longs of the guest
+    auto LongSz = XLen / CHAR_BIT;
+    storeGuest(Mem, Args[1], LongSz,
+               reinterpret_cast<const unsigned char *>(&Sec));
+    storeGuest(Mem, Args[1] + LongSz, LongSz,
+               reinterpret_cast<const unsigned char *>(&Nsec));
+    return 0;
+  }
+  case BRK_SYSCALL:
+    return brk(Args[0]);
+  default:
+    return std::nullopt;
+  }
+}
+
+} // namespace rvdash
+
+#endif // SYSCALL_EMULATOR_H
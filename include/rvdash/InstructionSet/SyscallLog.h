@@ -0,0 +1,71 @@
+#ifndef SYSCALL_LOG_H
+#define SYSCALL_LOG_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace rvdash {
+
+//-----------------------------------SyscallRecord---------------------------------------
+
+/**
+ * @brief struct SyscallRecord - everything the host gave to the guest in one
+ *                               syscall: the value of a0 and the bytes
+ *                               stored into the guest memory (read data,
+ *                               struct stat, struct timespec). Instret is
+ *                               the number of the ECALL instruction, it
+ *                               finds the divergence of a replay.
+ */
+struct SyscallRecord {
+  uint64_t Instret = 0;
+  uint64_t SysNum = 0;
+  int64_t Result = 0;
+  std::vector<std::pair<uint64_t, std::vector<unsigned char>>> Stores;
+};
+
+//-----------------------------------SyscallLog------------------------------------------
+
+/**
+ * @brief class SyscallLogWriter, SyscallLogReader - syscall log file
+ *                                                   (--record, --replay).
+ *                                                   After the header the
+ *                                                   records go one by one,
+ *                                                   all numbers are LEB128
+ *                                                   (the instret as the
+ *                                                   distance from the
+ *                                                   previous record, the
+ *                                                   result zigzag-encoded),
+ *                                                   so a usual syscall
+ *                                                   takes a few bytes.
+ */
+class SyscallLogWriter {
+  std::ofstream File;
+  uint64_t PrevInstret = 0;
+
+public:
+  explicit SyscallLogWriter(const std::string &Path);
+  ~SyscallLogWriter();
+
+  void write(const SyscallRecord &Record);
+};
+
+class SyscallLogReader {
+  std::ifstream File;
+  std::string Path;
+  uint64_t PrevInstret = 0;
+
+public:
+  explicit SyscallLogReader(const std::string &FilePath);
+
+  /**
+   * @brief read - the next record, false at the end of the log.
+   */
+  bool read(SyscallRecord &Record);
+};
+
+} // namespace rvdash
+
+#endif // SYSCALL_LOG_H
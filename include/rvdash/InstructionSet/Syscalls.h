@@ -0,0 +1,27 @@
+#ifndef SYSCALLS_H
+#define SYSCALLS_H
+
+namespace rvdash {
+
+//-------------------------------------Syscalls------------------------------------------
+
+/**
+ * @brief enum SyscallNumber - Linux RISC-V syscall numbers (a7 register)
+ *                             supported by ECALL.
+ */
+enum SyscallNumber {
+  OPENAT_SYSCALL = 56,
+  CLOSE_SYSCALL = 57,
+  LSEEK_SYSCALL = 62,
+  READ_SYSCALL = 63,
+  WRITE_SYSCALL = 64,
+  FSTAT_SYSCALL = 80,
+  EXIT_SYSCALL = 93,
+  EXIT_GROUP_SYSCALL = 94,
+  CLOCK_GETTIME_SYSCALL = 113,
+  BRK_SYSCALL = 214,
+};
+
+} // namespace rvdash
+
+#endif // SYSCALLS_H
@@ -0,0 +1,48 @@
+#ifndef TRAP_H
+#define TRAP_H
+
+#include <cstdint>
+#include <string>
+
+namespace rvdash {
+
+//---------------------------------------Trap--------------------------------------------
+
+/**
+ * @brief enum TrapCause - exception codes of mcause (RISC-V privileged spec,
+ *                         table 3.6) that the model raises.
+ */
+enum class TrapCause : uint32_t {
+  InstrAddrMisaligned = 0,
+  InstrAccessFault = 1,
+  IllegalInstr = 2,
+  LoadAccessFault = 5,
+  StoreAccessFault = 7,
+  EcallFromM = 11,
+};
+
+/**
+ * @brief struct TrapInfo - the trap of one instruction. Pc and Tval go to
+ *                          mepc and mtval. Reason and Info are only for
+ *                          the message when there is no trap handler:
+ *                          Reason is a string literal, so raising a trap
+ *                          builds no strings.
+ */
+struct TrapInfo {
+  TrapCause Cause = TrapCause::IllegalInstr;
+  uint64_t Pc = 0;
+  uint64_t Tval = 0;
+  const char *Reason = nullptr;
+  uint64_t Info = 0;
+};
+
+/**
+ * @brief describeTrap - the error message of a trap without a handler, the
+ *                       same one the model gave before the traps were
+ *                       architectural.
+ */
+std::string describeTrap(const TrapInfo &Trap);
+
+} // namespace rvdash
+
+#endif // TRAP_H
@@ -0,0 +1,10 @@
+#ifdef ADD_INSTR
+
+ADD_INSTR(CSRRW, 0b000000000000'00000'001'00000'1110011, 0x0000707f, I)
+ADD_INSTR(CSRRS, 0b000000000000'00000'010'00000'1110011, 0x0000707f, I)
+ADD_INSTR(CSRRC, 0b000000000000'00000'011'00000'1110011, 0x0000707f, I)
+ADD_INSTR(CSRRWI, 0b000000000000'00000'101'00000'1110011, 0x0000707f, I)
+ADD_INSTR(CSRRSI, 0b000000000000'00000'110'00000'1110011, 0x0000707f, I)
+ADD_INSTR(CSRRCI, 0b000000000000'00000'111'00000'1110011, 0x0000707f, I)
+
+#endif // ADD_INSTR
@@ -0,0 +1,325 @@
+#ifndef ZICSR_INSTRUCTION_SET_H
+#define ZICSR_INSTRUCTION_SET_H
+
+#include "rvdash/InstructionSet/Extensions.h"
+#include "rvdash/InstructionSet/Instruction.h"
+#include "rvdash/InstructionSet/RV32I/InstructionSet.h"
+#include "rvdash/InstructionSet/Trap.h"
+
+#include <sstream>
+
+namespace rvdash {
+
+/**
+ * @brief struct CSRValue - a CSR of the hart state saved as is, for the
+ *                          snapshots and the checkpoints.
+ */
+struct CSRValue {
+  uint64_t Addr;
+  uint64_t Value;
+};
+
+namespace Zicsr {
+
+// RISC-V privileged spec, table 2.2
+enum CSRAddr : unsigned {
+  CSR_CYCLE = 0xC00,
+  CSR_TIME = 0xC01,
+  CSR_INSTRET = 0xC02,
+  CSR_CYCLEH = 0xC80,
+  CSR_TIMEH = 0xC81,
+  CSR_INSTRETH = 0xC82,
+  // The machine counters (table 2.5) exist only with the Machine extension,
+  // they are the same counters as cycle and instret but writable
+  CSR_MCYCLE = 0xB00,
+  CSR_MINSTRET = 0xB02,
+  CSR_MCYCLEH = 0xB80,
+  CSR_MINSTRETH = 0xB82,
+};
+
+/**
+ * @brief isReadOnlyCSR - CSRs with the address bits [11:10] equal to 0b11
+ *                        are read-only.
+ */
+constexpr inline bool isReadOnlyCSR(unsigned Csr) {
+  return ((Csr >> 10) & 0b11) == 0b11;
+}
+
+/**
+ * @brief isWritableCounterCSR - mcycle, minstret and their high halves.
+ */
+constexpr inline bool isWritableCounterCSR(unsigned Csr) {
+  return Csr == CSR_MCYCLE || Csr == CSR_MINSTRET || Csr == CSR_MCYCLEH ||
+         Csr == CSR_MINSTRETH;
+}
+
+//-------------------------------ZicsrInstrExecutor--------------------------------------
+
+/**
+ * @brief class ZicsrInstrExecutor - Zicsr executor contains static functions
+ *                                   to execute the CSR instructions. The
+ *                                   counters are not stored here, they are
+ *                                   taken from the main loop of InstrSetType
+ *                                   (getCycle, getInstret). X registers
+ *                                   belong to RV32I, the other CSRs are
+ *                                   found in all extensions of InstrSetType
+ *                                   (readCSR, writeCSR).
+ */
+class ZicsrInstrExecutor {
+
+public:
+  template <typename InstrSetType>
+  void execute(Instruction Instr, ExecuteFuncType<InstrSetType> Func,
+               InstrSetType &Set) {
+    Func(Instr, Set);
+  }
+
+  /**
+   * @brief readCSR - it returns the value of Csr or std::nullopt if there is
+   *                  no such CSR. The model has no timer, so time is equal
+   *                  to cycle (this keeps runs reproducible).
+   */
+  template <typename InstrSetType>
+  static std::optional<uint32_t> readCSR(unsigned Csr,
+                                         const InstrSetType &Set) {
+    switch (Csr) {
+    case CSR_CYCLE:
+    case CSR_TIME:
+      return static_cast<uint32_t>(Set.getCycle());
+    case CSR_CYCLEH:
+    case CSR_TIMEH:
+      return static_cast<uint32_t>(Set.getCycle() >> 32);
+    case CSR_INSTRET:
+      return static_cast<uint32_t>(Set.getInstret());
+    case CSR_INSTRETH:
+      return static_cast<uint32_t>(Set.getInstret() >> 32);
+    default:
+      return std::nullopt;
+    }
+  }
+
+  /**
+   * @brief executeCSR - common part of all CSR instructions. Op combines the
+   *                     old value with Src. CSR is not read for csrrw with
+   *                     rd = X0 and not written for csrrs/csrrc with a zero
+   *                     source register (or uimm). An unknown CSR or a write
+   *                     to a read-only one is the illegal instruction
+   *                     exception, nothing is changed.
+   */
+  template <typename InstrSetType, typename OpType>
+  static void executeCSR(Instruction Instr, InstrSetType &Set, uint32_t Src,
+                         bool DoRead, bool DoWrite, OpType Op) {
+    auto Rd = Instr.extractRd();
+    auto Csr = Instr.extractImm_11_0();
+    uint32_t OldValue = 0;
+    if (DoRead) {
+      auto Value = Set.readCSR(Csr);
+      if (!Value.has_value()) {
+        Set.raiseTrap(TrapCause::IllegalInstr, Instr.Bits.to_ulong(),
+                      "unknown CSR", Csr);
+        return;
+      }
+      OldValue = Value.value();
+    }
+    if (DoWrite && !Set.writeCSR(Csr, Op(OldValue, Src))) {
+      Set.raiseTrap(TrapCause::IllegalInstr, Instr.Bits.to_ulong(),
+                    isReadOnlyCSR(Csr) ? "write to read-only CSR"
+                                       : "unknown CSR",
+                    Csr);
+      return;
+    }
+    // The value after the write mask goes to the trace
+    if constexpr (InstrSetType::TraceCommits)
+      if (DoWrite)
+        Set.Trace.csrWrite(Csr, Set.readCSR(Csr).value());
+    // The write of a counter is done instead of the increment for this
+    // instruction (unprivileged spec, 2.1), the main loop still adds one
+    if (DoWrite && isWritableCounterCSR(Csr))
+      Set.setInstret(Set.getInstret() - 1);
+    if (DoRead)
+      RV32I::RV32IInstrExecutor::writeXReg(Rd, OldValue, Set);
+#ifdef DEBUG
+    Set.LogFile << "Debug: " << std::dec << "rd (X" << int(Rd)
+                << ") = " << OldValue << ", csr 0x" << std::hex << Csr
+                << std::dec << ", src = " << Src << "\n";
+#endif
+  }
+
+  //---------------------------------------------------------------------------------------
+
+  template <typename InstrSetType>
+  static void executeCSRRW(Instruction Instr, InstrSetType &Set) {
+    auto Src = RV32I::RV32IInstrExecutor::readXReg(Instr.extractRs1());
+    executeCSR(Instr, Set, Src, /* DoRead */ Instr.extractRd() != 0,
+               /* DoWrite */ true, [](uint32_t Old, uint32_t Src) {
+                 return Src;
+               });
+  }
+
+  template <typename InstrSetType>
+  static void executeCSRRS(Instruction Instr, InstrSetType &Set) {
+    auto Src = RV32I::RV32IInstrExecutor::readXReg(Instr.extractRs1());
+    executeCSR(Instr, Set, Src, /* DoRead */ true,
+               /* DoWrite */ Instr.extractRs1() != 0,
+               [](uint32_t Old, uint32_t Src) { return Old | Src; });
+  }
+
+  template <typename InstrSetType>
+  static void executeCSRRC(Instruction Instr, InstrSetType &Set) {
+    auto Src = RV32I::RV32IInstrExecutor::readXReg(Instr.extractRs1());
+    executeCSR(Instr, Set, Src, /* DoRead */ true,
+               /* DoWrite */ Instr.extractRs1() != 0,
+               [](uint32_t Old, uint32_t Src) { return Old & ~Src; });
+  }
+
+  //---------------------------------------------------------------------------------------
+
+  template <typename InstrSetType>
+  static void executeCSRRWI(Instruction Instr, InstrSetType &Set) {
+    uint32_t Uimm = Instr.extractRs1();
+    executeCSR(Instr, Set, Uimm, /* DoRead */ Instr.extractRd() != 0,
+               /* DoWrite */ true, [](uint32_t Old, uint32_t Src) {
+                 return Src;
+               });
+  }
+
+  template <typename InstrSetType>
+  static void executeCSRRSI(Instruction Instr, InstrSetType &Set) {
+    uint32_t Uimm = Instr.extractRs1();
+    executeCSR(Instr, Set, Uimm, /* DoRead */ true, /* DoWrite */ Uimm != 0,
+               [](uint32_t Old, uint32_t Src) { return Old | Src; });
+  }
+
+  template <typename InstrSetType>
+  static void executeCSRRCI(Instruction Instr, InstrSetType &Set) {
+    uint32_t Uimm = Instr.extractRs1();
+    executeCSR(Instr, Set, Uimm, /* DoRead */ true, /* DoWrite */ Uimm != 0,
+               [](uint32_t Old, uint32_t Src) { return Old & ~Src; });
+  }
+};
+
+//--------------------------------ZicsrInstrDecoder--------------------------------------
+
+/**
+ * @brief class ZicsrInstrDecoder - Zicsr decoder works like the RV32I one:
+ *                                  masks of all instructions of the table are
+ *                                  sequentially applied to the instruction.
+ */
+class ZicsrInstrDecoder {
+
+public:
+  template <typename InstrSetType>
+  struct InstMapElem {
+    Instruction Instr;
+    std::bitset<Instruction::Sz> Mask;
+    ExecuteFuncType<InstrSetType> Func;
+    // Name from DefineInstrs.h, for the statistics
+    const char *Mnemonic;
+  };
+
+  template <typename InstrSetType>
+  static std::vector<InstMapElem<InstrSetType>> registerInstrs() {
+    std::vector<InstMapElem<InstrSetType>> InstrMap;
+
+#define ADD_INSTR(Name, Instr, Mask, EncodingType)                             \
+  Instruction Name(Instr, InstrEncodingType::EncodingType, Extensions::Zicsr); \
+  InstrMap.emplace_back(Name, Mask,                                            \
+                        &ZicsrInstrExecutor::execute##Name<InstrSetType>,      \
+                        #Name);
+#include "DefineInstrs.h"
+#undef ADD_INSTR
+
+    return InstrMap;
+  }
+
+  template <typename InstrSetType>
+  static const std::vector<InstMapElem<InstrSetType>> &getInstrMap() {
+    static const std::vector<InstMapElem<InstrSetType>> InstrMap =
+        registerInstrs<InstrSetType>();
+    return InstrMap;
+  }
+
+  /**
+   * @brief findMnemonic - name of the instruction executed by Func.
+   */
+  template <typename InstrSetType>
+  static std::optional<const char *>
+  findMnemonic(ExecuteFuncType<InstrSetType> Func) {
+    for (auto &SetInstr : getInstrMap<InstrSetType>())
+      if (SetInstr.Func == Func)
+        return SetInstr.Mnemonic;
+    return std::nullopt;
+  }
+
+  template <typename InstrSetType>
+  std::optional<std::tuple<Instruction, ExecuteFuncType<InstrSetType>>>
+  tryDecode(Register<Instruction::Sz> Instr) {
+    for (auto &SetInstr : getInstrMap<InstrSetType>()) {
+      if (isSame(Instr, SetInstr.Instr.Bits, SetInstr.Mask))
+        return std::tuple{
+            Instruction(Instr, SetInstr.Instr.Type, Extensions::Zicsr),
+            SetInstr.Func};
+    }
+    return std::nullopt;
+  }
+};
+
+//----------------------------------ZicsrInstrSet----------------------------------------
+
+/**
+ * @brief class ZicsrInstrSet - the Zicsr extension: csrrw, csrrs, csrrc and
+ *                              their immediate forms. The available CSRs are
+ *                              the cycle, time and instret counters (with
+ *                              the high halves), the other CSRs belong to
+ *                              the other extensions.
+ */
+class ZicsrInstrSet {
+
+  ZicsrInstrDecoder Decoder;
+  ZicsrInstrExecutor Executor;
+
+public:
+  ZicsrInstrSet(bool IsForTests = false) {}
+  ZicsrInstrSet(SharedHart) {}
+
+  template <typename InstrSetType>
+  std::optional<uint64_t> readCSR(unsigned Csr, const InstrSetType &Set) const {
+    return ZicsrInstrExecutor::readCSR(Csr, Set);
+  }
+
+  void dump(std::ostream &Stream) const {
+    Stream << "\n\tZicsrInstrSet: cycle, time, instret\n";
+  }
+  void print() const { dump(std::cout); }
+
+  template <typename InstrSetType>
+  std::optional<std::tuple<Instruction, ExecuteFuncType<InstrSetType>>>
+  tryDecode(Register<Instruction::Sz> Instr, InstrSetType &MainSet) {
+    return Decoder.tryDecode<InstrSetType>(Instr);
+  }
+
+  template <typename InstrSetType>
+  std::optional<const char *>
+  findMnemonic(ExecuteFuncType<InstrSetType> Func,
+               const InstrSetType &MainSet) const {
+    return Decoder.template findMnemonic<InstrSetType>(Func);
+  }
+
+  template <typename InstrSetType>
+  bool tryExecute(Instruction Instr, ExecuteFuncType<InstrSetType> Funct,
+                  InstrSetType &MainSet) {
+    if (Instr.Ex != Extensions::Zicsr)
+      return true;
+    Executor.execute(Instr, Funct, MainSet);
+    return false;
+  }
+};
+
+} // namespace Zicsr
+
+std::ostream &operator<<(std::ostream &Stream,
+                         const typename Zicsr::ZicsrInstrSet &Set);
+
+} // namespace rvdash
+
+#endif // ZICSR_INSTRUCTION_SET_H
@@ -0,0 +1,205 @@
+#ifndef LOCKSTEP_H
+#define LOCKSTEP_H
+
+#include "Error.h"
+#include "rvdash/InstructionSet/Instruction.h"
+#include "rvdash/Lockstep/ReferenceModel.h"
+#include "rvdash/Trace/TraceSink.h"
+
+#include <sstream>
+#include <vector>
+
+namespace rvdash {
+
+//----------------------------------LockstepSink-----------------------------------------
+
+/**
+ * @brief class LockstepSink - it remembers the memory writes made since the
+ *                             last comparison with the reference model and
+ *                             passes all events to the real trace sink (if
+ *                             there is one).
+ */
+class LockstepSink : public TraceSink {
+public:
+  struct MemWrite {
+    uint64_t Addr;
+    unsigned Size;
+  };
+
+private:
+  TraceSink *Inner;
+  std::vector<MemWrite> Writes;
+  uint64_t LastPc = 0;
+  uint32_t LastInstr = 0;
+  bool LastSyscall = false;
+
+public:
+  LockstepSink(TraceSink *Sink = nullptr) : Inner(Sink) {}
+
+  const std::vector<MemWrite> &getWrites() const { return Writes; }
+  void clearWrites() { Writes.clear(); }
+  uint64_t getLastPc() const { return LastPc; }
+  uint32_t getLastInstr() const { return LastInstr; }
+  bool isLastSyscall() const { return LastSyscall; }
+
+  void beginSimulation() override {
+    if (Inner)
+      Inner->beginSimulation();
+  }
+  void endSimulation() override {
+    if (Inner)
+      Inner->endSimulation();
+  }
+  void beginInstr(uint64_t Pc, uint32_t Instr) override {
+    LastPc = Pc;
+    LastInstr = Instr;
+    LastSyscall = false;
+    if (Inner)
+      Inner->beginInstr(Pc, Instr);
+  }
+  void endInstr() override {
+    if (Inner)
+      Inner->endInstr();
+  }
+  void regWrite(unsigned RegIdx, uint64_t Value) override {
+    if (Inner)
+      Inner->regWrite(RegIdx, Value);
+  }
+  void pcWrite(uint64_t Value) override {
+    if (Inner)
+      Inner->pcWrite(Value);
+  }
+  void memRead(uint64_t Addr, unsigned Size, uint64_t Value) override {
+    if (Inner)
+      Inner->memRead(Addr, Size, Value);
+  }
+  void memWrite(uint64_t Addr, unsigned Size, uint64_t Value) override {
+    Writes.push_back({Addr, Size});
+    if (Inner)
+      Inner->memWrite(Addr, Size, Value);
+  }
+  void syscall(uint64_t SysNum, uint64_t Arg0, uint64_t Arg1,
+               uint64_t Arg2) override {
+    LastSyscall = true;
+    if (Inner)
+      Inner->syscall(SysNum, Arg0, Arg1, Arg2);
+  }
+  void flush() override {
+    if (Inner)
+      Inner->flush();
+  }
+};
+
+//-------------------------------------Lockstep------------------------------------------
+
+/**
+ * @brief compareWithReference - it compares PC, X registers and the memory
+ *                               written since the last comparison. It returns
+ *                               the report of the differences (empty if the
+ *                               states are the same).
+ */
+template <typename CPUType>
+std::string compareWithReference(const CPUType &Cpu, const ReferenceModel &Ref,
+                                 const LockstepSink &Checker) {
+  std::ostringstream Report;
+  Report << std::hex;
+  RVMXRegSnapshot RefRegs;
+  Ref.readXRegs(RefRegs);
+  auto Pc = Cpu.readPC().to_ullong();
+  if (Pc != RefRegs.PC)
+    Report << "  pc: rvdash 0x" << Pc << ", reference 0x" << RefRegs.PC
+           << "\n";
+  uint64_t XRegs[32];
+  Cpu.readXRegs(XRegs);
+  for (unsigned Reg = 1; Reg < 32; ++Reg)
+    if (XRegs[Reg] != RefRegs.XRegs[Reg])
+      Report << "  X" << std::dec << Reg << std::hex << ": rvdash 0x"
+             << XRegs[Reg] << ", reference 0x" << RefRegs.XRegs[Reg] << "\n";
+  for (const auto &Write : Checker.getWrites()) {
+    for (unsigned Byte = 0; Byte < Write.Size; ++Byte) {
+      auto Addr = Write.Addr + Byte;
+      auto Value = Cpu.loadByte(Addr).to_ulong();
+      char RefValue;
+      Ref.readMem(Addr, /* Count */ 1, &RefValue);
+      if (Value != static_cast<unsigned char>(RefValue))
+        Report << "  mem 0x" << Addr << ": rvdash 0x" << Value
+               << ", reference 0x"
+               << unsigned(static_cast<unsigned char>(RefValue)) << "\n";
+    }
+  }
+  return Report.str();
+}
+
+/**
+ * @brief takeSyscall - the syscall of the last instruction is done by Cpu
+ *                      only, so the host sees it once: the reference gets
+ *                      its result (a0) and the guest memory it wrote and
+ *                      goes to the next instruction.
+ */
+template <typename CPUType>
+void takeSyscall(const CPUType &Cpu, ReferenceModel &Ref,
+                 const LockstepSink &Checker) {
+  Ref.setXReg(10, Cpu.readXReg(10));
+  for (auto &[Addr, Bytes] : Cpu.getSyscalls().getLast().Stores)
+    Ref.writeMem(Addr, Bytes.size(),
+                 reinterpret_cast<const char *>(Bytes.data()));
+  Ref.setPC(Checker.getLastPc() + Instruction::Sz_b);
+}
+
+/**
+ * @brief runLockstep - it executes Program on Cpu and on the reference model
+ *                      together. Every Interval instructions the states are
+ *                      compared and the simulation stops with an error at
+ *                      the first divergence. Checker must be the trace sink
+ *                      of Cpu. The syscalls are not executed by the
+ *                      reference (see takeSyscall).
+ */
+template <typename CPUType>
+void runLockstep(CPUType &Cpu, ReferenceModel &Ref, LockstepSink &Checker,
+                 uint64_t Pc, const std::vector<Register<CHAR_BIT>> &Program,
+                 unsigned long long Interval = 1) {
+  if (Pc % Instruction::Sz_b != 0)
+    failWithError("Pc start address is not aligned to 4 bytes");
+  Cpu.storeProgramInVirtualMemory(Program);
+  std::vector<char> Bytes;
+  Bytes.reserve(Program.size());
+  for (const auto &Byte : Program)
+    Bytes.push_back(static_cast<char>(Byte.to_ulong()));
+  Ref.writeMem(/* Addr */ 0, Bytes.size(), Bytes.data());
+  Cpu.setPC(Pc);
+  Ref.setPC(Pc);
+
+  Cpu.getSyscalls().keepStores();
+
+  Checker.beginSimulation();
+  unsigned long long InstrCount = 0;
+  while (!Cpu.isStopped()) {
+    bool Retired = Cpu.step();
+    Cpu.increasePC();
+    // An unknown syscall traps and exit stops, both are left to the reference
+    if (Checker.isLastSyscall() && Retired && !Cpu.isStopped())
+      takeSyscall(Cpu, Ref, Checker);
+    else
+      Ref.executeInstr();
+    ++InstrCount;
+    if (InstrCount % Interval != 0 && !Cpu.isStopped())
+      continue;
+    auto Differences = compareWithReference(Cpu, Ref, Checker);
+    if (!Differences.empty()) {
+      Checker.flush();
+      std::ostringstream Report;
+      Report << "Lockstep divergence after " << std::dec << InstrCount
+             << " instructions (last pc 0x" << std::hex
+             << Checker.getLastPc() << ", instruction 0x"
+             << Checker.getLastInstr() << "):\n"
+             << Differences;
+      failWithError(Report.str());
+    }
+    Checker.clearWrites();
+  }
+  Checker.endSimulation();
+}
+
+} // namespace rvdash
+
+#endif // LOCKSTEP_H
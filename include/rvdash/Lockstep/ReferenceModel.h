@@ -0,0 +1,70 @@
+#ifndef REFERENCE_MODEL_H
+#define REFERENCE_MODEL_H
+
+#include "SnippyRVdash/VTable.h"
+
+#include <string>
+
+namespace rvdash {
+
+//---------------------------------ReferenceModel----------------------------------------
+
+/**
+ * @brief class ReferenceModel - another model with the RVM interface (the
+ *                               same one that libSnippyRVdash.so exports),
+ *                               loaded from a shared library with dlopen.
+ *                               It is used as the reference in the lockstep
+ *                               mode of rvdashSim. The extensions
+ *                               (RVMExtVTable) are used when the model
+ *                               has them. Its log is not kept (/dev/null).
+ */
+class ReferenceModel {
+  void *Handle = nullptr;
+  const rvm::RVM_FunctionPointers *VTable = nullptr;
+  const rvm::RVMExt_FunctionPointers *ExtVTable = nullptr;
+  RVMConfig Config{};
+  RVMState *State = nullptr;
+
+public:
+  ReferenceModel(const std::string &Path, uint64_t RamStart, uint64_t RamSize);
+  ReferenceModel(const ReferenceModel &) = delete;
+  ReferenceModel &operator=(const ReferenceModel &) = delete;
+  ~ReferenceModel();
+
+  int executeInstr() { return VTable->executeInstr(State); }
+
+  uint64_t readPC() const { return VTable->readPC(State); }
+  void setPC(uint64_t NewPC) { VTable->setPC(State, NewPC); }
+
+  RVMRegT readXReg(unsigned Reg) const {
+    return VTable->readXReg(State, static_cast<RVMXReg>(Reg));
+  }
+  void setXReg(unsigned Reg, RVMRegT Value) {
+    VTable->setXReg(State, static_cast<RVMXReg>(Reg), Value);
+  }
+
+  /**
+   * @brief readXRegs - all X registers and the pc, in one call if the model
+   *                    has rvm_readXRegSnapshot.
+   */
+  void readXRegs(RVMXRegSnapshot &Snapshot) const {
+    if (ExtVTable != nullptr) {
+      ExtVTable->readXRegSnapshot(State, &Snapshot);
+      return;
+    }
+    for (unsigned Reg = 0; Reg < 32; ++Reg)
+      Snapshot.XRegs[Reg] = readXReg(Reg);
+    Snapshot.PC = readPC();
+  }
+
+  void readMem(uint64_t Addr, size_t Count, char *Data) const {
+    VTable->readMem(State, Addr, Count, Data);
+  }
+  void writeMem(uint64_t Addr, size_t Count, const char *Data) {
+    VTable->writeMem(State, Addr, Count, Data);
+  }
+};
+
+} // namespace rvdash
+
+#endif // REFERENCE_MODEL_H
@@ -0,0 +1,104 @@
+#ifndef BRANCH_MODEL_H
+#define BRANCH_MODEL_H
+
+#include "rvdash/Elf/SymbolTable.h"
+#include "rvdash/Stats/BranchPredictors.h"
+
+#include <cstdint>
+#include <iostream>
+#include <unordered_map>
+
+namespace rvdash {
+
+//------------------------------------BranchModel----------------------------------------
+
+/**
+ * @brief class BranchModel - analysis stage for the branch predictors
+ *                            (--branch-predictors). It observes the outcome
+ *                            of every conditional branch and the target of
+ *                            every taken transfer, runs all direction
+ *                            predictors and the BTB+RAS target predictor in
+ *                            one pass and counts their mispredictions for
+ *                            every branch PC. afterStep is called from the
+ *                            AfterStep hook with the encoding of the executed
+ *                            instruction and the PC of the next one.
+ */
+class BranchModel {
+  std::vector<std::unique_ptr<BranchPredictor>> Predictors;
+  std::optional<TargetPredictor> Targets;
+
+  struct BranchStats {
+    uint64_t Execs = 0;
+    uint64_t Taken = 0;
+    // One counter for every predictor, the last one is for the targets
+    std::vector<uint64_t> Misses;
+  };
+  std::unordered_map<uint64_t, BranchStats> Branches;
+  std::vector<uint64_t> TotalMisses;
+  uint64_t Instrs = 0;
+  uint64_t PrevPc;
+  // Verdict for the last instruction, for the timing model
+  bool LastMispredicted = false;
+  // Off during the warm-up: the predictors learn, but nothing is counted
+  bool Counting = true;
+
+  static constexpr uint32_t BRANCH_OPCODE = 0b1100011;
+  static constexpr uint32_t JAL_OPCODE = 0b1101111;
+  static constexpr uint32_t JALR_OPCODE = 0b1100111;
+
+  static bool isLinkReg(unsigned Reg) { return Reg == 1 || Reg == 5; }
+
+  BranchStats &getStats(uint64_t Pc);
+  // Stats is nullptr when the counting is off
+  void countMiss(BranchStats *Stats, size_t Idx);
+  void observeBranch(uint32_t Instr, uint64_t Pc, uint64_t NextPc);
+  void observeJump(uint32_t Instr, uint64_t Pc, uint64_t NextPc);
+
+public:
+  /**
+   * @brief BranchModel - Names are the direction predictors (static,
+   *                      bimodal, gshare, tage) and btb for the BTB with the
+   *                      RAS.
+   */
+  BranchModel(const std::vector<std::string> &Names, uint64_t StartPc);
+
+  void afterStep(uint32_t Instr, uint64_t NextPc) {
+    Instrs += Counting;
+    LastMispredicted = false;
+    auto Opcode = Instr & 0x7f;
+    if (Opcode == BRANCH_OPCODE)
+      observeBranch(Instr, PrevPc, NextPc);
+    else if (Opcode == JAL_OPCODE || Opcode == JALR_OPCODE)
+      observeJump(Instr, PrevPc, NextPc);
+    PrevPc = NextPc;
+  }
+
+  /**
+   * @brief skipTo, setCounting - for the sampled simulation: the
+   *                              instructions up to Pc were not observed,
+   *                              the outcomes observed with the counting
+   *                              off only train the predictors. skipTo is
+   *                              also the trap of the last instruction to
+   *                              the handler at Pc.
+   */
+  void skipTo(uint64_t Pc) { PrevPc = Pc; }
+  void setCounting(bool Enable) { Counting = Enable; }
+
+  /**
+   * @brief lastMispredicted - whether the pipeline would mispredict the last
+   *                           instruction: the direction by the first
+   *                           predictor or the target by the BTB+RAS.
+   */
+  bool lastMispredicted() const { return LastMispredicted; }
+
+  /**
+   * @brief report - MPKI of every predictor and the branches with the most
+   *                 mispredictions.
+   */
+  void report(std::ostream &Stream, const SymbolTable &Symbols,
+              size_t MaxLines = 20) const;
+};
+
+} // namespace rvdash
+
+#endif // BRANCH_MODEL_H
@@ -0,0 +1,163 @@
+#ifndef BRANCH_PREDICTORS_H
+#define BRANCH_PREDICTORS_H
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace rvdash {
+
+//----------------------------------BranchPredictor--------------------------------------
+
+/**
+ * @brief class BranchPredictor - direction predictor of the conditional
+ *                                branches. predict is called before the
+ *                                outcome is known, update right after it.
+ */
+class BranchPredictor {
+public:
+  virtual ~BranchPredictor() = default;
+  virtual const char *getName() const = 0;
+  virtual bool predict(uint64_t Pc, uint64_t Target) = 0;
+  virtual void update(uint64_t Pc, uint64_t Target, bool Taken) = 0;
+};
+
+/**
+ * @brief createBranchPredictor - static (backward taken, forward not taken),
+ *                                bimodal, gshare or tage. nullptr for
+ *                                an unknown name.
+ */
+std::unique_ptr<BranchPredictor> createBranchPredictor(const std::string &Name);
+
+//---------------------------------StaticPredictor---------------------------------------
+
+class StaticPredictor : public BranchPredictor {
+public:
+  const char *getName() const override { return "static"; }
+  bool predict(uint64_t Pc, uint64_t Target) override { return Target <= Pc; }
+  void update(uint64_t Pc, uint64_t Target, bool Taken) override {}
+};
+
+//---------------------------------BimodalPredictor--------------------------------------
+
+/**
+ * @brief class BimodalPredictor - table of 2-bit saturating counters indexed
+ *                                 by the PC.
+ */
+class BimodalPredictor : public BranchPredictor {
+  std::vector<uint8_t> Counters;
+
+public:
+  BimodalPredictor(unsigned IdxBits = 12)
+      : Counters(1u << IdxBits, /* weakly not taken */ 1) {}
+  const char *getName() const override { return "bimodal"; }
+  bool predict(uint64_t Pc, uint64_t Target) override;
+  void update(uint64_t Pc, uint64_t Target, bool Taken) override;
+};
+
+//----------------------------------GsharePredictor--------------------------------------
+
+/**
+ * @brief class GsharePredictor - 2-bit counters indexed by the PC xor the
+ *                                global history of the outcomes.
+ */
+class GsharePredictor : public BranchPredictor {
+  std::vector<uint8_t> Counters;
+  unsigned HistoryBits;
+  uint64_t History = 0;
+
+  size_t getIdx(uint64_t Pc) const {
+    return ((Pc >> 2) ^ History) & (Counters.size() - 1);
+  }
+
+public:
+  GsharePredictor(unsigned IdxBits = 12, unsigned HistBits = 12)
+      : Counters(1u << IdxBits, 1), HistoryBits(HistBits) {}
+  const char *getName() const override { return "gshare"; }
+  bool predict(uint64_t Pc, uint64_t Target) override;
+  void update(uint64_t Pc, uint64_t Target, bool Taken) override;
+};
+
+//-----------------------------------TagePredictor---------------------------------------
+
+/**
+ * @brief class TagePredictor - small TAGE: a bimodal base and NumTables
+ *                              tagged tables indexed by geometric lengths of
+ *                              the global history (up to 64 outcomes). The
+ *                              longest matching table provides the
+ *                              prediction, mispredictions allocate entries
+ *                              in the longer tables.
+ */
+class TagePredictor : public BranchPredictor {
+  static constexpr unsigned NumTables = 4;
+  static constexpr unsigned IdxBits = 10;
+  static constexpr unsigned TagBits = 9;
+  static constexpr std::array<unsigned, NumTables> HistLens = {8, 16, 32, 64};
+  // Useful bits are aged after this number of updates
+  static constexpr uint64_t ResetPeriod = 1 << 18;
+
+  struct Entry {
+    uint16_t Tag = 0;
+    // 3-bit counter, taken from 4
+    uint8_t Ctr = 4;
+    uint8_t Useful = 0;
+  };
+
+  BimodalPredictor Base;
+  std::array<std::vector<Entry>, NumTables> Tables;
+  uint64_t History = 0;
+  uint64_t Updates = 0;
+
+  // The state of the last predict for update
+  std::array<size_t, NumTables> Idxs{};
+  std::array<uint16_t, NumTables> Tags{};
+  std::optional<unsigned> Provider;
+  bool ProviderPred = false;
+  bool AltPred = false;
+
+  static uint64_t fold(uint64_t Hist, unsigned Len, unsigned Bits);
+
+public:
+  TagePredictor();
+  const char *getName() const override { return "tage"; }
+  bool predict(uint64_t Pc, uint64_t Target) override;
+  void update(uint64_t Pc, uint64_t Target, bool Taken) override;
+};
+
+//-----------------------------------TargetPredictor-------------------------------------
+
+/**
+ * @brief class TargetPredictor - branch target buffer and return address
+ *                                stack. It predicts the targets of the
+ *                                taken branches and the jumps: returns use
+ *                                the RAS, all others the direct mapped BTB.
+ */
+class TargetPredictor {
+  struct BtbEntry {
+    uint64_t Pc = ~0ull;
+    uint64_t Target = 0;
+  };
+  std::vector<BtbEntry> Btb;
+  std::vector<uint64_t> Ras;
+  unsigned RasTop = 0;
+
+public:
+  TargetPredictor(unsigned BtbIdxBits = 9, unsigned RasSz = 16)
+      : Btb(1u << BtbIdxBits), Ras(RasSz) {}
+
+  /**
+   * @brief predictAndUpdate - it returns true if the target of the
+   *                           transfer at Pc was predicted correctly.
+   *                           IsCall pushes the return address, IsReturn
+   *                           pops it.
+   */
+  bool predictAndUpdate(uint64_t Pc, uint64_t Target, bool IsCall,
+                        bool IsReturn);
+};
+
+} // namespace rvdash
+
+#endif // BRANCH_PREDICTORS_H
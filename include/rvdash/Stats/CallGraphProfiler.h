@@ -0,0 +1,98 @@
+#ifndef CALL_GRAPH_PROFILER_H
+#define CALL_GRAPH_PROFILER_H
+
+#include "rvdash/Elf/SymbolTable.h"
+
+#include <cstdint>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+namespace rvdash {
+
+//---------------------------------CallGraphProfiler-------------------------------------
+
+/**
+ * @brief class CallGraphProfiler - guest call-graph profiler (--call-graph).
+ *                                  It keeps a shadow return address stack
+ *                                  and counts every executed instruction
+ *                                  for the current call stack (a node of the
+ *                                  calling context tree). Calls are jal/jalr
+ *                                  with rd = x1/x5, returns are
+ *                                  jalr x0, 0(x1/x5). afterStep is called
+ *                                  from the AfterStep hook with the encoding
+ *                                  of the executed instruction and the PC of
+ *                                  the next one.
+ */
+class CallGraphProfiler {
+  struct Node {
+    // Entry address of the function
+    uint64_t Func;
+    unsigned Parent;
+    uint64_t Self = 0;
+    // Return address pushed by the call of this node
+    uint64_t RetAddr = 0;
+    std::vector<std::pair<uint64_t, unsigned>> Children;
+  };
+
+  std::vector<Node> Nodes;
+  unsigned Current = 0;
+  uint64_t PrevPc;
+
+  static constexpr uint32_t JAL_OPCODE = 0b1101111;
+  static constexpr uint32_t JALR_OPCODE = 0b1100111;
+
+  static bool isLinkReg(unsigned Reg) { return Reg == 1 || Reg == 5; }
+
+  void call(uint64_t Target, uint64_t RetAddr);
+  void ret(uint64_t Target);
+
+public:
+  CallGraphProfiler(uint64_t StartPc) : PrevPc(StartPc) {
+    Nodes.push_back({StartPc, /* Parent */ 0});
+  }
+
+  void afterStep(uint32_t Instr, uint64_t NextPc) {
+    ++Nodes[Current].Self;
+    auto Opcode = Instr & 0x7f;
+    if (Opcode == JAL_OPCODE || Opcode == JALR_OPCODE) {
+      unsigned Rd = (Instr >> 7) & 0x1f;
+      unsigned Rs1 = (Instr >> 15) & 0x1f;
+      if (isLinkReg(Rd))
+        call(NextPc, PrevPc + 4);
+      else if (Opcode == JALR_OPCODE && Rd == 0 && isLinkReg(Rs1) &&
+               (Instr >> 20) == 0)
+        ret(NextPc);
+    }
+    PrevPc = NextPc;
+  }
+
+  /**
+   * @brief skipTo - the instructions up to Pc were executed without the
+   *                 profiler (the sampled simulation). The calls and
+   *                 returns among them are not seen, so the old stack is
+   *                 not valid any more: the window starts at the root.
+   */
+  void skipTo(uint64_t Pc) {
+    PrevPc = Pc;
+    Current = 0;
+  }
+
+  /**
+   * @brief trapTo - the instruction took a trap and did not retire, the
+   *                 handler at Pc runs on top of the current stack.
+   */
+  void trapTo(uint64_t Pc) { PrevPc = Pc; }
+
+  /**
+   * @brief writeFolded - it writes one "f1;f2;f3 count" line for every call
+   *                      stack with executed instructions (the collapsed
+   *                      stack format of the flame graph tools). Functions
+   *                      are named by Symbols or by their addresses.
+   */
+  void writeFolded(std::ostream &Stream, const SymbolTable &Symbols) const;
+};
+
+} // namespace rvdash
+
+#endif // CALL_GRAPH_PROFILER_H
@@ -0,0 +1,65 @@
+#ifndef HOT_SPOT_PROFILER_H
+#define HOT_SPOT_PROFILER_H
+
+#include "rvdash/Elf/SymbolTable.h"
+
+#include <cstdint>
+#include <iostream>
+#include <unordered_map>
+
+namespace rvdash {
+
+//----------------------------------HotSpotProfiler--------------------------------------
+
+/**
+ * @brief class HotSpotProfiler - guest profiler (--profile). It counts the
+ *                                PCs of every Interval-th executed
+ *                                instruction (every one for Interval 1, so
+ *                                the counts are exact). afterStep is called
+ *                                from the AfterStep hook with the PC of the
+ *                                next instruction, the instruction that has
+ *                                just been executed is the previous one.
+ */
+class HotSpotProfiler {
+  uint64_t Interval;
+  uint64_t Countdown;
+  uint64_t PrevPc;
+  uint64_t Samples = 0;
+  std::unordered_map<uint64_t, uint64_t> PcCounts;
+
+public:
+  HotSpotProfiler(uint64_t SampleInterval, uint64_t StartPc)
+      : Interval(SampleInterval), Countdown(SampleInterval), PrevPc(StartPc) {}
+
+  void afterStep(uint64_t NextPc) {
+    if (--Countdown == 0) {
+      Countdown = Interval;
+      ++PcCounts[PrevPc];
+      ++Samples;
+    }
+    PrevPc = NextPc;
+  }
+
+  /**
+   * @brief skipTo - the instructions up to Pc were executed without the
+   *                 profiler (the sampled simulation) or the last one took
+   *                 a trap to Pc.
+   */
+  void skipTo(uint64_t Pc) { PrevPc = Pc; }
+
+  uint64_t getSamples() const { return Samples; }
+  const std::unordered_map<uint64_t, uint64_t> &getPcCounts() const {
+    return PcCounts;
+  }
+
+  /**
+   * @brief report - the hottest MaxLines PCs and, when Symbols are not
+   *                 empty, the hottest functions, sorted by samples.
+   */
+  void report(std::ostream &Stream, const SymbolTable &Symbols,
+              size_t MaxLines = 50) const;
+};
+
+} // namespace rvdash
+
+#endif // HOT_SPOT_PROFILER_H
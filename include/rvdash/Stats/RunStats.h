@@ -0,0 +1,100 @@
+#ifndef RUN_STATS_H
+#define RUN_STATS_H
+
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Memory/Cache.h"
+
+namespace rvdash {
+
+//-----------------------------------InstrMixCounter-------------------------------------
+
+/**
+ * @brief class InstrMixCounter - number of executions of every instruction.
+ *                                Instructions are identified by their
+ *                                execute handler (FuncT), the names are
+ *                                looked up only for the report.
+ */
+template <typename FuncT> class InstrMixCounter {
+  std::unordered_map<FuncT, uint64_t> Counts;
+
+public:
+  void count(FuncT Func) { ++Counts[Func]; }
+  const std::unordered_map<FuncT, uint64_t> &getCounts() const {
+    return Counts;
+  }
+};
+
+//--------------------------------------RunStats-----------------------------------------
+
+/**
+ * @brief class RunStats - report of one run (--stats): retired instructions,
+ *                         wall and CPU time, MIPS, instruction mix, pages
+ *                         of memory touched and cache hit rates. The
+ *                         clocks are started by the constructor and
+ *                         stopped by finish. The instruction counts and the
+ *                         mix are for the observed instructions (the
+ *                         detailed windows of the sampled simulation), MIPS
+ *                         is for all simulated ones.
+ */
+class RunStats {
+  std::chrono::steady_clock::time_point WallStart;
+  std::clock_t CpuStart;
+
+  double WallTime = 0 /* seconds */;
+  double CpuTime = 0 /* seconds */;
+  uint64_t InstrRet = 0;
+  uint64_t Simulated = 0;
+  bool Sampled = false;
+  uint64_t PagesTouched = 0;
+  uint64_t PageSz = 0 /* bytes */;
+  // Sorted by finish by the number of executions, from the most frequent,
+  // then by the mnemonic
+  std::vector<std::pair<std::string, uint64_t>> Mix;
+
+  struct CacheStats {
+    std::string Name;
+    uint64_t Accesses;
+    uint64_t Misses;
+    uint64_t Writebacks;
+  };
+  std::vector<CacheStats> Caches;
+
+public:
+  RunStats();
+
+  /**
+   * @brief finish - it stops the clocks and remembers the counters of the
+   *                 finished run: Instret instructions were observed out
+   *                 of SimulatedInstrs, IsSampled tells that the run was
+   *                 sampled (--sample). The instruction mix is added
+   *                 before it.
+   */
+  void finish(uint64_t Instret, uint64_t SimulatedInstrs, uint64_t Pages,
+              uint64_t PageBytes, bool IsSampled);
+
+  /**
+   * @brief addInstr - it adds Count executions of the Mnemonic instruction.
+   */
+  void addInstr(const std::string &Mnemonic, uint64_t Count);
+
+  /**
+   * @brief addCache - it adds the counters of the cache model to the report.
+   */
+  void addCache(const std::string &Name, const CacheModel &Cache);
+
+  double getMIPS() const;
+
+  void printText(std::ostream &Stream) const;
+  void printJSON(std::ostream &Stream) const;
+};
+
+} // namespace rvdash
+
+#endif // RUN_STATS_H
@@ -0,0 +1,97 @@
+#ifndef TIMING_MODEL_H
+#define TIMING_MODEL_H
+
+#include "rvdash/Elf/SymbolTable.h"
+
+#include <array>
+#include <cstdint>
+#include <iostream>
+#include <optional>
+#include <unordered_map>
+
+namespace rvdash {
+
+//------------------------------------TimingConfig---------------------------------------
+
+/**
+ * @brief struct TimingConfig - latencies of the timing model in cycles.
+ *                              A latency is the distance from the issue of
+ *                              the instruction to the issue of a dependent
+ *                              one (1 means full forwarding, no stall).
+ */
+struct TimingConfig {
+  unsigned LoadLatency = 2;
+  unsigned MulLatency = 3;
+  unsigned DivLatency = 20;
+  // Cycles lost on a taken (or, with branch predictors, mispredicted)
+  // transfer, it is resolved in EX
+  unsigned BranchPenalty = 2;
+  // Added for every line missed in the cache models
+  unsigned MissPenalty = 20;
+};
+
+//------------------------------------TimingModel----------------------------------------
+
+/**
+ * @brief class TimingModel - classic 5-stage in-order pipeline (IF, ID, EX,
+ *                            MEM, WB) with full forwarding, modelled with a
+ *                            register scoreboard. It estimates the cycles
+ *                            from the encodings of the executed
+ *                            instructions: load-use and mul/div hazards,
+ *                            branch penalties and, if there are cache or
+ *                            branch models, their misses. afterStep is
+ *                            called from the AfterStep hook.
+ */
+class TimingModel {
+  TimingConfig Config;
+  // Cycle in which the last instruction entered EX
+  uint64_t Cycle = 0;
+  // Cycle from which the register value can be forwarded
+  std::array<uint64_t, 32> Ready{};
+  std::array<bool, 32> FromLoad{};
+  uint64_t Instrs = 0;
+  uint64_t PrevPc;
+  // Instructions and cycles by PC, only for the report by functions
+  bool ByPc;
+  std::unordered_map<uint64_t, std::pair<uint64_t, uint64_t>> PcCycles;
+
+public:
+  uint64_t LoadUseStalls = 0;
+  uint64_t MulDivStalls = 0;
+  uint64_t BranchStalls = 0;
+  uint64_t ICacheStalls = 0;
+  uint64_t DCacheStalls = 0;
+
+  TimingModel(const TimingConfig &Cfg, uint64_t StartPc, bool CountByPc)
+      : Config(Cfg), PrevPc(StartPc), ByPc(CountByPc) {}
+
+  /**
+   * @brief afterStep - Instr is the executed instruction, NextPc the PC of
+   *                    the next one. IMisses and DMisses are the lines missed
+   *                    by the instruction in the cache models, Mispredicted
+   *                    is the verdict of the branch model (without it every
+   *                    taken transfer pays the penalty).
+   */
+  void afterStep(uint32_t Instr, uint64_t NextPc, unsigned IMisses,
+                 unsigned DMisses, std::optional<bool> Mispredicted);
+
+  /**
+   * @brief skipTo - the instructions up to Pc were executed without the
+   *                 timing model (the sampled simulation) or the last one
+   *                 took a trap to Pc.
+   */
+  void skipTo(uint64_t Pc) { PrevPc = Pc; }
+
+  /**
+   * @brief getCycles - estimated cycles of the run, including the filling
+   *                    of the pipeline.
+   */
+  uint64_t getCycles() const { return Instrs == 0 ? 0 : Cycle + 4; }
+
+  void report(std::ostream &Stream, const SymbolTable &Symbols,
+              size_t MaxLines = 20) const;
+};
+
+} // namespace rvdash
+
+#endif // TIMING_MODEL_H
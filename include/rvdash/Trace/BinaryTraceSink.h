@@ -0,0 +1,108 @@
+#ifndef BINARY_TRACE_SINK_H
+#define BINARY_TRACE_SINK_H
+
+#include "rvdash/Trace/RingBuffer.h"
+#include "rvdash/Trace/TraceRecord.h"
+#include "rvdash/Trace/TraceSink.h"
+
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+namespace rvdash {
+
+//---------------------------------BinaryTraceSink---------------------------------------
+
+/**
+ * @brief class BinaryTraceSink - collects one TraceRecord per instruction and
+ *                                pushes it into a SPSC ring buffer. A
+ *                                background writer thread drains the buffer
+ *                                into the trace file, so the simulation thread
+ *                                never formats or writes anything itself.
+ *                                The file is rendered by rvdash-trace.
+ */
+class BinaryTraceSink : public TraceSink {
+  static constexpr size_t BufferCapacity = 1 << 16;
+
+  RingBuffer<TraceRecord, BufferCapacity> Buffer;
+  TraceRecord Current;
+  bool InInstr = false;
+
+  std::FILE *File;
+  std::atomic<bool> Done = false;
+  std::thread Writer;
+
+  void writeLoop();
+  void push(const TraceRecord &Record) { Buffer.push(Record); }
+
+public:
+  BinaryTraceSink(const std::string &Path);
+  ~BinaryTraceSink();
+
+  void beginSimulation() override;
+  void endSimulation() override;
+
+  void beginInstr(uint64_t Pc, uint32_t Instr) override {
+    // A not finished instruction (it failed) is still stored
+    if (InInstr)
+      push(Current);
+    Current = TraceRecord{};
+    Current.Pc = Pc;
+    Current.Instr = Instr;
+    InInstr = true;
+  }
+
+  void endInstr() override {
+    push(Current);
+    InInstr = false;
+  }
+
+  void regWrite(unsigned RegIdx, uint64_t Value) override {
+    Current.Flags |= TraceRecord::RegWrite;
+    Current.Rd = RegIdx;
+    Current.RdValue = Value;
+  }
+
+  void pcWrite(uint64_t Value) override {
+    Current.Flags |= TraceRecord::PcWrite;
+    Current.PcValue = Value;
+  }
+
+  void memRead(uint64_t Addr, unsigned Size, uint64_t Value) override {
+    Current.Flags |= TraceRecord::MemRead;
+    Current.MemAddr = Addr;
+    Current.MemSize = Size;
+    Current.MemValue = Value;
+  }
+
+  void memWrite(uint64_t Addr, unsigned Size, uint64_t Value) override {
+    Current.Flags |= TraceRecord::MemWrite;
+    Current.MemAddr = Addr;
+    Current.MemSize = Size;
+    Current.MemValue = Value;
+  }
+
+  void syscall(uint64_t SysNum, uint64_t Arg0, uint64_t Arg1,
+               uint64_t Arg2) override {
+    Current.Flags |= TraceRecord::Syscall;
+  }
+
+  void trap(TrapCause Cause, uint64_t Tval) override {
+    Current.Flags |= TraceRecord::Trap;
+    Current.Rd = static_cast<uint8_t>(Cause);
+    Current.MemValue = Tval;
+  }
+
+  void csrWrite(unsigned Csr, uint64_t Value) override {
+    Current.Flags |= TraceRecord::CSRWrite;
+    Current.MemAddr = Csr;
+    Current.MemValue = Value;
+  }
+
+  void flush() override;
+};
+
+} // namespace rvdash
+
+#endif // BINARY_TRACE_SINK_H
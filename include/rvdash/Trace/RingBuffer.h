@@ -0,0 +1,72 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+
+namespace rvdash {
+
+//-----------------------------------RingBuffer------------------------------------------
+
+/**
+ * @brief class RingBuffer - lock-free single producer single consumer queue.
+ *                           Capacity must be a power of two. The producer
+ *                           (simulation thread) only moves Tail, the consumer
+ *                           (writer thread) only moves Head, so one acquire
+ *                           load and one release store are enough per call.
+ */
+template <typename T, size_t Capacity> class RingBuffer {
+  static_assert((Capacity & (Capacity - 1)) == 0,
+                "RingBuffer capacity must be a power of two");
+
+  static constexpr size_t CacheLineSz = 64;
+
+  alignas(CacheLineSz) std::atomic<size_t> Head = 0;
+  alignas(CacheLineSz) std::atomic<size_t> Tail = 0;
+  alignas(CacheLineSz) std::array<T, Capacity> Elems;
+
+public:
+  /**
+   * @brief push - add an element, waiting for the consumer if the buffer is
+   *               full (back pressure instead of dropping records).
+   */
+  void push(const T &Elem) {
+    auto CurrTail = Tail.load(std::memory_order_relaxed);
+    while (CurrTail - Head.load(std::memory_order_acquire) == Capacity)
+      std::this_thread::yield();
+    Elems[CurrTail & (Capacity - 1)] = Elem;
+    Tail.store(CurrTail + 1, std::memory_order_release);
+  }
+
+  /**
+   * @brief drain - pass all currently available elements to Consume as
+   *                contiguous chunks (pointer, count) and release them.
+   *                Returns the number of consumed elements.
+   */
+  template <typename ConsumerType> size_t drain(ConsumerType Consume) {
+    auto CurrHead = Head.load(std::memory_order_relaxed);
+    auto CurrTail = Tail.load(std::memory_order_acquire);
+    auto Count = CurrTail - CurrHead;
+    if (Count == 0)
+      return 0;
+    auto First = CurrHead & (Capacity - 1);
+    auto FirstChunk = std::min(Count, Capacity - First);
+    Consume(&Elems[First], FirstChunk);
+    if (FirstChunk != Count)
+      Consume(&Elems[0], Count - FirstChunk);
+    Head.store(CurrTail, std::memory_order_release);
+    return Count;
+  }
+
+  bool empty() const {
+    return Head.load(std::memory_order_acquire) ==
+           Tail.load(std::memory_order_acquire);
+  }
+};
+
+} // namespace rvdash
+
+#endif // RING_BUFFER_H
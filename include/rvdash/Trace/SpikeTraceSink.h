@@ -0,0 +1,108 @@
+#ifndef SPIKE_TRACE_SINK_H
+#define SPIKE_TRACE_SINK_H
+
+#include "rvdash/Trace/TraceFormat.h"
+#include "rvdash/Trace/TraceSink.h"
+
+#include <iostream>
+#include <memory>
+
+namespace rvdash {
+
+//---------------------------------SpikeTraceSink----------------------------------------
+
+/**
+ * @brief class SpikeTraceSink - writes the commit log in the format of
+ *                               Spike --log-commits, so both logs can be
+ *                               compared line by line:
+ *
+ *          core   0: 3 0x00000008 (0x00a00093) x1  0x0000000a
+ *          core   0: 3 0x0000000c (0x0000a103) x2  0x00000005 mem 0x0000000a
+ *          core   0: 3 0x00000010 (0x0020a223) mem 0x0000000e 0x00000005
+ *          core   0: 3 0x00000014 (0x30529073) c773_mtvec 0x00000020
+ *          core   0: exception illegal_instruction, epc 0x00000018
+ *          core   0:           tval 0xffffffff
+ *
+ *                               Writes to x0 are not printed (as in Spike).
+ *                               An instruction that takes a trap has no
+ *                               commit line, the exception lines are
+ *                               printed instead. Load addresses need the
+ *                               full trace level.
+ */
+class SpikeTraceSink : public TraceSink {
+  static constexpr size_t BufferSz = 1 << 16;
+  // The model is always in machine mode
+  static constexpr unsigned PrivLevel = 3;
+
+  std::ostream &LogFile;
+  std::unique_ptr<char[]> Buffer;
+  char *Pos;
+  unsigned XLenDigits;
+
+  // Parts of the current instruction, printed by endInstr
+  uint64_t Pc;
+  uint32_t Instr;
+  bool HasRegWrite, HasMemRead, HasMemWrite, HasCSRWrite, HasTrap;
+  unsigned Rd, MemSize, Csr;
+  uint64_t RdValue, ReadAddr, WriteAddr, WriteValue, CsrValue, Tval;
+  TrapCause Cause;
+
+  void writeBuffer();
+  char *putTrap(char *Out) const;
+
+public:
+  SpikeTraceSink(std::ostream &Stream, unsigned XLen = 32)
+      : LogFile(Stream), Buffer(std::make_unique<char[]>(BufferSz)),
+        Pos(Buffer.get()), XLenDigits(XLen / 4) {}
+  ~SpikeTraceSink() { flush(); }
+
+  void beginSimulation() override {}
+  void endSimulation() override { flush(); }
+
+  void beginInstr(uint64_t NewPc, uint32_t NewInstr) override {
+    Pc = NewPc;
+    Instr = NewInstr;
+    HasRegWrite = HasMemRead = HasMemWrite = HasCSRWrite = HasTrap = false;
+  }
+  void endInstr() override;
+
+  void regWrite(unsigned RegIdx, uint64_t Value) override {
+    if (RegIdx == 0)
+      return;
+    HasRegWrite = true;
+    Rd = RegIdx;
+    RdValue = Value;
+  }
+  void pcWrite(uint64_t Value) override {}
+  void memRead(uint64_t Addr, unsigned Size, uint64_t Value) override {
+    HasMemRead = true;
+    ReadAddr = Addr;
+  }
+  void memWrite(uint64_t Addr, unsigned Size, uint64_t Value) override {
+    HasMemWrite = true;
+    WriteAddr = Addr;
+    WriteValue = Value;
+    MemSize = Size;
+  }
+  void syscall(uint64_t SysNum, uint64_t Arg0, uint64_t Arg1,
+               uint64_t Arg2) override {}
+  void trap(TrapCause NewCause, uint64_t NewTval) override {
+    HasTrap = true;
+    Cause = NewCause;
+    Tval = NewTval;
+  }
+  void csrWrite(unsigned NewCsr, uint64_t Value) override {
+    HasCSRWrite = true;
+    Csr = NewCsr;
+    CsrValue = Value;
+  }
+
+  void flush() override {
+    writeBuffer();
+    LogFile.flush();
+  }
+};
+
+} // namespace rvdash
+
+#endif // SPIKE_TRACE_SINK_H
@@ -0,0 +1,68 @@
+#ifndef TEXT_TRACE_SINK_H
+#define TEXT_TRACE_SINK_H
+
+#include "rvdash/Trace/TraceFormat.h"
+#include "rvdash/Trace/TraceSink.h"
+
+#include <iostream>
+#include <memory>
+
+namespace rvdash {
+
+//----------------------------------TextTraceSink----------------------------------------
+
+/**
+ * @brief class TextTraceSink - writes the human readable trace
+ *                              (disassembly and "X1 <- 0x.." lines) into
+ *                              a stream. This is the format checked by
+ *                              the FileCheck answers in Test. Lines are
+ *                              formatted with std::to_chars into a buffer
+ *                              that goes to the stream in large blocks, the
+ *                              stream itself is never reformatted.
+ */
+class TextTraceSink : public TraceSink {
+  static constexpr size_t BufferSz = 1 << 16;
+
+  std::ostream &LogFile;
+  std::unique_ptr<char[]> Buffer;
+  char *Pos;
+
+  /**
+   * @brief reserve - it returns the place for the next line, the buffer is
+   *                  written out when the line may not fit.
+   */
+  char *reserve() {
+    if (Pos + TraceFormat::MaxLineSz > Buffer.get() + BufferSz)
+      writeBuffer();
+    return Pos;
+  }
+  void writeBuffer();
+
+public:
+  TextTraceSink(std::ostream &Stream = std::cout)
+      : LogFile(Stream), Buffer(std::make_unique<char[]>(BufferSz)),
+        Pos(Buffer.get()) {}
+  ~TextTraceSink() { flush(); }
+
+  void beginSimulation() override;
+  void endSimulation() override;
+
+  void beginInstr(uint64_t Pc, uint32_t Instr) override;
+  void endInstr() override {}
+
+  void regWrite(unsigned RegIdx, uint64_t Value) override;
+  void pcWrite(uint64_t Value) override;
+  void memRead(uint64_t Addr, unsigned Size, uint64_t Value) override;
+  void memWrite(uint64_t Addr, unsigned Size, uint64_t Value) override;
+  void syscall(uint64_t SysNum, uint64_t Arg0, uint64_t Arg1,
+               uint64_t Arg2) override;
+
+  void flush() override {
+    writeBuffer();
+    LogFile.flush();
+  }
+};
+
+} // namespace rvdash
+
+#endif // TEXT_TRACE_SINK_H
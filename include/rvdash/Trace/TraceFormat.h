@@ -0,0 +1,71 @@
+#ifndef TRACE_FORMAT_H
+#define TRACE_FORMAT_H
+
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+
+namespace rvdash {
+namespace TraceFormat {
+
+//-----------------------------------TraceFormat-----------------------------------------
+
+/**
+ * @brief putStr, putHex, putDec, putXReg - append a piece of a trace line to
+ *                                          Out and return the new end. The
+ *                                          caller guarantees enough space
+ *                                          (a trace line is much shorter
+ *                                          than MaxLineSz).
+ */
+constexpr size_t MaxLineSz = 256;
+
+template <size_t N> inline char *putStr(char *Out, const char (&Str)[N]) {
+  std::memcpy(Out, Str, N - 1);
+  return Out + N - 1;
+}
+
+inline char *putStr(char *Out, const char *Str, size_t Len) {
+  std::memcpy(Out, Str, Len);
+  return Out + Len;
+}
+
+inline char *putHex(char *Out, uint64_t Value) {
+  return std::to_chars(Out, Out + 16, Value, /* base */ 16).ptr;
+}
+
+/**
+ * @brief putHexPadded - hex with leading zeros up to Digits (at most 16).
+ */
+inline char *putHexPadded(char *Out, uint64_t Value, unsigned Digits) {
+  static constexpr char HexDigits[] = "0123456789abcdef";
+  for (unsigned Idx = Digits; Idx > 0; --Idx, Value >>= 4)
+    Out[Idx - 1] = HexDigits[Value & 0xf];
+  return Out + Digits;
+}
+
+inline char *putDec(char *Out, uint64_t Value) {
+  return std::to_chars(Out, Out + 20, Value).ptr;
+}
+
+struct RegName {
+  char Str[4];
+  uint8_t Len;
+};
+
+constexpr RegName XRegNames[] = {
+    {"X0", 2},  {"X1", 2},  {"X2", 2},  {"X3", 2},  {"X4", 2},  {"X5", 2},
+    {"X6", 2},  {"X7", 2},  {"X8", 2},  {"X9", 2},  {"X10", 3}, {"X11", 3},
+    {"X12", 3}, {"X13", 3}, {"X14", 3}, {"X15", 3}, {"X16", 3}, {"X17", 3},
+    {"X18", 3}, {"X19", 3}, {"X20", 3}, {"X21", 3}, {"X22", 3}, {"X23", 3},
+    {"X24", 3}, {"X25", 3}, {"X26", 3}, {"X27", 3}, {"X28", 3}, {"X29", 3},
+    {"X30", 3}, {"X31", 3}};
+
+inline char *putXReg(char *Out, unsigned RegIdx) {
+  const auto &Name = XRegNames[RegIdx & 0x1f];
+  return putStr(Out, Name.Str, Name.Len);
+}
+
+} // namespace TraceFormat
+} // namespace rvdash
+
+#endif // TRACE_FORMAT_H
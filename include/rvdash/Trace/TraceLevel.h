@@ -0,0 +1,37 @@
+#ifndef TRACE_LEVEL_H
+#define TRACE_LEVEL_H
+
+#include <optional>
+#include <string>
+
+namespace rvdash {
+
+//-----------------------------------TraceLevel------------------------------------------
+
+/**
+ * @brief enum TraceLevel - how much of the execution is reported to the
+ *                          TraceSink. It is a template parameter of InstrSet,
+ *                          so with None no tracing code is instantiated at
+ *                          all.
+ *
+ *                          None   - nothing is reported.
+ *                          Commit - instructions and the architectural state
+ *                                   they change (registers, pc, stores,
+ *                                   syscalls).
+ *                          Full   - Commit plus memory reads.
+ */
+enum class TraceLevel { None, Commit, Full };
+
+inline std::optional<TraceLevel> parseTraceLevel(const std::string &Name) {
+  if (Name == "none")
+    return TraceLevel::None;
+  if (Name == "commit")
+    return TraceLevel::Commit;
+  if (Name == "full")
+    return TraceLevel::Full;
+  return std::nullopt;
+}
+
+} // namespace rvdash
+
+#endif // TRACE_LEVEL_H
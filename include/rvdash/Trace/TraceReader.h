@@ -0,0 +1,22 @@
+#ifndef TRACE_READER_H
+#define TRACE_READER_H
+
+#include "rvdash/Trace/TraceSink.h"
+
+#include <string>
+
+namespace rvdash {
+
+//-----------------------------------TraceReader-----------------------------------------
+
+/**
+ * @brief replayTrace - read the binary trace file written by BinaryTraceSink
+ *                      and replay its records as events into Sink (for
+ *                      example TextTraceSink to get the usual text trace).
+ *                      Returns the number of replayed instructions.
+ */
+unsigned long long replayTrace(const std::string &Path, TraceSink &Sink);
+
+} // namespace rvdash
+
+#endif // TRACE_READER_H
@@ -0,0 +1,65 @@
+#ifndef TRACE_RECORD_H
+#define TRACE_RECORD_H
+
+#include <cstdint>
+
+namespace rvdash {
+
+//-----------------------------------TraceRecord-----------------------------------------
+
+/**
+ * @brief struct TraceRecord - one executed instruction in the binary trace.
+ *                             It keeps only raw data (PC, instruction word and
+ *                             its effects), the text is rendered offline by
+ *                             rvdash-trace. Syscall arguments are not stored,
+ *                             the renderer takes them from its shadow copy
+ *                             of the X registers. An instruction with a trap
+ *                             or a CSR write has no memory access, so
+ *                             MemAddr and MemValue keep the trap (Rd is the
+ *                             cause, MemValue is tval) or the CSR (MemAddr
+ *                             is the address, MemValue is the value).
+ */
+struct TraceRecord {
+  enum Flag : uint16_t {
+    RegWrite = 1 << 0,
+    PcWrite = 1 << 1,
+    MemRead = 1 << 2,
+    MemWrite = 1 << 3,
+    Syscall = 1 << 4,
+    SimulationBegin = 1 << 5,
+    SimulationEnd = 1 << 6,
+    Trap = 1 << 7,
+    CSRWrite = 1 << 8,
+  };
+
+  uint64_t Pc = 0;
+  uint64_t RdValue = 0;
+  uint64_t PcValue = 0;
+  uint64_t MemAddr = 0;
+  uint64_t MemValue = 0;
+  uint32_t Instr = 0;
+  uint16_t Flags = 0;
+  uint8_t Rd = 0;
+  uint8_t MemSize = 0;
+};
+
+static_assert(sizeof(TraceRecord) == 48, "TraceRecord layout is a file format");
+
+//--------------------------------TraceFileHeader----------------------------------------
+
+/**
+ * @brief struct TraceFileHeader - header of the binary trace file, the records
+ *                                 follow it up to the end of the file.
+ */
+struct TraceFileHeader {
+  static constexpr char ExpectedMagic[4] = {'R', 'V', 'D', 'T'};
+  static constexpr uint16_t CurrentVersion = 2;
+
+  char Magic[4] = {'R', 'V', 'D', 'T'};
+  uint16_t Version = CurrentVersion;
+  uint16_t RecordSz = sizeof(TraceRecord);
+};
+
+} // namespace rvdash
+
+#endif // TRACE_RECORD_H
@@ -0,0 +1,48 @@
+#ifndef TRACE_SINK_H
+#define TRACE_SINK_H
+
+#include "rvdash/InstructionSet/Trap.h"
+
+#include <cstdint>
+
+namespace rvdash {
+
+//------------------------------------TraceSink------------------------------------------
+
+/**
+ * @brief class TraceSink - receiver of the execution trace. Instruction
+ *                          handlers do not format anything themselves, they
+ *                          report what happened (register and memory writes,
+ *                          syscalls) and the sink decides how to store it.
+ *                          Every instruction is wrapped in
+ *                          beginInstr()/endInstr().
+ */
+class TraceSink {
+public:
+  virtual ~TraceSink() {}
+
+  virtual void beginSimulation() = 0;
+  virtual void endSimulation() = 0;
+
+  virtual void beginInstr(uint64_t Pc, uint32_t Instr) = 0;
+  virtual void endInstr() = 0;
+
+  virtual void regWrite(unsigned RegIdx, uint64_t Value) = 0;
+  virtual void pcWrite(uint64_t Value) = 0;
+  virtual void memRead(uint64_t Addr, unsigned Size, uint64_t Value) = 0;
+  virtual void memWrite(uint64_t Addr, unsigned Size, uint64_t Value) = 0;
+  virtual void syscall(uint64_t SysNum, uint64_t Arg0, uint64_t Arg1,
+                       uint64_t Arg2) = 0;
+
+  // The trap of the current instruction (it does not retire) and the CSR
+  // writes of the CSR instructions and mret. Only the sinks of the formats
+  // that print them override these.
+  virtual void trap(TrapCause Cause, uint64_t Tval) {}
+  virtual void csrWrite(unsigned Csr, uint64_t Value) {}
+
+  virtual void flush() {}
+};
+
+} // namespace rvdash
+
+#endif // TRACE_SINK_H
@@ -1,11 +1,14 @@
 #include "Memory/Memory.h"
 #include "SnippyRVdash/RVM.h"
+#include "SnippyRVdash/RVMExt.h"
 #include "rvdash/CPU.h"
 #include "rvdash/InstructionSet/InstructionSet.h"
+#include "rvdash/Trace/TextTraceSink.h"
 
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <vector>
 
 #ifdef __cplusplus
 extern "C" {
@@ -13,6 +16,100 @@ extern "C" {
 
 using namespace rvdash;
 
+//--------------------------------UpdateCallbacks----------------------------------------
+
+/**
+ * @brief class UpdateCallbacks - the trace sink that reports the changes of
+ *                                the state to snippy through the callbacks of
+ *                                RVMConfig, the trace itself goes on to Next.
+ *                                The writes are collected during the
+ *                                instruction and reported by commit after it:
+ *                                one callback per written register and per
+ *                                store (not per byte), then the new PC.
+ */
+class UpdateCallbacks : public TraceSink {
+  struct StoreUpdate {
+    uint64_t Addr;
+    unsigned Size;
+    uint64_t Value;
+  };
+
+  TraceSink &Next;
+  RVMCallbackHandler *Handler = nullptr;
+  MemUpdateCallbackTy MemUpdate = nullptr;
+  XRegUpdateCallbackTy XRegUpdate = nullptr;
+  PCUpdateCallbackTy PCUpdate = nullptr;
+
+  std::vector<std::pair<unsigned, uint64_t>> XRegWrites;
+  std::vector<StoreUpdate> Stores;
+
+public:
+  UpdateCallbacks(TraceSink &NextSink) : Next(NextSink) {}
+
+  void setCallbacks(const RVMConfig &Config) {
+    Handler = Config.CallbackHandler;
+    MemUpdate = Config.MemUpdateCallback;
+    XRegUpdate = Config.XRegUpdateCallback;
+    PCUpdate = Config.PCUpdateCallback;
+  }
+
+  void beginSimulation() override { Next.beginSimulation(); }
+  void endSimulation() override { Next.endSimulation(); }
+
+  void beginInstr(uint64_t Pc, uint32_t Instr) override {
+    Next.beginInstr(Pc, Instr);
+  }
+  void endInstr() override { Next.endInstr(); }
+
+  void regWrite(unsigned RegIdx, uint64_t Value) override {
+    // Writes to X0 do not change anything
+    if (XRegUpdate != nullptr && RegIdx != 0)
+      XRegWrites.emplace_back(RegIdx, Value);
+    Next.regWrite(RegIdx, Value);
+  }
+  void pcWrite(uint64_t Value) override { Next.pcWrite(Value); }
+  void memRead(uint64_t Addr, unsigned Size, uint64_t Value) override {
+    Next.memRead(Addr, Size, Value);
+  }
+  void memWrite(uint64_t Addr, unsigned Size, uint64_t Value) override {
+    if (MemUpdate != nullptr)
+      Stores.push_back({Addr, Size, Value});
+    Next.memWrite(Addr, Size, Value);
+  }
+  void syscall(uint64_t SysNum, uint64_t Arg0, uint64_t Arg1,
+               uint64_t Arg2) override {
+    Next.syscall(SysNum, Arg0, Arg1, Arg2);
+  }
+  void trap(TrapCause Cause, uint64_t Tval) override {
+    Next.trap(Cause, Tval);
+  }
+  void csrWrite(unsigned Csr, uint64_t Value) override {
+    Next.csrWrite(Csr, Value);
+  }
+
+  void flush() override { Next.flush(); }
+
+  /**
+   * @brief commit - it calls the callbacks for the executed instruction,
+   *                 Pc is the address of the next one. The stored bytes are
+   *                 given in the memory order (little-endian).
+   */
+  void commit(uint64_t Pc) {
+    for (auto [RegIdx, Value] : XRegWrites)
+      XRegUpdate(Handler, static_cast<RVMXReg>(RegIdx), Value);
+    XRegWrites.clear();
+    for (auto &Store : Stores) {
+      char Data[sizeof(uint64_t)];
+      for (unsigned Idx = 0; Idx < Store.Size; ++Idx)
+        Data[Idx] = Store.Value >> (Idx * CHAR_BIT);
+      MemUpdate(Handler, Store.Addr, Data, Store.Size);
+    }
+    Stores.clear();
+    if (PCUpdate != nullptr)
+      PCUpdate(Handler, Pc);
+  }
+};
+
 //---------------------------------SnippyRVdash------------------------------------------
 
 /**
@@ -26,27 +123,108 @@ class SnippyRVdash {
   std::optional<std::ofstream> LogFile;
 
   Memory<32> Mem;
-  CPU<decltype(Mem), InstrSet<decltype(Mem), RV32I::RV32IInstrSet>> Cpu;
+  TextTraceSink Text;
+  UpdateCallbacks Callbacks;
+  CPU<decltype(Mem),
+      InstrSet<decltype(Mem), TraceLevel::Full, RV32I::RV32IInstrSet,
+               Zicsr::ZicsrInstrSet, Machine::MachineInstrSet>>
+      Cpu;
+  // The same hart without the trace and the callbacks, for executeBatch
+  CPU<decltype(Mem),
+      InstrSet<decltype(Mem), TraceLevel::None, RV32I::RV32IInstrSet,
+               Zicsr::ZicsrInstrSet, Machine::MachineInstrSet>>
+      Fast;
+
+  // The complete line is written, the model is not used until start
+  bool Finished = false;
+
+  std::ostream &getLog() {
+    return LogFile.has_value() ? LogFile.value() : std::cout;
+  }
+
+  void start() {
+    getLog() << "====================rvdash start====================\n";
+    Finished = false;
+  }
+
+  /**
+   * @brief clear - the state after the construction: empty memory, zero
+   *                registers and PC, instret 0. It costs the pages that
+   *                were touched, the decoders and the trace are kept.
+   */
+  void clear() {
+    Mem.reset();
+    Cpu.reset();
+  }
 
 public:
   SnippyRVdash(const char *LogFilePath, unsigned long long RamSt,
                unsigned long long RamSz)
-      : LogFile(LogFilePath), Mem(RamSt, RamSz), Cpu(Mem, LogFile.value()) {
+      : LogFile(LogFilePath), Mem(RamSt, RamSz), Text(LogFile.value()),
+        Callbacks(Text), Cpu(Mem, Callbacks, LogFile.value()),
+        Fast(Mem, Callbacks, SharedHart{}) {
     if (!LogFile.value().is_open())
       failWithError("Can't open log file " + std::string(LogFilePath));
-    LogFile.value() << "====================rvdash start====================\n";
+    start();
   }
   SnippyRVdash(unsigned long long RamSt, unsigned long long RamSz)
-      : Mem(RamSt, RamSz), Cpu(Mem) {
-    std::cout << "====================rvdash start====================\n";
+      : Mem(RamSt, RamSz), Text(std::cout), Callbacks(Text),
+        Cpu(Mem, Callbacks), Fast(Mem, Callbacks, SharedHart{}) {
+    start();
   }
   ~SnippyRVdash() {
-    if (LogFile.has_value()) {
-      LogFile.value()
-          << "===================rvdash complete==================\n";
+    finish();
+    if (LogFile.has_value())
+      LogFile.value().close();
+  }
+
+  /**
+   * @brief finish - the end of the simulation in the log, it is written
+   *                 once.
+   */
+  void finish() {
+    if (Finished)
+      return;
+    Cpu.flushTrace();
+    getLog() << "===================rvdash complete==================\n";
+    getLog().flush();
+    Finished = true;
+  }
+
+  /**
+   * @brief reset - the model is finished and started again in the state
+   *                after the construction, the log goes on.
+   */
+  void reset() {
+    finish();
+    clear();
+    start();
+  }
+
+  /**
+   * @brief canReuse - the model can be given to rvm_modelCreate with these
+   *                   parameters: the same RAM and the same kind of the log
+   *                   (a file or the standard output).
+   */
+  bool canReuse(const char *LogFilePath, unsigned long long RamSt,
+                unsigned long long RamSz) const {
+    return Mem.getRamStart() == RamSt && Mem.getRamSize() == RamSz &&
+           LogFile.has_value() == (LogFilePath != nullptr);
+  }
+
+  /**
+   * @brief reuse - the finished model starts again as a new one, the log file
+   *                is opened again at LogFilePath.
+   */
+  void reuse(const char *LogFilePath) {
+    clear();
+    if (LogFilePath != nullptr) {
       LogFile.value().close();
-    } else
-      std::cout << "===================rvdash complete==================\n";
+      LogFile.value().open(LogFilePath);
+      if (!LogFile.value().is_open())
+        failWithError("Can't open log file " + std::string(LogFilePath));
+    }
+    start();
   }
 
   void storeByte(uint64_t Addr, const Register<CHAR_BIT> &Byte) {
@@ -63,13 +241,85 @@ public:
     return Cpu.setXReg(static_cast<unsigned>(Reg), NewValue);
   }
 
+  void readXRegSnapshot(RVMXRegSnapshot &Snapshot) const {
+    static_assert(sizeof(RVMRegT) == sizeof(uint64_t));
+    Cpu.readXRegs(Snapshot.XRegs);
+    Snapshot.PC = readPC();
+  }
+
+  std::optional<uint64_t> readCSR(unsigned Csr) const {
+    return Cpu.readCSR(Csr);
+  }
+
+  void writeCSR(unsigned Csr, uint64_t Value) { Cpu.writeCSR(Csr, Value); }
+
   void dumpMem() const {
     std::ofstream File("Mem.dump");
     Mem.dump(File);
   }
 
-  void step() { Cpu.step(); }
-  void increasePC() const { Cpu.increasePC(); }
+  void setCallbacks(const RVMConfig &Config) { Callbacks.setCallbacks(Config); }
+
+  /**
+   * @brief logTrap - the trap without a handler (mtvec) goes to the log, false
+   *                  if there is no trap. After it the model is resumed and
+   *                  goes on from the same PC.
+   */
+  bool logTrap(const std::optional<TrapInfo> &Trap) {
+    if (!Trap.has_value())
+      return false;
+    Cpu.flushTrace();
+    getLog() << describeTrap(Trap.value()) << "\n";
+    return true;
+  }
+
+  /**
+   * @brief step - it executes one instruction and moves to the next one, the
+   *               changes are reported to the callbacks. It returns false if
+   *               the instruction took a trap without a handler.
+   */
+  bool step() {
+    Cpu.step();
+    Cpu.increasePC();
+    Callbacks.commit(readPC());
+    if (!logTrap(Cpu.getUnhandledTrap()))
+      return true;
+    Cpu.resume();
+    return false;
+  }
+  /**
+   * @brief executeBatch - up to MaxCount retired instructions on Fast,
+   *                       without the trace and the callbacks, the traps
+   *                       taken to mtvec are not counted. It stops before the
+   *                       instruction at StopPc or when the program is
+   *                       finished. An instruction that takes a trap
+   *                       without a handler (mtvec) is not retired, the
+   *                       trap is written to the log. The errors of the
+   *                       simulator are not traps, they are thrown as in
+   *                       step.
+   */
+  RVMStopReason executeBatch(uint64_t MaxCount, uint64_t StopPc,
+                             uint64_t &Retired) {
+    Retired = 0;
+    if (Cpu.isStopped())
+      return RVM_STOP_EXIT;
+    Fast.setInstret(Cpu.getInstret());
+    Fast.resume();
+    auto Reason = RVM_STOP_COUNT;
+    Fast.runUntil(MaxCount, StopPc);
+    if (logTrap(Fast.getUnhandledTrap())) {
+      Fast.resume();
+      Reason = RVM_STOP_TRAP;
+    } else if (Fast.isStopped()) {
+      Reason = RVM_STOP_EXIT;
+    } else if (readPC() == StopPc) {
+      Reason = RVM_STOP_PC;
+    }
+    Retired = Fast.getInstret() - Cpu.getInstret();
+    Cpu.continueFrom(Fast);
+    return Reason;
+  }
+
   uint64_t readPC() const { return Cpu.readPC().to_ullong(); }
   void setPC(unsigned long long PcValue) const { Cpu.setPC(PcValue); }
   void print() const { Cpu.print(); }
@@ -89,11 +339,56 @@ struct RVMState {
   std::unique_ptr<SnippyRVdash> Model;
 };
 
+//-------------------------------------ModelPool-----------------------------------------
+
+/**
+ * @brief class ModelPool - the models given back by rvm_modelDestroy, so
+ *                          that rvm_modelCreate does not build a new one
+ *                          (the decoders, the trace buffer) for every
+ *                          snippet. The X registers of RV32I belong to the
+ *                          process, only one model exists at a time, so one
+ *                          idle model is kept.
+ */
+class ModelPool {
+  std::unique_ptr<SnippyRVdash> Idle;
+
+  static std::unique_ptr<SnippyRVdash> create(const char *LogFilePath,
+                                              unsigned long long RamSt,
+                                              unsigned long long RamSz) {
+    if (LogFilePath != nullptr)
+      return std::make_unique<SnippyRVdash>(LogFilePath, RamSt, RamSz);
+    return std::make_unique<SnippyRVdash>(RamSt, RamSz);
+  }
+
+public:
+  static ModelPool &get() {
+    static ModelPool Pool;
+    return Pool;
+  }
+
+  std::unique_ptr<SnippyRVdash> take(const char *LogFilePath,
+                                     unsigned long long RamSt,
+                                     unsigned long long RamSz) {
+    if (Idle == nullptr)
+      return create(LogFilePath, RamSt, RamSz);
+    if (!Idle->canReuse(LogFilePath, RamSt, RamSz)) {
+      // It has the hart, the new model can be created only without it
+      Idle.reset();
+      return create(LogFilePath, RamSt, RamSz);
+    }
+    Idle->reuse(LogFilePath);
+    return std::move(Idle);
+  }
+
+  void giveBack(std::unique_ptr<SnippyRVdash> Model) {
+    Model->finish();
+    Idle = std::move(Model);
+  }
+};
+
 //---------------------Implementation_of_rvm_interface_functions-------------------------
 
 RVMState *rvm_modelCreate(const RVMConfig *Config) {
-  std::ofstream LogFile(Config->LogFilePath);
-  RVMState *State;
   // This is a temporary solution.
   // The model does not yet support ROM memory, but it will be available soon.
   unsigned long long RamStart, RamSize;
@@ -104,16 +399,20 @@ RVMState *rvm_modelCreate(const RVMConfig *Config) {
     RamStart = Config->RomStart;
     RamSize = Config->RamStart + Config->RamSize;
   }
-  if (strlen(Config->LogFilePath) != 0)
-    State = new RVMState(*Config, std::make_unique<SnippyRVdash>(
-                                      Config->LogFilePath, RamStart, RamSize));
-  else
-    State = new RVMState(*Config,
-                         std::make_unique<SnippyRVdash>(RamStart, RamSize));
+  auto *LogFilePath =
+      strlen(Config->LogFilePath) != 0 ? Config->LogFilePath : nullptr;
+  auto *State = new RVMState(
+      *Config, ModelPool::get().take(LogFilePath, RamStart, RamSize));
+  State->Model->setCallbacks(*Config);
   return State;
 }
 
-void rvm_modelDestroy(RVMState *State) { State->Model->~SnippyRVdash(); }
+void rvm_modelDestroy(RVMState *State) {
+  ModelPool::get().giveBack(std::move(State->Model));
+  delete State;
+}
+
+void rvm_modelReset(RVMState *State) { State->Model->reset(); }
 
 const RVMConfig *rvm_getModelConfig(const RVMState *State) {
   if (State == nullptr)
@@ -122,9 +421,7 @@ const RVMConfig *rvm_getModelConfig(const RVMState *State) {
 }
 
 int rvm_executeInstr(RVMState *State) {
-  State->Model->step();
-  State->Model->increasePC();
-  return 0;
+  return State->Model->step() ? 0 : 1;
 }
 
 void rvm_readMem(const RVMState *State, uint64_t Addr, size_t Count,
@@ -152,12 +449,29 @@ void rvm_setXReg(RVMState *State, RVMXReg Reg, RVMRegT Value) {
   State->Model->setXReg(Reg, Value);
 }
 
-// There are no CSR registers in the model yet,
-// but to show that everything is fine, zero is returned here
-RVMRegT rvm_readCSRReg(const RVMState *State, unsigned Reg) { return 0; }
-void rvm_setCSRReg(RVMState *State, unsigned Reg, RVMRegT Value) {}
+void rvm_readXRegSnapshot(const RVMState *State, RVMXRegSnapshot *Snapshot) {
+  State->Model->readXRegSnapshot(*Snapshot);
+}
+
+// CSRs that the model does not have are read as zero
+RVMRegT rvm_readCSRReg(const RVMState *State, unsigned Reg) {
+  return State->Model->readCSR(Reg).value_or(0);
+}
+void rvm_setCSRReg(RVMState *State, unsigned Reg, RVMRegT Value) {
+  State->Model->writeCSR(Reg, Value);
+}
+
+RVMStopReason rvm_executeBatch(RVMState *State, uint64_t MaxCount,
+                               uint64_t StopPC, uint64_t *Retired) {
+  uint64_t Count;
+  auto Reason = State->Model->executeBatch(MaxCount, StopPC, Count);
+  if (Retired != nullptr)
+    *Retired = Count;
+  return Reason;
+}
 
-int rvm_queryCallbackSupportPresent() { return 0; }
+// The callbacks are called by rvm_executeInstr, not by rvm_executeBatch
+int rvm_queryCallbackSupportPresent() { return 1; }
 void rvm_logMessage(const char *Message) { std::cout << Message; }
 
 // These functions are not implemented because the model does not support these
@@ -31,3 +31,12 @@ extern const rvm::RVM_FunctionPointers RVMAPI_ENTRY_POINT_SYMBOL = {
     .logMessage = &rvm_logMessage,
     .queryCallbackSupportPresent = &rvm_queryCallbackSupportPresent,
 };
+
+extern const rvm::RVMExt_FunctionPointers RVMEXT_ENTRY_POINT_SYMBOL = {
+    .Version = RVMEXT_CURRENT_VERSION,
+    .Size = sizeof(rvm::RVMExt_FunctionPointers),
+
+    .executeBatch = &rvm_executeBatch,
+    .modelReset = &rvm_modelReset,
+    .readXRegSnapshot = &rvm_readXRegSnapshot,
+};
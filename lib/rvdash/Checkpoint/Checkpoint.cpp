@@ -0,0 +1,118 @@
+#include "rvdash/Checkpoint/Checkpoint.h"
+#include "Error.h"
+
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace rvdash {
+
+namespace {
+
+uint64_t alignUp(uint64_t Value) {
+  return (Value + CheckpointAlign - 1) / CheckpointAlign * CheckpointAlign;
+}
+
+} // namespace
+
+//-----------------------------------CheckpointFile--------------------------------------
+
+CheckpointFile::CheckpointFile(const std::string &Path) {
+  int Fd = open(Path.c_str(), O_RDONLY);
+  if (Fd < 0)
+    failWithError("Can't open checkpoint file " + Path);
+  struct stat Stat;
+  if (fstat(Fd, &Stat) != 0) {
+    close(Fd);
+    failWithError("Can't read checkpoint file " + Path);
+  }
+  Size = Stat.st_size;
+  if (Size < sizeof(CheckpointHeader)) {
+    close(Fd);
+    failWithError("Corrupted checkpoint file " + Path + ": no header");
+  }
+  void *Mapped = mmap(nullptr, Size, PROT_READ, MAP_PRIVATE, Fd, 0);
+  close(Fd);
+  if (Mapped == MAP_FAILED)
+    failWithError("Can't map checkpoint file " + Path);
+  Data = static_cast<const unsigned char *>(Mapped);
+  Header = reinterpret_cast<const CheckpointHeader *>(Data);
+
+  auto Fail = [&](const std::string &Reason) {
+    munmap(const_cast<unsigned char *>(Data), Size);
+    failWithError("Corrupted checkpoint file " + Path + ": " + Reason);
+  };
+  if (std::memcmp(Header->Magic, CheckpointHeader::MagicValue,
+                  sizeof(Header->Magic)) != 0)
+    Fail("wrong magic");
+  if (Header->Version != CheckpointHeader::CurrentVersion)
+    Fail("unsupported version " + std::to_string(Header->Version));
+  if (Header->NumCSRs > CheckpointHeader::MaxCSRs)
+    Fail("too many CSRs");
+  auto TableEnd =
+      sizeof(CheckpointHeader) + Header->NumPages * sizeof(CheckpointPage);
+  if (Header->NumPages > Size / sizeof(CheckpointPage) || TableEnd > Size)
+    Fail("page table is out of the file");
+  PageTable = reinterpret_cast<const CheckpointPage *>(
+      Data + sizeof(CheckpointHeader));
+  for (uint64_t Idx = 0; Idx < Header->NumPages; ++Idx) {
+    auto &Entry = PageTable[Idx];
+    if (Entry.Offset > Size || Header->PageSz > Size - Entry.Offset)
+      Fail("page is out of the file");
+    if (Idx != 0 && PageTable[Idx - 1].Addr >= Entry.Addr)
+      Fail("page table is not sorted");
+  }
+}
+
+CheckpointFile::~CheckpointFile() {
+  munmap(const_cast<unsigned char *>(Data), Size);
+}
+
+const unsigned char *CheckpointFile::findPage(unsigned long long Addr) const {
+  auto *End = PageTable + Header->NumPages;
+  auto *Entry = std::lower_bound(
+      PageTable, End, Addr,
+      [](const CheckpointPage &Lhs, uint64_t Rhs) { return Lhs.Addr < Rhs; });
+  if (Entry == End || Entry->Addr != Addr)
+    return nullptr;
+  return Data + Entry->Offset;
+}
+
+std::vector<unsigned long long> CheckpointFile::getPageAddrs() const {
+  std::vector<unsigned long long> Addrs;
+  for (uint64_t Idx = 0; Idx < Header->NumPages; ++Idx)
+    Addrs.push_back(PageTable[Idx].Addr);
+  return Addrs;
+}
+
+//----------------------------------writeCheckpoint--------------------------------------
+
+void writeCheckpoint(
+    const std::string &Path, const CheckpointHeader &Header,
+    const std::vector<std::pair<uint64_t, std::vector<unsigned char>>> &Pages) {
+  std::ofstream File(Path, std::ios::binary);
+  if (!File.is_open())
+    failWithError("Can't open checkpoint file " + Path);
+  auto FullHeader = Header;
+  FullHeader.NumPages = Pages.size();
+  File.write(reinterpret_cast<const char *>(&FullHeader), sizeof(FullHeader));
+
+  auto Offset = alignUp(sizeof(CheckpointHeader) +
+                        Pages.size() * sizeof(CheckpointPage));
+  for (auto &[Addr, Bytes] : Pages) {
+    CheckpointPage Entry{Addr, Offset};
+    File.write(reinterpret_cast<const char *>(&Entry), sizeof(Entry));
+    Offset = alignUp(Offset + Bytes.size());
+  }
+  for (auto &[Addr, Bytes] : Pages) {
+    File.seekp(alignUp(File.tellp()));
+    File.write(reinterpret_cast<const char *>(Bytes.data()), Bytes.size());
+  }
+  if (!File)
+    failWithError("Can't write checkpoint file " + Path);
+}
+
+} // namespace rvdash
@@ -0,0 +1,123 @@
+#include "rvdash/Elf/ElfImage.h"
+#include "Error.h"
+#include "StateHash.h"
+
+#include <algorithm>
+#include <cstring>
+#include <elf.h>
+#include <fstream>
+#include <iterator>
+
+namespace rvdash {
+
+namespace {
+
+template <typename T>
+const T *getAt(const std::vector<char> &File, uint64_t Offset,
+               uint64_t Count = 1) {
+  if (Offset > File.size() || Count * sizeof(T) > File.size() - Offset)
+    failWithError("Corrupted ELF file: data is out of the file");
+  return reinterpret_cast<const T *>(File.data() + Offset);
+}
+
+/**
+ * @brief readSegments - it passes the PT_LOAD segments to Add. EhdrType and
+ *                       PhdrType are the ELF32 or ELF64 structures from
+ *                       <elf.h>.
+ */
+template <typename EhdrType, typename PhdrType, typename AddType>
+uint64_t readSegments(const std::vector<char> &File, AddType Add) {
+  auto *Ehdr = getAt<EhdrType>(File, 0);
+  if (Ehdr->e_machine != EM_RISCV)
+    failWithError("ELF file is not for RISC-V");
+  if (Ehdr->e_type != ET_EXEC)
+    failWithError("ELF file is not an executable");
+  auto *Phdrs = getAt<PhdrType>(File, Ehdr->e_phoff, Ehdr->e_phnum);
+  for (unsigned Idx = 0; Idx < Ehdr->e_phnum; ++Idx) {
+    auto &Phdr = Phdrs[Idx];
+    if (Phdr.p_type != PT_LOAD || Phdr.p_memsz == 0)
+      continue;
+    if (Phdr.p_filesz > Phdr.p_memsz)
+      failWithError("Corrupted ELF file: segment is larger in the file");
+    auto *Data = getAt<unsigned char>(File, Phdr.p_offset, Phdr.p_filesz);
+    // Like objcopy -O binary, the segments go to the physical addresses
+    Add(Data, Phdr.p_paddr, Phdr.p_filesz, Phdr.p_memsz);
+  }
+  return Ehdr->e_entry;
+}
+
+} // namespace
+
+ElfImage::ElfImage(const std::string &ElfPath, uint64_t PageBytes)
+    : PageSz(PageBytes) {
+  std::ifstream ElfFile(ElfPath, std::ios::binary);
+  if (!ElfFile.is_open())
+    failWithError("Can't open file " + ElfPath);
+  std::vector<char> File{std::istreambuf_iterator<char>(ElfFile),
+                         std::istreambuf_iterator<char>()};
+  if (File.size() < EI_NIDENT || std::memcmp(File.data(), ELFMAG, SELFMAG))
+    failWithError(ElfPath + " is not an ELF file");
+  if (File[EI_DATA] != ELFDATA2LSB)
+    failWithError(ElfPath + " is not little-endian");
+  auto Add = [this](const unsigned char *Data, uint64_t Addr, uint64_t FileSz,
+                    uint64_t MemSz) { addSegment(Data, Addr, FileSz, MemSz); };
+  if (File[EI_CLASS] == ELFCLASS32)
+    Entry = readSegments<Elf32_Ehdr, Elf32_Phdr>(File, Add);
+  else if (File[EI_CLASS] == ELFCLASS64)
+    Entry = readSegments<Elf64_Ehdr, Elf64_Phdr>(File, Add);
+  else
+    failWithError(ElfPath + " has an unknown ELF class");
+  if (Segments.empty())
+    failWithError(ElfPath + " has no loadable segments");
+}
+
+bool ElfImage::isElfFile(const std::string &Path) {
+  std::ifstream File(Path, std::ios::binary);
+  char Magic[SELFMAG];
+  return File.read(Magic, SELFMAG) &&
+         std::memcmp(Magic, ELFMAG, SELFMAG) == 0;
+}
+
+void ElfImage::addSegment(const unsigned char *Data, uint64_t Addr,
+                          uint64_t FileSz, uint64_t MemSz) {
+  for (auto &Seg : Segments)
+    if (Addr < Seg.Addr + Seg.MemSz && Seg.Addr < Addr + MemSz)
+      failWithError("Corrupted ELF file: segments overlap");
+  Segments.push_back({Addr, FileSz, MemSz});
+  // Only the bytes from the file, the rest of the segment stays zero
+  for (uint64_t Offset = 0; Offset < FileSz;) {
+    auto ByteAddr = Addr + Offset;
+    auto PageAddr = ByteAddr / PageSz * PageSz;
+    auto InPage = ByteAddr - PageAddr;
+    auto Count = std::min(FileSz - Offset, PageSz - InPage);
+    auto &Page = Pages[PageAddr];
+    if (Page.empty())
+      Page.resize(PageSz);
+    std::copy(Data + Offset, Data + Offset + Count, Page.begin() + InPage);
+    for (uint64_t Idx = 0; Idx < Count; ++Idx)
+      StateHash ^= hashStateElem(MEMORY_HASH_DOMAIN, ByteAddr + Idx,
+                                 Data[Offset + Idx]);
+    Offset += Count;
+  }
+}
+
+uint64_t ElfImage::getEnd() const {
+  uint64_t End = 0;
+  for (auto &Seg : Segments)
+    End = std::max(End, Seg.Addr + Seg.MemSz);
+  return End;
+}
+
+const unsigned char *ElfImage::findPage(unsigned long long Addr) const {
+  auto It = Pages.find(Addr);
+  return It == Pages.end() ? nullptr : It->second.data();
+}
+
+std::vector<unsigned long long> ElfImage::getPageAddrs() const {
+  std::vector<unsigned long long> Addrs;
+  for (auto &[Addr, Page] : Pages)
+    Addrs.push_back(Addr);
+  return Addrs;
+}
+
+} // namespace rvdash
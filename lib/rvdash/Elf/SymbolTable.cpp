@@ -0,0 +1,124 @@
+#include "rvdash/Elf/SymbolTable.h"
+#include "Error.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <elf.h>
+#include <fstream>
+#include <iterator>
+
+namespace rvdash {
+
+namespace {
+
+template <typename T>
+const T *getAt(const std::vector<char> &File, uint64_t Offset,
+               uint64_t Count = 1) {
+  if (Offset > File.size() || Count * sizeof(T) > File.size() - Offset)
+    failWithError("Corrupted ELF file: data is out of the file");
+  return reinterpret_cast<const T *>(File.data() + Offset);
+}
+
+template <typename SymType> bool isCodeSymbol(const SymType &Sym) {
+  auto Type = Sym.st_info & 0xf;
+  return Sym.st_shndx != SHN_UNDEF && Sym.st_shndx < SHN_LORESERVE &&
+         (Type == STT_FUNC || Type == STT_NOTYPE);
+}
+
+/**
+ * @brief readSymbols - it collects the code symbols of all SHT_SYMTAB
+ *                      sections. EhdrType, ShdrType and SymType are the
+ *                      ELF32 or ELF64 structures from <elf.h>.
+ */
+template <typename EhdrType, typename ShdrType, typename SymType>
+void readSymbols(const std::vector<char> &File,
+                 std::vector<SymbolTable::Symbol> &Symbols) {
+  auto *Ehdr = getAt<EhdrType>(File, 0);
+  if (Ehdr->e_shoff == 0)
+    return;
+  auto *Sections = getAt<ShdrType>(File, Ehdr->e_shoff, Ehdr->e_shnum);
+  for (unsigned Idx = 0; Idx < Ehdr->e_shnum; ++Idx) {
+    auto &Sec = Sections[Idx];
+    if (Sec.sh_type != SHT_SYMTAB)
+      continue;
+    if (Sec.sh_link >= Ehdr->e_shnum)
+      failWithError("Corrupted ELF file: wrong string table of symbols");
+    auto &StrSec = Sections[Sec.sh_link];
+    auto *Strings = getAt<char>(File, StrSec.sh_offset, StrSec.sh_size);
+    auto SymCount = Sec.sh_size / sizeof(SymType);
+    auto *Syms = getAt<SymType>(File, Sec.sh_offset, SymCount);
+    for (uint64_t SymIdx = 0; SymIdx < SymCount; ++SymIdx) {
+      auto &Sym = Syms[SymIdx];
+      if (!isCodeSymbol(Sym) || Sym.st_name >= StrSec.sh_size)
+        continue;
+      std::string Name(Strings + Sym.st_name,
+                       strnlen(Strings + Sym.st_name,
+                               StrSec.sh_size - Sym.st_name));
+      // Local labels of the assembler (.L*) and mapping symbols ($x) are noise
+      if (Name.empty() || Name.starts_with(".L") || Name.starts_with("$"))
+        continue;
+      Symbols.push_back({Sym.st_value, Sym.st_size, std::move(Name)});
+    }
+  }
+}
+
+} // namespace
+
+SymbolTable::SymbolTable(const std::string &ElfPath) {
+  std::ifstream ElfFile(ElfPath, std::ios::binary);
+  if (!ElfFile.is_open())
+    failWithError("Can't open file " + ElfPath);
+  std::vector<char> File{std::istreambuf_iterator<char>(ElfFile),
+                         std::istreambuf_iterator<char>()};
+  if (File.size() < EI_NIDENT || std::memcmp(File.data(), ELFMAG, SELFMAG))
+    failWithError(ElfPath + " is not an ELF file");
+  if (File[EI_CLASS] == ELFCLASS32)
+    readSymbols<Elf32_Ehdr, Elf32_Shdr, Elf32_Sym>(File, Symbols);
+  else if (File[EI_CLASS] == ELFCLASS64)
+    readSymbols<Elf64_Ehdr, Elf64_Shdr, Elf64_Sym>(File, Symbols);
+  else
+    failWithError(ElfPath + " has an unknown ELF class");
+
+  // Functions win over labels at the same address
+  std::stable_sort(Symbols.begin(), Symbols.end(),
+                   [](const Symbol &Lhs, const Symbol &Rhs) {
+                     if (Lhs.Addr != Rhs.Addr)
+                       return Lhs.Addr < Rhs.Addr;
+                     return Lhs.Size > Rhs.Size;
+                   });
+  Symbols.erase(std::unique(Symbols.begin(), Symbols.end(),
+                            [](const Symbol &Lhs, const Symbol &Rhs) {
+                              return Lhs.Addr == Rhs.Addr;
+                            }),
+                Symbols.end());
+}
+
+const SymbolTable::Symbol *SymbolTable::lookup(uint64_t Addr) const {
+  auto It = std::upper_bound(
+      Symbols.begin(), Symbols.end(), Addr,
+      [](uint64_t Addr, const Symbol &Sym) { return Addr < Sym.Addr; });
+  if (It == Symbols.begin())
+    return nullptr;
+  --It;
+  if (It->Size != 0 && Addr - It->Addr >= It->Size)
+    return nullptr;
+  return &*It;
+}
+
+std::string SymbolTable::symbolize(uint64_t Addr) const {
+  char Buf[32];
+  auto *Sym = lookup(Addr);
+  if (Sym == nullptr) {
+    snprintf(Buf, sizeof(Buf), "0x%llx",
+             static_cast<unsigned long long>(Addr));
+    return Buf;
+  }
+  if (Addr == Sym->Addr)
+    return Sym->Name;
+  snprintf(Buf, sizeof(Buf), "+0x%llx",
+           static_cast<unsigned long long>(Addr - Sym->Addr));
+  return Sym->Name + Buf;
+}
+
+} // namespace rvdash
@@ -0,0 +1,175 @@
+#include "rvdash/InstructionSet/Disassembler.h"
+#include "rvdash/InstructionSet/RV32I/InstructionSet.h"
+#include "rvdash/Trace/TraceFormat.h"
+
+#include <string_view>
+
+namespace rvdash {
+
+using namespace TraceFormat;
+
+namespace {
+
+enum Opcode {
+  OP = 0b0110011,
+  OP_IMM = 0b0010011,
+  LOAD = 0b0000011,
+  STORE = 0b0100011,
+  BRANCH = 0b1100011,
+  JAL = 0b1101111,
+  JALR = 0b1100111,
+  LUI = 0b0110111,
+  AUIPC = 0b0010111,
+  SYSTEM = 0b1110011,
+};
+
+// Indexed by funct3, the second half is for funct7 bit 30 (SUB and SRA)
+constexpr std::string_view OpNames[] = {
+    "add ", "sll ", "slt ", "sltu ", "xor ", "slr ", "or ", "and ",
+    "sub ", "sll ", "slt ", "sltu ", "xor ", "sra ", "or ", "and "};
+constexpr std::string_view OpImmNames[] = {
+    "addi ", "slli ", "slti ", "sltiu ", "xori ", "srli ", "ori ", "andi ",
+    "addi ", "slli ", "slti ", "sltiu ", "xori ", "srai ", "ori ", "andi "};
+constexpr std::string_view LoadNames[] = {"lb ",  "lh ",  "lw ", "l? ",
+                                          "lbu ", "lhu ", "l? ", "l? "};
+constexpr std::string_view StoreNames[] = {"sb ", "sh ", "sw ", "s? ",
+                                           "s? ", "s? ", "s? ", "s? "};
+constexpr std::string_view CSRNames[] = {"c? ",     "csrrw ",  "csrrs ",
+                                         "csrrc ",  "c? ",     "csrrwi ",
+                                         "csrrsi ", "csrrci "};
+constexpr std::string_view BranchNames[] = {"beq ", "bne ", "b? ",  "b? ",
+                                            "blt ", "bge ", "bltu ", "bgeu "};
+
+char *putName(char *Out, std::string_view Name) {
+  return putStr(Out, Name.data(), Name.size());
+}
+
+// "0x<imm>", negative immediates are printed as 32-bit two's complement
+char *putImm(char *Out, int32_t Imm) {
+  Out = putStr(Out, "0x");
+  return putHex(Out, static_cast<uint32_t>(Imm));
+}
+
+char *putRegs(char *Out, unsigned First, unsigned Second) {
+  Out = putXReg(Out, First);
+  Out = putStr(Out, ", ");
+  return putXReg(Out, Second);
+}
+
+} // namespace
+
+char *disassemble(char *Out, uint32_t Word) {
+  unsigned Rd = (Word >> 7) & 0x1f;
+  unsigned Funct3 = (Word >> 12) & 0x7;
+  unsigned Rs1 = (Word >> 15) & 0x1f;
+  unsigned Rs2 = (Word >> 20) & 0x1f;
+  unsigned Alt = ((Word >> 30) & 0x1) << 3;
+  int32_t ImmI = static_cast<int32_t>(Word) >> 20;
+  switch (Word & 0x7f) {
+  case OP:
+    Out = putName(Out, OpNames[Alt | Funct3]);
+    Out = putRegs(Out, Rd, Rs1);
+    Out = putStr(Out, ", ");
+    Out = putXReg(Out, Rs2);
+    break;
+  case OP_IMM:
+    if (Funct3 == 0b000 && Rd == 0 && Rs1 == 0 && ImmI == 0)
+      return putStr(Out, "nop\n");
+    // Shifts print only the shift amount (lower 5 bits)
+    if (Funct3 == 0b001 || Funct3 == 0b101)
+      ImmI &= 0x1f;
+    Out = putName(Out, OpImmNames[Alt | Funct3]);
+    Out = putRegs(Out, Rd, Rs1);
+    Out = putStr(Out, ", ");
+    Out = putImm(Out, ImmI);
+    break;
+  case LOAD:
+    Out = putName(Out, LoadNames[Funct3]);
+    Out = putXReg(Out, Rd);
+    Out = putStr(Out, ", ");
+    Out = putImm(Out, ImmI);
+    Out = putStr(Out, "(");
+    Out = putXReg(Out, Rs1);
+    Out = putStr(Out, ")");
+    break;
+  case STORE: {
+    int32_t Imm = ((static_cast<int32_t>(Word) >> 25) << 5) | Rd;
+    Out = putName(Out, StoreNames[Funct3]);
+    Out = putXReg(Out, Rs2);
+    Out = putStr(Out, ", ");
+    Out = putImm(Out, Imm);
+    Out = putStr(Out, "(");
+    Out = putXReg(Out, Rs1);
+    Out = putStr(Out, ")");
+    break;
+  }
+  case BRANCH: {
+    // imm[12:1], as the branch handlers see it
+    uint32_t Imm = ((Word >> 8) & 0xf) | ((Word >> 25) & 0x3f) << 4 |
+                   ((Word >> 7) & 0x1) << 10 | ((Word >> 31) & 0x1) << 11;
+    Out = putName(Out, BranchNames[Funct3]);
+    Out = putRegs(Out, Rs1, Rs2);
+    Out = putStr(Out, ", ");
+    Out = putImm(Out, RV32I::signExtend<12, 32>(Imm));
+    break;
+  }
+  case JAL: {
+    // imm[20:1]
+    uint32_t Imm = ((Word >> 21) & 0x3ff) | ((Word >> 20) & 0x1) << 10 |
+                   ((Word >> 12) & 0xff) << 11 | ((Word >> 31) & 0x1) << 19;
+    Out = putStr(Out, "jal ");
+    Out = putXReg(Out, Rd);
+    Out = putStr(Out, ", ");
+    Out = putImm(Out, RV32I::signExtend<20, 32>(Imm));
+    break;
+  }
+  case JALR:
+    Out = putStr(Out, "jalr ");
+    Out = putXReg(Out, Rd);
+    Out = putStr(Out, ", ");
+    Out = putImm(Out, ImmI);
+    Out = putStr(Out, "(");
+    Out = putXReg(Out, Rs1);
+    Out = putStr(Out, ")");
+    break;
+  case LUI:
+  case AUIPC:
+    Out = (Word & 0x7f) == LUI ? putStr(Out, "lui ") : putStr(Out, "auipc ");
+    Out = putXReg(Out, Rd);
+    Out = putStr(Out, ", 0x");
+    Out = putHex(Out, Word >> 12);
+    break;
+  case SYSTEM:
+    if (Funct3 != 0) {
+      // "csrrs X1, 0xc00, X2" or "csrrsi X1, 0xc00, 0x2"
+      Out = putName(Out, CSRNames[Funct3]);
+      Out = putXReg(Out, Rd);
+      Out = putStr(Out, ", 0x");
+      Out = putHex(Out, Word >> 20);
+      Out = putStr(Out, ", ");
+      if (Funct3 & 0b100)
+        Out = putImm(Out, Rs1);
+      else
+        Out = putXReg(Out, Rs1);
+      break;
+    }
+    if (Word == 0b000000000001'00000'000'00000'1110011)
+      return putStr(Out, "ebreak\n");
+    if (Word == 0b001100000010'00000'000'00000'1110011)
+      return putStr(Out, "mret\n");
+    if (Word == 0b000100000101'00000'000'00000'1110011)
+      return putStr(Out, "wfi\n");
+    return putStr(Out, "ecall");
+  default:
+    Out = putStr(Out, "unknown 0x");
+    Out = putHex(Out, Word);
+  }
+  return putStr(Out, "\n");
+}
+
+void disassemble(std::ostream &Stream, uint32_t Instr) {
+  char Line[MaxLineSz];
+  Stream.write(Line, disassemble(Line, Instr) - Line);
+}
+
+} // namespace rvdash
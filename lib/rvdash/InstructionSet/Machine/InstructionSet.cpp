@@ -0,0 +1,13 @@
+#include "rvdash/InstructionSet/Machine/InstructionSet.h"
+
+namespace rvdash {
+
+std::array<uint32_t, Machine::NumCSRs> Machine::MachineInstrExecutor::CSRs;
+
+std::ostream &operator<<(std::ostream &Stream,
+                         const typename Machine::MachineInstrSet &Set) {
+  Set.dump(Stream);
+  return Stream;
+}
+
+} // namespace rvdash
@@ -4,6 +4,7 @@ namespace rvdash {
 namespace RV32I {
 
 std::shared_ptr<RV32IRegistersSet> RV32IInstrExecutor::Registers;
+std::shared_ptr<SyscallEmulator> RV32IInstrExecutor::Syscalls;
 
 } // namespace RV32I
 
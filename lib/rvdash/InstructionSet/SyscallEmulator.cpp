@@ -0,0 +1,203 @@
+#include "rvdash/InstructionSet/SyscallEmulator.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <ctime>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace rvdash {
+
+namespace {
+
+// Values of the asm-generic <fcntl.h> of the guest
+constexpr int64_t GuestAtFdCwd = -100;
+constexpr int64_t GuestOAccMode = 03;
+constexpr std::pair<int64_t, int> GuestOpenFlags[] = {
+    {0100, O_CREAT},       {0200, O_EXCL},        {0400, O_NOCTTY},
+    {01000, O_TRUNC},      {02000, O_APPEND},     {04000, O_NONBLOCK},
+    {0200000, O_DIRECTORY}, {0400000, O_NOFOLLOW}, {02000000, O_CLOEXEC}};
+
+int getHostOpenFlags(int64_t Flags) {
+  int HostFlags = Flags & GuestOAccMode;
+  for (auto [Guest, Host] : GuestOpenFlags)
+    if (Flags & Guest)
+      HostFlags |= Host;
+  return HostFlags;
+}
+
+int64_t getError() { return -static_cast<int64_t>(errno); }
+
+} // namespace
+
+int SyscallEmulator::getHostFd(int64_t Fd) const {
+  if (Fd < 0 || static_cast<uint64_t>(Fd) >= HostFds.size())
+    return -1;
+  return HostFds[Fd];
+}
+
+void SyscallEmulator::flush() {
+  for (size_t Done = 0; Done < OutBuffer.size();) {
+    auto Written =
+        ::write(OutFd, OutBuffer.data() + Done, OutBuffer.size() - Done);
+    if (Written < 0 && errno == EINTR)
+      continue;
+    // Nothing to report the error to, the guest has seen the write succeed
+    if (Written <= 0)
+      break;
+    Done += Written;
+  }
+  OutBuffer.clear();
+}
+
+void SyscallEmulator::bufferOutput(int HostFd, const unsigned char *Data,
+                                   uint64_t Size) {
+  // One buffer keeps the order of stdout and stderr
+  if (HostFd != OutFd || OutBuffer.size() + Size > ChunkSz)
+    flush();
+  OutFd = HostFd;
+  OutBuffer.insert(OutBuffer.end(), Data, Data + Size);
+}
+
+void SyscallEmulator::record(const std::string &Path) {
+  Recorder = std::make_unique<SyscallLogWriter>(Path);
+}
+
+void SyscallEmulator::replay(const std::string &Path, bool SkipOutputs) {
+  Replayer = std::make_unique<SyscallLogReader>(Path);
+  SkipOutput = SkipOutputs;
+}
+
+void SyscallEmulator::rewindHistory(uint64_t Instret) {
+  HistoryPos = std::lower_bound(History.begin(), History.end(), Instret,
+                                [](const SyscallRecord &Record,
+                                   uint64_t Value) {
+                                  return Record.Instret < Value;
+                                }) -
+               History.begin();
+}
+
+int64_t SyscallEmulator::writeHost(int64_t Fd, const unsigned char *Data,
+                                   uint64_t Size) {
+  auto HostFd = getHostFd(Fd);
+  if (HostFd < 0)
+    return -EBADF;
+  if (HostFd == STDOUT_FILENO || HostFd == STDERR_FILENO) {
+    if (Size <= ChunkSz) {
+      bufferOutput(HostFd, Data, Size);
+      return Size;
+    }
+    // A large output goes after the buffered one
+    flush();
+  }
+  ssize_t Written;
+  do
+    Written = ::write(HostFd, Data, Size);
+  while (Written < 0 && errno == EINTR);
+  return Written < 0 ? getError() : Written;
+}
+
+int64_t SyscallEmulator::readHost(int64_t Fd, unsigned char *Data,
+                                  uint64_t Size) {
+  auto HostFd = getHostFd(Fd);
+  if (HostFd < 0)
+    return -EBADF;
+  // A prompt must be seen before the input is waited for
+  if (HostFd == STDIN_FILENO)
+    flush();
+  ssize_t Read;
+  do
+    Read = ::read(HostFd, Data, Size);
+  while (Read < 0 && errno == EINTR);
+  return Read < 0 ? getError() : Read;
+}
+
+int64_t SyscallEmulator::openat(int64_t DirFd, const std::string &Path,
+                                int64_t Flags, int64_t Mode) {
+  int HostDirFd = AT_FDCWD;
+  if (DirFd != GuestAtFdCwd) {
+    HostDirFd = getHostFd(DirFd);
+    if (HostDirFd < 0)
+      return -EBADF;
+  }
+  int HostFd = ::openat(HostDirFd, Path.c_str(), getHostOpenFlags(Flags),
+                        static_cast<mode_t>(Mode));
+  if (HostFd < 0)
+    return getError();
+  for (size_t Fd = 0; Fd < HostFds.size(); ++Fd)
+    if (HostFds[Fd] < 0) {
+      HostFds[Fd] = HostFd;
+      return Fd;
+    }
+  HostFds.push_back(HostFd);
+  return HostFds.size() - 1;
+}
+
+int64_t SyscallEmulator::close(int64_t Fd) {
+  auto HostFd = getHostFd(Fd);
+  if (HostFd < 0)
+    return -EBADF;
+  HostFds[Fd] = -1;
+  // The descriptors of the simulator stay open
+  if (HostFd <= STDERR_FILENO) {
+    if (HostFd == OutFd)
+      flush();
+    return 0;
+  }
+  return ::close(HostFd) == 0 ? 0 : getError();
+}
+
+int64_t SyscallEmulator::lseek(int64_t Fd, int64_t Offset, int64_t Whence) {
+  auto HostFd = getHostFd(Fd);
+  if (HostFd < 0)
+    return -EBADF;
+  // SEEK_SET, SEEK_CUR and SEEK_END are the same for the guest
+  auto Result = ::lseek(HostFd, Offset, Whence);
+  return Result < 0 ? getError() : Result;
+}
+
+int64_t SyscallEmulator::fstat(int64_t Fd, GuestStat &Stat) {
+  auto HostFd = getHostFd(Fd);
+  if (HostFd < 0)
+    return -EBADF;
+  struct stat HostStat;
+  if (::fstat(HostFd, &HostStat) != 0)
+    return getError();
+  Stat.Dev = HostStat.st_dev;
+  Stat.Ino = HostStat.st_ino;
+  Stat.Mode = HostStat.st_mode;
+  Stat.Nlink = HostStat.st_nlink;
+  Stat.Uid = HostStat.st_uid;
+  Stat.Gid = HostStat.st_gid;
+  Stat.Rdev = HostStat.st_rdev;
+  Stat.Size = HostStat.st_size;
+  Stat.Blksize = HostStat.st_blksize;
+  Stat.Blocks = HostStat.st_blocks;
+  Stat.Atime = HostStat.st_atim.tv_sec;
+  Stat.AtimeNsec = HostStat.st_atim.tv_nsec;
+  Stat.Mtime = HostStat.st_mtim.tv_sec;
+  Stat.MtimeNsec = HostStat.st_mtim.tv_nsec;
+  Stat.Ctime = HostStat.st_ctim.tv_sec;
+  Stat.CtimeNsec = HostStat.st_ctim.tv_nsec;
+  return 0;
+}
+
+int64_t SyscallEmulator::clockGettime(int64_t ClockId, int64_t &Sec,
+                                      int64_t &Nsec) {
+  struct timespec Time;
+  if (::clock_gettime(static_cast<clockid_t>(ClockId), &Time) != 0)
+    return getError();
+  Sec = Time.tv_sec;
+  Nsec = Time.tv_nsec;
+  return 0;
+}
+
+uint64_t SyscallEmulator::brk(uint64_t Addr) {
+  // The heap can't go below the program, the failure is the old break
+  if (Addr >= BrkStart)
+    Brk = Addr;
+  return Brk;
+}
+
+} // namespace rvdash
@@ -0,0 +1,137 @@
+#include "rvdash/InstructionSet/SyscallLog.h"
+#include "Error.h"
+
+#include <cstring>
+
+namespace rvdash {
+
+namespace {
+
+constexpr char LogMagic[8] = {'R', 'V', 'D', 'S', 'Y', 'S', 'L', 0};
+constexpr uint32_t LogVersion = 1;
+// Limit of a store in a record, a corrupted size must not be allocated
+constexpr uint64_t MaxRecordSz = 1 << 30;
+
+struct LogHeader {
+  char Magic[8];
+  uint32_t Version;
+  uint32_t Reserved;
+};
+
+void putVarint(std::ofstream &File, uint64_t Value) {
+  char Bytes[10];
+  unsigned Size = 0;
+  do {
+    Bytes[Size] = Value & 0x7f;
+    Value >>= 7;
+    if (Value != 0)
+      Bytes[Size] |= 0x80;
+    ++Size;
+  } while (Value != 0);
+  File.write(Bytes, Size);
+}
+
+/**
+ * @brief getVarint - false only at the end of the file before the first
+ *                    byte, a cut number is an error.
+ */
+bool getVarint(std::ifstream &File, const std::string &Path, uint64_t &Value) {
+  Value = 0;
+  for (unsigned Shift = 0;; Shift += 7) {
+    auto Byte = File.get();
+    if (Byte == std::ifstream::traits_type::eof()) {
+      if (Shift == 0)
+        return false;
+      failWithError("Corrupted syscall log " + Path + ": cut record");
+    }
+    if (Shift > 63)
+      failWithError("Corrupted syscall log " + Path + ": too long number");
+    Value |= static_cast<uint64_t>(Byte & 0x7f) << Shift;
+    if (!(Byte & 0x80))
+      return true;
+  }
+}
+
+uint64_t toZigzag(int64_t Value) {
+  return (static_cast<uint64_t>(Value) << 1) ^
+         static_cast<uint64_t>(Value >> 63);
+}
+
+int64_t fromZigzag(uint64_t Value) {
+  return static_cast<int64_t>(Value >> 1) ^ -static_cast<int64_t>(Value & 1);
+}
+
+} // namespace
+
+//----------------------------------SyscallLogWriter-------------------------------------
+
+SyscallLogWriter::SyscallLogWriter(const std::string &Path)
+    : File(Path, std::ios::binary) {
+  if (!File.is_open())
+    failWithError("Can't open syscall log " + Path);
+  LogHeader Header{};
+  std::memcpy(Header.Magic, LogMagic, sizeof(LogMagic));
+  Header.Version = LogVersion;
+  File.write(reinterpret_cast<const char *>(&Header), sizeof(Header));
+}
+
+SyscallLogWriter::~SyscallLogWriter() { File.flush(); }
+
+void SyscallLogWriter::write(const SyscallRecord &Record) {
+  putVarint(File, Record.Instret - PrevInstret);
+  PrevInstret = Record.Instret;
+  putVarint(File, Record.SysNum);
+  putVarint(File, toZigzag(Record.Result));
+  putVarint(File, Record.Stores.size());
+  for (auto &[Addr, Bytes] : Record.Stores) {
+    putVarint(File, Addr);
+    putVarint(File, Bytes.size());
+    File.write(reinterpret_cast<const char *>(Bytes.data()), Bytes.size());
+  }
+}
+
+//----------------------------------SyscallLogReader-------------------------------------
+
+SyscallLogReader::SyscallLogReader(const std::string &FilePath)
+    : File(FilePath, std::ios::binary), Path(FilePath) {
+  if (!File.is_open())
+    failWithError("Can't open syscall log " + Path);
+  LogHeader Header;
+  if (!File.read(reinterpret_cast<char *>(&Header), sizeof(Header)) ||
+      std::memcmp(Header.Magic, LogMagic, sizeof(LogMagic)) != 0)
+    failWithError("Corrupted syscall log " + Path + ": wrong magic");
+  if (Header.Version != LogVersion)
+    failWithError("Corrupted syscall log " + Path + ": unsupported version " +
+                  std::to_string(Header.Version));
+}
+
+bool SyscallLogReader::read(SyscallRecord &Record) {
+  uint64_t Delta, Result, NumStores;
+  if (!getVarint(File, Path, Delta))
+    return false;
+  auto GetField = [this](uint64_t &Value) {
+    if (!getVarint(File, Path, Value))
+      failWithError("Corrupted syscall log " + Path + ": cut record");
+  };
+  GetField(Record.SysNum);
+  GetField(Result);
+  GetField(NumStores);
+  PrevInstret += Delta;
+  Record.Instret = PrevInstret;
+  Record.Result = fromZigzag(Result);
+  Record.Stores.clear();
+  for (uint64_t Idx = 0; Idx < NumStores; ++Idx) {
+    uint64_t Addr, Size;
+    GetField(Addr);
+    GetField(Size);
+    if (Size > MaxRecordSz)
+      failWithError("Corrupted syscall log " + Path + ": too large record");
+    std::vector<unsigned char> Bytes(Size);
+    if (!File.read(reinterpret_cast<char *>(Bytes.data()), Size))
+      failWithError("Corrupted syscall log " + Path + ": cut record");
+    Record.Stores.emplace_back(Addr, std::move(Bytes));
+  }
+  return true;
+}
+
+} // namespace rvdash
@@ -0,0 +1,35 @@
+#include "rvdash/InstructionSet/Trap.h"
+
+#include <bitset>
+#include <sstream>
+
+namespace rvdash {
+
+std::string describeTrap(const TrapInfo &Trap) {
+  std::ostringstream Message;
+  switch (Trap.Cause) {
+  case TrapCause::InstrAddrMisaligned:
+    Message << Trap.Reason << ": " << Trap.Tval;
+    break;
+  case TrapCause::InstrAccessFault:
+  case TrapCause::LoadAccessFault:
+  case TrapCause::StoreAccessFault:
+    Message << "Invalid memory access, address " << Trap.Tval
+            << " not available";
+    break;
+  case TrapCause::IllegalInstr:
+    if (Trap.Reason == nullptr)
+      Message << "Illegal instruction: " << std::bitset<32>(Trap.Tval);
+    else
+      Message << "Illegal instruction: " << Trap.Reason << " 0x" << std::hex
+              << Trap.Info;
+    break;
+  case TrapCause::EcallFromM:
+    Message << "Unknown syscall number " << Trap.Info;
+    break;
+  }
+  Message << " (pc 0x" << std::hex << Trap.Pc << ")";
+  return Message.str();
+}
+
+} // namespace rvdash
@@ -0,0 +1,11 @@
+#include "rvdash/InstructionSet/Zicsr/InstructionSet.h"
+
+namespace rvdash {
+
+std::ostream &operator<<(std::ostream &Stream,
+                         const typename Zicsr::ZicsrInstrSet &Set) {
+  Set.dump(Stream);
+  return Stream;
+}
+
+} // namespace rvdash
@@ -0,0 +1,52 @@
+#include "rvdash/Lockstep/ReferenceModel.h"
+#include "Error.h"
+
+#include <dlfcn.h>
+
+namespace rvdash {
+
+ReferenceModel::ReferenceModel(const std::string &Path, uint64_t RamStart,
+                               uint64_t RamSize) {
+  Handle = dlopen(Path.c_str(), RTLD_NOW | RTLD_LOCAL);
+  if (Handle == nullptr)
+    failWithError("Can't load reference model " + Path + ": " + dlerror());
+  auto *Version = static_cast<const unsigned char *>(
+      dlsym(Handle, "RVMInterfaceVersion"));
+  if (Version == nullptr || *Version != RVMAPI_CURRENT_INTERFACE_VERSION)
+    failWithError("Reference model " + Path +
+                  " has an incompatible RVM interface version");
+  VTable = static_cast<const rvm::RVM_FunctionPointers *>(
+      dlsym(Handle, "RVMVTable"));
+  if (VTable == nullptr)
+    failWithError("Reference model " + Path + " does not export RVMVTable");
+  // The extensions of another version are not used, RVMVTable is enough
+  ExtVTable = static_cast<const rvm::RVMExt_FunctionPointers *>(
+      dlsym(Handle, "RVMExtVTable"));
+  if (ExtVTable != nullptr &&
+      (ExtVTable->Version != RVMEXT_CURRENT_VERSION ||
+       ExtVTable->Size != sizeof(rvm::RVMExt_FunctionPointers)))
+    ExtVTable = nullptr;
+
+  // The reference is configured like rvdash: RV32I and one RAM region
+  Config.RamStart = RamStart;
+  Config.RamSize = RamSize;
+  Config.RomStart = RamStart;
+  Config.RomSize = 0;
+  Config.RV64 = 0;
+  Config.MisaExt = RVM_MISA_I;
+  // The trace of rvdash is enough, the empty path would be stdout
+  Config.LogFilePath = "/dev/null";
+  Config.PluginInfo = "";
+  State = VTable->modelCreate(&Config);
+  if (State == nullptr)
+    failWithError("Reference model " + Path + " was not created");
+}
+
+ReferenceModel::~ReferenceModel() {
+  if (State != nullptr)
+    VTable->modelDestroy(State);
+  if (Handle != nullptr)
+    dlclose(Handle);
+}
+
+} // namespace rvdash
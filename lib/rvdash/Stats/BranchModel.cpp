@@ -0,0 +1,154 @@
+#include "rvdash/Stats/BranchModel.h"
+#include "Error.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace rvdash {
+
+BranchModel::BranchModel(const std::vector<std::string> &Names,
+                         uint64_t StartPc)
+    : PrevPc(StartPc) {
+  for (auto &Name : Names) {
+    if (Name == "btb") {
+      Targets.emplace();
+      continue;
+    }
+    auto Predictor = createBranchPredictor(Name);
+    if (Predictor == nullptr)
+      failWithError("Unknown branch predictor " + Name +
+                    " (expected static, bimodal, gshare, tage or btb)");
+    Predictors.push_back(std::move(Predictor));
+  }
+  TotalMisses.resize(Predictors.size() + 1);
+}
+
+BranchModel::BranchStats &BranchModel::getStats(uint64_t Pc) {
+  auto &Stats = Branches[Pc];
+  if (Stats.Misses.empty())
+    Stats.Misses.resize(Predictors.size() + 1);
+  return Stats;
+}
+
+void BranchModel::countMiss(BranchStats *Stats, size_t Idx) {
+  if (Stats == nullptr)
+    return;
+  ++Stats->Misses[Idx];
+  ++TotalMisses[Idx];
+}
+
+void BranchModel::observeBranch(uint32_t Instr, uint64_t Pc, uint64_t NextPc) {
+  // imm[12:1] of the B-type encoding
+  uint32_t Imm = ((Instr >> 8) & 0xf) << 1 | ((Instr >> 25) & 0x3f) << 5 |
+                 ((Instr >> 7) & 0x1) << 11 | ((Instr >> 31) & 0x1) << 12;
+  uint64_t Target = Pc + (static_cast<int32_t>(Imm << 19) >> 19);
+  bool Taken = NextPc != Pc + 4;
+  auto *Stats = Counting ? &getStats(Pc) : nullptr;
+  if (Stats != nullptr) {
+    ++Stats->Execs;
+    Stats->Taken += Taken;
+  }
+  // Without direction predictors the pipeline fetches the fall-through path
+  LastMispredicted = Predictors.empty() && Taken;
+  for (size_t Idx = 0; Idx < Predictors.size(); ++Idx) {
+    auto &Predictor = *Predictors[Idx];
+    if (Predictor.predict(Pc, Target) != Taken) {
+      countMiss(Stats, Idx);
+      LastMispredicted |= Idx == 0;
+    }
+    Predictor.update(Pc, Target, Taken);
+  }
+  if (Taken && Targets.has_value() &&
+      !Targets->predictAndUpdate(Pc, NextPc, /* IsCall */ false,
+                                 /* IsReturn */ false)) {
+    countMiss(Stats, Predictors.size());
+    LastMispredicted = true;
+  }
+}
+
+void BranchModel::observeJump(uint32_t Instr, uint64_t Pc, uint64_t NextPc) {
+  // Without the BTB the target of a jump is known only in EX
+  if (!Targets.has_value()) {
+    LastMispredicted = true;
+    return;
+  }
+  unsigned Rd = (Instr >> 7) & 0x1f;
+  unsigned Rs1 = (Instr >> 15) & 0x1f;
+  bool IsJalr = (Instr & 0x7f) == JALR_OPCODE;
+  bool IsReturn = IsJalr && Rd == 0 && isLinkReg(Rs1);
+  auto *Stats = Counting ? &getStats(Pc) : nullptr;
+  if (Stats != nullptr) {
+    ++Stats->Execs;
+    ++Stats->Taken;
+  }
+  if (!Targets->predictAndUpdate(Pc, NextPc, isLinkReg(Rd), IsReturn)) {
+    countMiss(Stats, Predictors.size());
+    LastMispredicted = true;
+  }
+}
+
+void BranchModel::report(std::ostream &Stream, const SymbolTable &Symbols,
+                         size_t MaxLines) const {
+  auto OldFlags = Stream.flags();
+  auto OldPrecision = Stream.precision();
+  Stream << std::fixed << std::setprecision(3);
+  Stream << "==================rvdash branches===================\n";
+  Stream << "Instructions: " << Instrs << "\n";
+  std::vector<std::string> Names;
+  for (auto &Predictor : Predictors)
+    Names.push_back(Predictor->getName());
+  Names.push_back("btb+ras");
+  for (size_t Idx = 0; Idx < Names.size(); ++Idx) {
+    if (Idx == Predictors.size() && !Targets.has_value())
+      break;
+    Stream << std::left << std::setw(10) << Names[Idx] << std::right
+           << " mispredictions " << std::setw(12) << TotalMisses[Idx]
+           << "  MPKI "
+           << (Instrs == 0 ? 0.0 : 1000.0 * TotalMisses[Idx] / Instrs)
+           << "\n";
+  }
+
+  // The branches with the most mispredictions of any predictor
+  std::vector<std::pair<uint64_t, const BranchStats *>> Sorted;
+  for (auto &[Pc, Stats] : Branches)
+    Sorted.emplace_back(Pc, &Stats);
+  auto MaxMisses = [](const BranchStats &Stats) {
+    return *std::max_element(Stats.Misses.begin(), Stats.Misses.end());
+  };
+  std::sort(Sorted.begin(), Sorted.end(),
+            [&](const auto &Lhs, const auto &Rhs) {
+              if (MaxMisses(*Lhs.second) != MaxMisses(*Rhs.second))
+                return MaxMisses(*Lhs.second) > MaxMisses(*Rhs.second);
+              return Lhs.first < Rhs.first;
+            });
+  if (!Sorted.empty()) {
+    Stream << "Branches:\n";
+    Stream << "  " << std::left << std::setw(10) << "pc" << std::right
+           << std::setw(12) << "execs" << std::setw(12) << "taken";
+    for (size_t Idx = 0; Idx < Predictors.size(); ++Idx)
+      Stream << std::setw(12) << Names[Idx];
+    if (Targets.has_value())
+      Stream << std::setw(12) << Names.back();
+    Stream << "\n";
+  }
+  for (size_t Line = 0; Line < Sorted.size() && Line < MaxLines; ++Line) {
+    auto &[Pc, Stats] = Sorted[Line];
+    std::ostringstream PcStr;
+    PcStr << "0x" << std::hex << std::setw(8) << std::setfill('0') << Pc;
+    Stream << "  " << std::left << std::setw(10) << PcStr.str() << std::right
+           << std::setw(12) << Stats->Execs << std::setw(12) << Stats->Taken;
+    for (size_t Idx = 0; Idx < Predictors.size(); ++Idx)
+      Stream << std::setw(12) << Stats->Misses[Idx];
+    if (Targets.has_value())
+      Stream << std::setw(12) << Stats->Misses.back();
+    if (!Symbols.empty())
+      Stream << "  " << Symbols.symbolize(Pc);
+    Stream << "\n";
+  }
+  Stream << "====================================================\n";
+  Stream.flags(OldFlags);
+  Stream.precision(OldPrecision);
+}
+
+} // namespace rvdash
@@ -0,0 +1,145 @@
+#include "rvdash/Stats/BranchPredictors.h"
+
+namespace rvdash {
+
+namespace {
+
+void updateCounter(uint8_t &Ctr, bool Taken, uint8_t Max) {
+  if (Taken && Ctr < Max)
+    ++Ctr;
+  else if (!Taken && Ctr > 0)
+    --Ctr;
+}
+
+} // namespace
+
+std::unique_ptr<BranchPredictor>
+createBranchPredictor(const std::string &Name) {
+  if (Name == "static")
+    return std::make_unique<StaticPredictor>();
+  if (Name == "bimodal")
+    return std::make_unique<BimodalPredictor>();
+  if (Name == "gshare")
+    return std::make_unique<GsharePredictor>();
+  if (Name == "tage")
+    return std::make_unique<TagePredictor>();
+  return nullptr;
+}
+
+//---------------------------------BimodalPredictor--------------------------------------
+
+bool BimodalPredictor::predict(uint64_t Pc, uint64_t Target) {
+  return Counters[(Pc >> 2) & (Counters.size() - 1)] >= 2;
+}
+
+void BimodalPredictor::update(uint64_t Pc, uint64_t Target, bool Taken) {
+  updateCounter(Counters[(Pc >> 2) & (Counters.size() - 1)], Taken,
+                /* Max */ 3);
+}
+
+//----------------------------------GsharePredictor--------------------------------------
+
+bool GsharePredictor::predict(uint64_t Pc, uint64_t Target) {
+  return Counters[getIdx(Pc)] >= 2;
+}
+
+void GsharePredictor::update(uint64_t Pc, uint64_t Target, bool Taken) {
+  updateCounter(Counters[getIdx(Pc)], Taken, /* Max */ 3);
+  History = ((History << 1) | Taken) & ((1ull << HistoryBits) - 1);
+}
+
+//-----------------------------------TagePredictor---------------------------------------
+
+TagePredictor::TagePredictor() {
+  for (auto &Table : Tables)
+    Table.resize(1u << IdxBits);
+}
+
+uint64_t TagePredictor::fold(uint64_t Hist, unsigned Len, unsigned Bits) {
+  if (Len < 64)
+    Hist &= (1ull << Len) - 1;
+  uint64_t Result = 0;
+  for (; Hist != 0; Hist >>= Bits)
+    Result ^= Hist & ((1ull << Bits) - 1);
+  return Result;
+}
+
+bool TagePredictor::predict(uint64_t Pc, uint64_t Target) {
+  Provider.reset();
+  std::optional<unsigned> Alt;
+  for (unsigned Idx = 0; Idx < NumTables; ++Idx) {
+    auto Len = HistLens[Idx];
+    Idxs[Idx] = ((Pc >> 2) ^ (Pc >> (2 + IdxBits)) ^
+                 fold(History, Len, IdxBits)) &
+                ((1u << IdxBits) - 1);
+    Tags[Idx] = ((Pc >> 2) ^ fold(History, Len, TagBits) ^
+                 (fold(History, Len, TagBits - 1) << 1)) &
+                ((1u << TagBits) - 1);
+    if (Tables[Idx][Idxs[Idx]].Tag == Tags[Idx]) {
+      Alt = Provider;
+      Provider = Idx;
+    }
+  }
+  bool BasePred = Base.predict(Pc, Target);
+  AltPred = Alt.has_value() ? Tables[*Alt][Idxs[*Alt]].Ctr >= 4 : BasePred;
+  if (!Provider.has_value())
+    return BasePred;
+  ProviderPred = Tables[*Provider][Idxs[*Provider]].Ctr >= 4;
+  return ProviderPred;
+}
+
+void TagePredictor::update(uint64_t Pc, uint64_t Target, bool Taken) {
+  bool Pred = Provider.has_value() ? ProviderPred : AltPred;
+  if (Provider.has_value()) {
+    auto &Elem = Tables[*Provider][Idxs[*Provider]];
+    updateCounter(Elem.Ctr, Taken, /* Max */ 7);
+    if (ProviderPred != AltPred)
+      updateCounter(Elem.Useful, ProviderPred == Taken, /* Max */ 3);
+  } else {
+    Base.update(Pc, Target, Taken);
+  }
+
+  // A misprediction allocates an entry in a longer table
+  unsigned First = Provider.has_value() ? *Provider + 1 : 0;
+  if (Pred != Taken && First < NumTables) {
+    bool Allocated = false;
+    for (auto Idx = First; Idx < NumTables && !Allocated; ++Idx) {
+      auto &Elem = Tables[Idx][Idxs[Idx]];
+      if (Elem.Useful == 0) {
+        Elem = {Tags[Idx], static_cast<uint8_t>(Taken ? 4 : 3), 0};
+        Allocated = true;
+      }
+    }
+    if (!Allocated)
+      for (auto Idx = First; Idx < NumTables; ++Idx)
+        updateCounter(Tables[Idx][Idxs[Idx]].Useful, false, /* Max */ 3);
+  }
+
+  if (++Updates % ResetPeriod == 0)
+    for (auto &Table : Tables)
+      for (auto &Elem : Table)
+        Elem.Useful >>= 1;
+  History = (History << 1) | Taken;
+}
+
+//-----------------------------------TargetPredictor-------------------------------------
+
+bool TargetPredictor::predictAndUpdate(uint64_t Pc, uint64_t Target,
+                                       bool IsCall, bool IsReturn) {
+  bool Hit;
+  if (IsReturn) {
+    RasTop = (RasTop + Ras.size() - 1) % Ras.size();
+    Hit = Ras[RasTop] == Target;
+  } else {
+    auto &Entry = Btb[(Pc >> 2) & (Btb.size() - 1)];
+    Hit = Entry.Pc == Pc && Entry.Target == Target;
+    Entry = {Pc, Target};
+  }
+  if (IsCall) {
+    Ras[RasTop] = Pc + 4;
+    RasTop = (RasTop + 1) % Ras.size();
+  }
+  return Hit;
+}
+
+} // namespace rvdash
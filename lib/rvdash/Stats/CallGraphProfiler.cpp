@@ -0,0 +1,47 @@
+#include "rvdash/Stats/CallGraphProfiler.h"
+
+#include <string>
+
+namespace rvdash {
+
+void CallGraphProfiler::call(uint64_t Target, uint64_t RetAddr) {
+  auto &Children = Nodes[Current].Children;
+  for (auto &[Func, Idx] : Children)
+    if (Func == Target) {
+      Current = Idx;
+      Nodes[Current].RetAddr = RetAddr;
+      return;
+    }
+  unsigned NewIdx = Nodes.size();
+  Children.emplace_back(Target, NewIdx);
+  Nodes.push_back({Target, Current});
+  Current = NewIdx;
+  Nodes[Current].RetAddr = RetAddr;
+}
+
+void CallGraphProfiler::ret(uint64_t Target) {
+  // Usually it is the return from the current function, but frames can be
+  // skipped by longjmp-like code. A return to an address that is not on the
+  // shadow stack is a jump, the stack stays the same.
+  for (auto Idx = Current; Idx != 0; Idx = Nodes[Idx].Parent)
+    if (Nodes[Idx].RetAddr == Target) {
+      Current = Nodes[Idx].Parent;
+      return;
+    }
+}
+
+void CallGraphProfiler::writeFolded(std::ostream &Stream,
+                                    const SymbolTable &Symbols) const {
+  // Nodes are created after their parents, so the stack names can be built
+  // in one pass
+  std::vector<std::string> Stacks(Nodes.size());
+  for (unsigned Idx = 0; Idx < Nodes.size(); ++Idx) {
+    auto &Elem = Nodes[Idx];
+    auto Name = Symbols.symbolize(Elem.Func);
+    Stacks[Idx] = Idx == 0 ? Name : Stacks[Elem.Parent] + ";" + Name;
+    if (Elem.Self != 0)
+      Stream << Stacks[Idx] << " " << Elem.Self << "\n";
+  }
+}
+
+} // namespace rvdash
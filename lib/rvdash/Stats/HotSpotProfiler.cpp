@@ -0,0 +1,72 @@
+#include "rvdash/Stats/HotSpotProfiler.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace rvdash {
+
+namespace {
+
+template <typename KeyType>
+std::vector<std::pair<KeyType, uint64_t>>
+sortByCount(const std::unordered_map<KeyType, uint64_t> &Counts) {
+  std::vector<std::pair<KeyType, uint64_t>> Sorted(Counts.begin(),
+                                                   Counts.end());
+  // Equal counts are ordered by the key, so the report is reproducible
+  std::sort(Sorted.begin(), Sorted.end(),
+            [](const auto &Lhs, const auto &Rhs) {
+              if (Lhs.second != Rhs.second)
+                return Lhs.second > Rhs.second;
+              return Lhs.first < Rhs.first;
+            });
+  return Sorted;
+}
+
+void printLine(std::ostream &Stream, uint64_t Count, uint64_t Samples,
+               const std::string &Where) {
+  Stream << std::right << std::setw(14) << Count << std::setw(9)
+         << 100.0 * Count / Samples << "%  " << Where << "\n";
+}
+
+} // namespace
+
+void HotSpotProfiler::report(std::ostream &Stream, const SymbolTable &Symbols,
+                             size_t MaxLines) const {
+  auto OldFlags = Stream.flags();
+  auto OldPrecision = Stream.precision();
+  Stream << std::fixed << std::setprecision(2);
+  Stream << "===================rvdash profile===================\n";
+  Stream << "Samples: " << Samples << " (every " << Interval
+         << " instructions)\n";
+  if (Samples != 0 && !Symbols.empty()) {
+    std::unordered_map<std::string, uint64_t> FuncCounts;
+    for (auto &[Pc, Count] : PcCounts) {
+      auto *Sym = Symbols.lookup(Pc);
+      FuncCounts[Sym == nullptr ? "[unknown]" : Sym->Name] += Count;
+    }
+    Stream << "Functions:\n";
+    auto Sorted = sortByCount(FuncCounts);
+    for (size_t Idx = 0; Idx < Sorted.size() && Idx < MaxLines; ++Idx)
+      printLine(Stream, Sorted[Idx].second, Samples, Sorted[Idx].first);
+  }
+  if (Samples != 0) {
+    Stream << "PCs:\n";
+    auto Sorted = sortByCount(PcCounts);
+    for (size_t Idx = 0; Idx < Sorted.size() && Idx < MaxLines; ++Idx) {
+      auto Pc = Sorted[Idx].first;
+      std::ostringstream Where;
+      Where << "0x" << std::hex << std::setw(8) << std::setfill('0') << Pc;
+      if (!Symbols.empty())
+        Where << "  " << Symbols.symbolize(Pc);
+      printLine(Stream, Sorted[Idx].second, Samples, Where.str());
+    }
+  }
+  Stream << "====================================================\n";
+  Stream.flags(OldFlags);
+  Stream.precision(OldPrecision);
+}
+
+} // namespace rvdash
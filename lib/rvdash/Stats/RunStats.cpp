@@ -0,0 +1,122 @@
+#include "rvdash/Stats/RunStats.h"
+
+#include <algorithm>
+#include <iomanip>
+
+namespace rvdash {
+
+namespace {
+
+template <typename CacheStatsType>
+double getHitRate(const CacheStatsType &Cache) /* percent */ {
+  if (Cache.Accesses == 0)
+    return 0;
+  return 100.0 * (Cache.Accesses - Cache.Misses) / Cache.Accesses;
+}
+
+} // namespace
+
+RunStats::RunStats()
+    : WallStart(std::chrono::steady_clock::now()), CpuStart(std::clock()) {}
+
+void RunStats::finish(uint64_t Instret, uint64_t SimulatedInstrs,
+                      uint64_t Pages, uint64_t PageBytes, bool IsSampled) {
+  WallTime = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                           WallStart)
+                 .count();
+  CpuTime = static_cast<double>(std::clock() - CpuStart) / CLOCKS_PER_SEC;
+  InstrRet = Instret;
+  Simulated = SimulatedInstrs;
+  Sampled = IsSampled;
+  PagesTouched = Pages;
+  PageSz = PageBytes;
+  // The mix is added in the order of a hash map, the ties are broken by the
+  // mnemonic so that the report does not depend on it
+  std::sort(Mix.begin(), Mix.end(), [](const auto &Lhs, const auto &Rhs) {
+    if (Lhs.second != Rhs.second)
+      return Lhs.second > Rhs.second;
+    return Lhs.first < Rhs.first;
+  });
+}
+
+void RunStats::addInstr(const std::string &Mnemonic, uint64_t Count) {
+  auto It = std::find_if(Mix.begin(), Mix.end(), [&](const auto &Elem) {
+    return Elem.first == Mnemonic;
+  });
+  if (It == Mix.end())
+    Mix.emplace_back(Mnemonic, Count);
+  else
+    It->second += Count;
+}
+
+void RunStats::addCache(const std::string &Name, const CacheModel &Cache) {
+  Caches.push_back(
+      {Name, Cache.getAccesses(), Cache.getMisses(), Cache.Writebacks});
+}
+
+double RunStats::getMIPS() const {
+  if (WallTime == 0)
+    return 0;
+  return Simulated / WallTime / 1e6;
+}
+
+void RunStats::printText(std::ostream &Stream) const {
+  auto OldFlags = Stream.flags();
+  auto OldPrecision = Stream.precision();
+  Stream << std::fixed << std::setprecision(3);
+  Stream << "====================rvdash stats====================\n";
+  Stream << "Instructions:     " << InstrRet << "\n";
+  if (Sampled)
+    Stream << "Simulated:        " << Simulated << " (sampled)\n";
+  Stream << "Wall time:        " << WallTime << " s\n";
+  Stream << "CPU time:         " << CpuTime << " s\n";
+  Stream << "MIPS:             " << getMIPS() << "\n";
+  Stream << "Pages touched:    " << PagesTouched << " (" << PageSz
+         << " bytes each)\n";
+  if (!Mix.empty())
+    Stream << "Instruction mix:\n";
+  for (auto &[Mnemonic, Count] : Mix)
+    Stream << "  " << std::left << std::setw(10) << Mnemonic << std::right
+           << std::setw(14) << Count << std::setw(9)
+           << (InstrRet == 0 ? 0.0 : 100.0 * Count / InstrRet) << "%\n";
+  for (auto &Cache : Caches)
+    Stream << "Cache " << Cache.Name << " hit rate: " << getHitRate(Cache)
+           << "% (" << Cache.Misses << " misses, " << Cache.Writebacks
+           << " writebacks)\n";
+  Stream << "====================================================\n";
+  Stream.flags(OldFlags);
+  Stream.precision(OldPrecision);
+}
+
+void RunStats::printJSON(std::ostream &Stream) const {
+  auto OldFlags = Stream.flags();
+  auto OldPrecision = Stream.precision();
+  Stream << std::fixed << std::setprecision(6);
+  Stream << "{\n";
+  Stream << "  \"instructions\": " << InstrRet << ",\n";
+  Stream << "  \"simulated_instructions\": " << Simulated << ",\n";
+  Stream << "  \"wall_time_s\": " << WallTime << ",\n";
+  Stream << "  \"cpu_time_s\": " << CpuTime << ",\n";
+  Stream << "  \"mips\": " << getMIPS() << ",\n";
+  Stream << "  \"pages_touched\": " << PagesTouched << ",\n";
+  Stream << "  \"page_size\": " << PageSz << ",\n";
+  Stream << "  \"instruction_mix\": {";
+  // Mnemonics are C identifiers, so they need no escaping
+  for (size_t Idx = 0; Idx < Mix.size(); ++Idx)
+    Stream << (Idx == 0 ? "\n" : ",\n") << "    \"" << Mix[Idx].first
+           << "\": " << Mix[Idx].second;
+  Stream << (Mix.empty() ? "}" : "\n  }");
+  Stream << ",\n  \"caches\": {";
+  for (size_t Idx = 0; Idx < Caches.size(); ++Idx)
+    Stream << (Idx == 0 ? "\n" : ",\n") << "    \"" << Caches[Idx].Name
+           << "\": {\"accesses\": " << Caches[Idx].Accesses
+           << ", \"misses\": " << Caches[Idx].Misses
+           << ", \"writebacks\": " << Caches[Idx].Writebacks
+           << ", \"hit_rate\": " << getHitRate(Caches[Idx]) / 100 << "}";
+  Stream << (Caches.empty() ? "}\n" : "\n  }\n");
+  Stream << "}\n";
+  Stream.flags(OldFlags);
+  Stream.precision(OldPrecision);
+}
+
+} // namespace rvdash
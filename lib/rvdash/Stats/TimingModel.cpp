@@ -0,0 +1,130 @@
+#include "rvdash/Stats/TimingModel.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+namespace rvdash {
+
+namespace {
+
+enum Opcode {
+  OP = 0b0110011,
+  OP_IMM = 0b0010011,
+  LOAD = 0b0000011,
+  STORE = 0b0100011,
+  BRANCH = 0b1100011,
+  JAL = 0b1101111,
+  JALR = 0b1100111,
+  SYSTEM = 0b1110011,
+};
+
+} // namespace
+
+void TimingModel::afterStep(uint32_t Instr, uint64_t NextPc, unsigned IMisses,
+                            unsigned DMisses,
+                            std::optional<bool> Mispredicted) {
+  auto Op = Instr & 0x7f;
+  unsigned Rd = (Instr >> 7) & 0x1f;
+  unsigned Rs1 = (Instr >> 15) & 0x1f;
+  unsigned Rs2 = (Instr >> 20) & 0x1f;
+  unsigned Funct3 = (Instr >> 12) & 0x7;
+  bool UsesRs1 = Op == OP || Op == OP_IMM || Op == LOAD || Op == STORE ||
+                 Op == BRANCH || Op == JALR || (Op == SYSTEM && Funct3 < 4);
+  bool UsesRs2 = Op == OP || Op == STORE || Op == BRANCH;
+
+  auto Start = Cycle;
+  // One instruction per cycle, a fetch miss stalls the front end
+  auto Issue = Cycle + 1 + uint64_t(IMisses) * Config.MissPenalty;
+  ICacheStalls += Issue - Cycle - 1;
+  uint64_t Operands =
+      std::max(UsesRs1 ? Ready[Rs1] : 0, UsesRs2 ? Ready[Rs2] : 0);
+  if (Operands > Issue) {
+    // The producer is a load or a mul/div, ALU results are forwarded
+    bool AfterLoad = (UsesRs1 && Ready[Rs1] == Operands && FromLoad[Rs1]) ||
+                     (UsesRs2 && Ready[Rs2] == Operands && FromLoad[Rs2]);
+    (AfterLoad ? LoadUseStalls : MulDivStalls) += Operands - Issue;
+    Issue = Operands;
+  }
+
+  unsigned Latency = 1;
+  bool IsMulDiv = Op == OP && (Instr >> 25) == 0b0000001;
+  if (Op == LOAD)
+    Latency = Config.LoadLatency;
+  else if (IsMulDiv)
+    Latency = Funct3 < 4 ? Config.MulLatency : Config.DivLatency;
+  // Data cache misses stall the pipeline in MEM
+  if (Op == LOAD || Op == STORE) {
+    auto Stall = uint64_t(DMisses) * Config.MissPenalty;
+    DCacheStalls += Stall;
+    Issue += Stall;
+  }
+  if (Rd != 0 && Op != STORE && Op != BRANCH) {
+    Ready[Rd] = Issue + Latency;
+    FromLoad[Rd] = Op == LOAD;
+  }
+
+  bool IsTransfer = Op == BRANCH || Op == JAL || Op == JALR;
+  bool Taken = NextPc != PrevPc + 4;
+  if (IsTransfer && Mispredicted.value_or(Taken)) {
+    BranchStalls += Config.BranchPenalty;
+    Issue += Config.BranchPenalty;
+  }
+  Cycle = Issue;
+  ++Instrs;
+  if (ByPc) {
+    auto &[Count, Cycles] = PcCycles[PrevPc];
+    ++Count;
+    Cycles += Cycle - Start;
+  }
+  PrevPc = NextPc;
+}
+
+void TimingModel::report(std::ostream &Stream, const SymbolTable &Symbols,
+                         size_t MaxLines) const {
+  auto OldFlags = Stream.flags();
+  auto OldPrecision = Stream.precision();
+  Stream << std::fixed << std::setprecision(3);
+  Stream << "===================rvdash timing====================\n";
+  Stream << "Instructions:      " << Instrs << "\n";
+  Stream << "Cycles:            " << getCycles() << "\n";
+  Stream << "CPI:               "
+         << (Instrs == 0 ? 0.0 : double(getCycles()) / Instrs) << "\n";
+  Stream << "Stalls: load-use " << LoadUseStalls << ", mul/div "
+         << MulDivStalls << ", branch " << BranchStalls << ", i-cache "
+         << ICacheStalls << ", d-cache " << DCacheStalls << "\n";
+  if (ByPc && !Symbols.empty()) {
+    std::unordered_map<std::string, std::pair<uint64_t, uint64_t>> Funcs;
+    for (auto &[Pc, Counts] : PcCycles) {
+      auto *Sym = Symbols.lookup(Pc);
+      auto &Func = Funcs[Sym == nullptr ? "[unknown]" : Sym->Name];
+      Func.first += Counts.first;
+      Func.second += Counts.second;
+    }
+    std::vector<std::pair<std::string, std::pair<uint64_t, uint64_t>>> Sorted(
+        Funcs.begin(), Funcs.end());
+    std::sort(Sorted.begin(), Sorted.end(),
+              [](const auto &Lhs, const auto &Rhs) {
+                if (Lhs.second.second != Rhs.second.second)
+                  return Lhs.second.second > Rhs.second.second;
+                return Lhs.first < Rhs.first;
+              });
+    Stream << "Functions:\n";
+    Stream << "  " << std::left << std::setw(24) << "function" << std::right
+           << std::setw(14) << "instructions" << std::setw(14) << "cycles"
+           << std::setw(9) << "CPI" << "\n";
+    for (size_t Idx = 0; Idx < Sorted.size() && Idx < MaxLines; ++Idx) {
+      auto &[Name, Counts] = Sorted[Idx];
+      Stream << "  " << std::left << std::setw(24) << Name << std::right
+             << std::setw(14) << Counts.first << std::setw(14)
+             << Counts.second << std::setw(9)
+             << double(Counts.second) / Counts.first << "\n";
+    }
+  }
+  Stream << "====================================================\n";
+  Stream.flags(OldFlags);
+  Stream.precision(OldPrecision);
+}
+
+} // namespace rvdash
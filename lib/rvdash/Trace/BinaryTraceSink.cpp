@@ -0,0 +1,65 @@
+#include "rvdash/Trace/BinaryTraceSink.h"
+#include "Error.h"
+
+#include <chrono>
+
+namespace rvdash {
+
+BinaryTraceSink::BinaryTraceSink(const std::string &Path)
+    : File(std::fopen(Path.c_str(), "wb")) {
+  if (File == nullptr)
+    failWithError("Can't open trace file " + Path);
+  TraceFileHeader Header;
+  std::fwrite(&Header, sizeof(Header), 1, File);
+  Writer = std::thread(&BinaryTraceSink::writeLoop, this);
+}
+
+BinaryTraceSink::~BinaryTraceSink() {
+  if (InInstr)
+    push(Current);
+  Done.store(true, std::memory_order_release);
+  Writer.join();
+  std::fclose(File);
+}
+
+/**
+ * @brief writeLoop - body of the writer thread. It sleeps a little when the
+ *                    buffer is empty and finishes when the sink is destroyed
+ *                    and everything is written.
+ */
+void BinaryTraceSink::writeLoop() {
+  auto Write = [this](const TraceRecord *Records, size_t Count) {
+    std::fwrite(Records, sizeof(TraceRecord), Count, File);
+  };
+  while (true) {
+    bool Finishing = Done.load(std::memory_order_acquire);
+    if (Buffer.drain(Write) != 0)
+      continue;
+    if (Finishing)
+      break;
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+  std::fflush(File);
+}
+
+void BinaryTraceSink::beginSimulation() {
+  TraceRecord Record;
+  Record.Flags = TraceRecord::SimulationBegin;
+  push(Record);
+}
+
+void BinaryTraceSink::endSimulation() {
+  if (InInstr)
+    push(Current);
+  InInstr = false;
+  TraceRecord Record;
+  Record.Flags = TraceRecord::SimulationEnd;
+  push(Record);
+}
+
+void BinaryTraceSink::flush() {
+  while (!Buffer.empty())
+    std::this_thread::yield();
+}
+
+} // namespace rvdash
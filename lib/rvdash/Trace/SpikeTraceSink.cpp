@@ -0,0 +1,130 @@
+#include "rvdash/Trace/SpikeTraceSink.h"
+
+#include "rvdash/InstructionSet/Zicsr/InstructionSet.h"
+
+#include <cctype>
+
+namespace rvdash {
+
+using namespace TraceFormat;
+
+/**
+ * @brief getCSRName - the name of Csr in DefineCSRs.h or of a machine
+ *                     counter, nullptr for the other CSRs (none of them can
+ *                     be written).
+ */
+static const char *getCSRName(unsigned Csr) {
+  switch (Csr) {
+  case Zicsr::CSR_MCYCLE:
+    return "MCYCLE";
+  case Zicsr::CSR_MINSTRET:
+    return "MINSTRET";
+  case Zicsr::CSR_MCYCLEH:
+    return "MCYCLEH";
+  case Zicsr::CSR_MINSTRETH:
+    return "MINSTRETH";
+#define ADD_CSR(Name, Addr, WriteMask, ResetValue)                             \
+  case Addr:                                                                   \
+    return #Name;
+#include "rvdash/InstructionSet/Machine/DefineCSRs.h"
+#undef ADD_CSR
+  default:
+    return nullptr;
+  }
+}
+
+/**
+ * @brief getTrapName - the name of the trap in the exception line of Spike.
+ */
+static const char *getTrapName(TrapCause Cause) {
+  switch (Cause) {
+  case TrapCause::InstrAddrMisaligned:
+    return "instruction_address_misaligned";
+  case TrapCause::InstrAccessFault:
+    return "instruction_access_fault";
+  case TrapCause::IllegalInstr:
+    return "illegal_instruction";
+  case TrapCause::LoadAccessFault:
+    return "load_access_fault";
+  case TrapCause::StoreAccessFault:
+    return "store_access_fault";
+  case TrapCause::EcallFromM:
+    return "machine_ecall";
+  }
+  return "unknown_trap";
+}
+
+void SpikeTraceSink::writeBuffer() {
+  LogFile.write(Buffer.get(), Pos - Buffer.get());
+  Pos = Buffer.get();
+}
+
+/**
+ * @brief putTrap - the exception lines of Spike, the ecall has no tval line:
+ *
+ *          core   0: exception illegal_instruction, epc 0x00000018
+ *          core   0:           tval 0xffffffff
+ */
+char *SpikeTraceSink::putTrap(char *Out) const {
+  Out = putStr(Out, "core   0: exception ");
+  const char *Name = getTrapName(Cause);
+  Out = putStr(Out, Name, std::strlen(Name));
+  Out = putStr(Out, ", epc 0x");
+  Out = putHexPadded(Out, Pc, XLenDigits);
+  Out = putStr(Out, "\n");
+  if (Cause == TrapCause::EcallFromM)
+    return Out;
+  Out = putStr(Out, "core   0:           tval 0x");
+  Out = putHexPadded(Out, Tval, XLenDigits);
+  return putStr(Out, "\n");
+}
+
+void SpikeTraceSink::endInstr() {
+  if (Pos + MaxLineSz > Buffer.get() + BufferSz)
+    writeBuffer();
+  if (HasTrap) {
+    Pos = putTrap(Pos);
+    return;
+  }
+  char *Out = putStr(Pos, "core   0: ");
+  Out = putDec(Out, PrivLevel);
+  Out = putStr(Out, " 0x");
+  Out = putHexPadded(Out, Pc, XLenDigits);
+  Out = putStr(Out, " (0x");
+  Out = putHexPadded(Out, Instr, /* Digits */ 8);
+  Out = putStr(Out, ")");
+  if (HasRegWrite) {
+    // " x5  0x..." - the register number is left aligned in 2 columns
+    Out = putStr(Out, " x");
+    Out = putDec(Out, Rd);
+    if (Rd < 10)
+      Out = putStr(Out, " ");
+    Out = putStr(Out, " 0x");
+    Out = putHexPadded(Out, RdValue, XLenDigits);
+  }
+  if (HasCSRWrite) {
+    // " c773_mtvec 0x...", the number is decimal, the name is in lowercase
+    Out = putStr(Out, " c");
+    Out = putDec(Out, Csr);
+    if (const char *Name = getCSRName(Csr)) {
+      *Out++ = '_';
+      for (; *Name != '\0'; ++Name)
+        *Out++ = std::tolower(*Name);
+    }
+    Out = putStr(Out, " 0x");
+    Out = putHexPadded(Out, CsrValue, XLenDigits);
+  }
+  if (HasMemRead) {
+    Out = putStr(Out, " mem 0x");
+    Out = putHexPadded(Out, ReadAddr, XLenDigits);
+  }
+  if (HasMemWrite) {
+    Out = putStr(Out, " mem 0x");
+    Out = putHexPadded(Out, WriteAddr, XLenDigits);
+    Out = putStr(Out, " 0x");
+    Out = putHexPadded(Out, WriteValue, MemSize * 2);
+  }
+  Pos = putStr(Out, "\n");
+}
+
+} // namespace rvdash
@@ -0,0 +1,113 @@
+#include "rvdash/Trace/TextTraceSink.h"
+#include "rvdash/InstructionSet/Disassembler.h"
+#include "rvdash/InstructionSet/Syscalls.h"
+
+#include <algorithm>
+#include <iterator>
+#include <string_view>
+
+namespace rvdash {
+
+using namespace TraceFormat;
+
+void TextTraceSink::writeBuffer() {
+  LogFile.write(Buffer.get(), Pos - Buffer.get());
+  Pos = Buffer.get();
+}
+
+void TextTraceSink::beginSimulation() {
+  Pos = putStr(reserve(),
+               "====================Simulation started====================\n");
+}
+
+void TextTraceSink::endSimulation() {
+  Pos = putStr(reserve(),
+               "===================Simulation completed===================\n");
+  flush();
+}
+
+void TextTraceSink::beginInstr(uint64_t Pc, uint32_t Instr) {
+  Pos = disassemble(reserve(), Instr);
+}
+
+void TextTraceSink::regWrite(unsigned RegIdx, uint64_t Value) {
+  char *Out = putXReg(reserve(), RegIdx);
+  Out = putStr(Out, " <- 0x");
+  Out = putHex(Out, Value);
+  Pos = putStr(Out, "\n");
+}
+
+void TextTraceSink::pcWrite(uint64_t Value) {
+  char *Out = putStr(reserve(), "pc <- 0x");
+  Out = putHex(Out, Value);
+  Pos = putStr(Out, "\n");
+}
+
+/**
+ * @brief putMemAccess - "<Prefix>[0xAddr, 0xAddr+Size]<Arrow>0xValue\n".
+ */
+static char *putMemAccess(char *Out, const char *Prefix, size_t PrefixLen,
+                          uint64_t Addr, unsigned Size, const char *Arrow,
+                          uint64_t Value) {
+  Out = putStr(Out, Prefix, PrefixLen);
+  Out = putStr(Out, "[0x");
+  Out = putHex(Out, Addr);
+  Out = putStr(Out, ", 0x");
+  Out = putHex(Out, Addr + Size);
+  Out = putStr(Out, "] ");
+  Out = putStr(Out, Arrow, 2);
+  Out = putStr(Out, " 0x");
+  Out = putHex(Out, Value);
+  return putStr(Out, "\n");
+}
+
+void TextTraceSink::memRead(uint64_t Addr, unsigned Size, uint64_t Value) {
+  static constexpr char Prefix[] = "Read memory bytes ";
+  Pos = putMemAccess(reserve(), Prefix, sizeof(Prefix) - 1, Addr, Size, "->",
+                     Value);
+}
+
+void TextTraceSink::memWrite(uint64_t Addr, unsigned Size, uint64_t Value) {
+  static constexpr char Prefix[] = "Changed memory bytes ";
+  Pos = putMemAccess(reserve(), Prefix, sizeof(Prefix) - 1, Addr, Size, "<-",
+                     Value);
+}
+
+void TextTraceSink::syscall(uint64_t SysNum, uint64_t Arg0, uint64_t Arg1,
+                            uint64_t Arg2) {
+  static constexpr struct {
+    uint64_t SysNum;
+    std::string_view Name;
+    unsigned NumArgs;
+  } Syscalls[] = {{OPENAT_SYSCALL, "openat", 3},
+                  {CLOSE_SYSCALL, "close", 1},
+                  {LSEEK_SYSCALL, "lseek", 3},
+                  {READ_SYSCALL, "read", 3},
+                  {WRITE_SYSCALL, "write", 3},
+                  {FSTAT_SYSCALL, "fstat", 2},
+                  {EXIT_SYSCALL, "exit", 1},
+                  {EXIT_GROUP_SYSCALL, "exit_group", 1},
+                  {CLOCK_GETTIME_SYSCALL, "clock_gettime", 2},
+                  {BRK_SYSCALL, "brk", 1}};
+  char *Out = reserve();
+  auto *It = std::find_if(std::begin(Syscalls), std::end(Syscalls),
+                          [SysNum](auto &Elem) { return Elem.SysNum == SysNum; });
+  if (It == std::end(Syscalls)) {
+    Out = putStr(Out, " syscall(");
+    Out = putDec(Out, SysNum);
+    Pos = putStr(Out, ")\n");
+    return;
+  }
+  Out = putStr(Out, " ");
+  Out = putStr(Out, It->Name.data(), It->Name.size());
+  Out = putStr(Out, "(");
+  uint64_t Args[] = {Arg0, Arg1, Arg2};
+  for (unsigned Idx = 0; Idx < It->NumArgs; ++Idx) {
+    if (Idx != 0)
+      Out = putStr(Out, ", ");
+    Out = putDec(Out, Args[Idx]);
+  }
+  Pos = putStr(Out, ")\n");
+}
+
+} // namespace rvdash
@@ -0,0 +1,75 @@
+#include "rvdash/Trace/TraceReader.h"
+#include "Error.h"
+#include "rvdash/InstructionSet/Syscalls.h"
+#include "rvdash/Trace/TraceRecord.h"
+
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace rvdash {
+
+unsigned long long replayTrace(const std::string &Path, TraceSink &Sink) {
+  std::unique_ptr<std::FILE, decltype(&std::fclose)> File(
+      std::fopen(Path.c_str(), "rb"), &std::fclose);
+  if (!File)
+    failWithError("Can't open trace file " + Path);
+
+  TraceFileHeader Header;
+  if (std::fread(&Header, sizeof(Header), 1, File.get()) != 1 ||
+      std::memcmp(Header.Magic, TraceFileHeader::ExpectedMagic,
+                  sizeof(Header.Magic)) != 0)
+    failWithError(Path + " is not a rvdash binary trace");
+  if (Header.Version != TraceFileHeader::CurrentVersion ||
+      Header.RecordSz != sizeof(TraceRecord))
+    failWithError("Unsupported version of binary trace " + Path);
+
+  // Syscall arguments are not stored in the records, they are taken
+  // from the shadow copy of X registers (a0-a2, a7). The ECALL writes the
+  // result to a0, so the syscall goes before the register write, as in the
+  // simulation.
+  std::array<uint64_t, 32> XRegs{};
+  unsigned long long NumInstrs = 0;
+  std::vector<TraceRecord> Records(4096);
+  size_t Count;
+  while ((Count = std::fread(Records.data(), sizeof(TraceRecord),
+                             Records.size(), File.get())) != 0) {
+    for (const auto &Record : std::span(Records.data(), Count)) {
+      if (Record.Flags & TraceRecord::SimulationBegin) {
+        Sink.beginSimulation();
+        continue;
+      }
+      if (Record.Flags & TraceRecord::SimulationEnd) {
+        Sink.endSimulation();
+        continue;
+      }
+      Sink.beginInstr(Record.Pc, Record.Instr);
+      if (Record.Flags & TraceRecord::Syscall)
+        Sink.syscall(XRegs[17], XRegs[10], XRegs[11], XRegs[12]);
+      if (Record.Flags & TraceRecord::MemRead)
+        Sink.memRead(Record.MemAddr, Record.MemSize, Record.MemValue);
+      if (Record.Flags & TraceRecord::RegWrite) {
+        Sink.regWrite(Record.Rd, Record.RdValue);
+        if (Record.Rd != 0)
+          XRegs[Record.Rd] = Record.RdValue;
+      }
+      if (Record.Flags & TraceRecord::PcWrite)
+        Sink.pcWrite(Record.PcValue);
+      if (Record.Flags & TraceRecord::MemWrite)
+        Sink.memWrite(Record.MemAddr, Record.MemSize, Record.MemValue);
+      if (Record.Flags & TraceRecord::CSRWrite)
+        Sink.csrWrite(Record.MemAddr, Record.MemValue);
+      if (Record.Flags & TraceRecord::Trap)
+        Sink.trap(static_cast<TrapCause>(Record.Rd), Record.MemValue);
+      Sink.endInstr();
+      ++NumInstrs;
+    }
+  }
+  Sink.flush();
+  return NumInstrs;
+}
+
+} // namespace rvdash
@@ -1,10 +1,23 @@
 #include "Error.h"
 #include "Memory/Memory.h"
 #include "rvdash/CPU.h"
+#include "rvdash/Checkpoint/Checkpoint.h"
+#include "rvdash/Checkpoint/ReverseExecution.h"
+#include "rvdash/Elf/ElfImage.h"
 #include "rvdash/InstructionSet/InstructionSet.h"
+#include "rvdash/Lockstep/Lockstep.h"
+#include "rvdash/Stats/BranchModel.h"
+#include "rvdash/Stats/CallGraphProfiler.h"
+#include "rvdash/Stats/HotSpotProfiler.h"
+#include "rvdash/Stats/RunStats.h"
+#include "rvdash/Stats/TimingModel.h"
+#include "rvdash/Trace/BinaryTraceSink.h"
+#include "rvdash/Trace/SpikeTraceSink.h"
 
 #include <fstream>
 #include <getopt.h>
+#include <limits>
+#include <sstream>
 
 #define DEBUG
 #undef DEBUG
@@ -15,17 +28,101 @@ static std::optional<const char *> LogFilePath;
 static std::optional<unsigned long long> RamStart;
 static std::optional<unsigned long long> RamSize;
 static std::optional<unsigned long long> Pc;
+enum class TraceKind { Text, Binary, Spike };
+static TraceKind TraceFormatKind = TraceKind::Text;
+static TraceLevel Level = TraceLevel::Full;
+static std::optional<const char *> LockstepModelPath;
+static std::optional<unsigned long long> LockstepInterval;
+static std::optional<unsigned long long> StateHashInterval;
+// Empty path means the text report to stderr
+static std::optional<std::string> StatsPath;
+static std::optional<unsigned long long> ProfileInterval;
+static std::optional<const char *> SymbolsPath;
+static std::optional<const char *> CallGraphPath;
+static std::optional<CacheConfig> ICacheConfig;
+static std::optional<CacheConfig> DCacheConfig;
+static std::vector<std::string> BranchPredictorNames;
+static std::optional<TimingConfig> Timing;
+static std::optional<unsigned long long> CheckpointAt;
+static std::optional<const char *> CheckpointOutPath;
+static std::optional<const char *> RestorePath;
+static std::shared_ptr<const CheckpointFile> Restored;
+static std::shared_ptr<const ElfImage> Elf;
+static std::optional<const char *> RecordPath;
+static std::optional<const char *> ReplayPath;
+static bool SkipOutput = false;
+static std::optional<const char *> DebugCommandsPath;
+static std::optional<unsigned long long> ReverseInterval;
+
+/**
+ * @brief struct SampleConfig - phases of the sampled simulation (--sample)
+ *                              in instructions. Period is the distance
+ *                              between the starts of the warm-ups, zero
+ *                              means one window.
+ */
+struct SampleConfig {
+  unsigned long long FastForward;
+  unsigned long long WarmUp;
+  unsigned long long Detail;
+  unsigned long long Period;
+};
+enum class SamplePhase { WarmUp, Detail };
+static std::optional<SampleConfig> Sample;
 
 #define RAM_START 1000
 #define RAM_SIZE 1001
+#define TRACE_FORMAT 1002
+#define TRACE_LEVEL 1003
+#define LOCKSTEP 1004
+#define LOCKSTEP_INTERVAL 1005
+#define STATE_HASH 1006
+#define STATS 1007
+#define PROFILE 1008
+#define SYMBOLS 1009
+#define CALL_GRAPH 1010
+#define ICACHE 1011
+#define DCACHE 1012
+#define BRANCH_PREDICTORS 1013
+#define TIMING 1014
+#define CHECKPOINT_AT 1015
+#define CHECKPOINT_OUT 1016
+#define RESTORE 1017
+#define SAMPLE 1018
+#define RECORD 1019
+#define REPLAY 1020
+#define SKIP_OUTPUT 1021
+#define DEBUG_COMMANDS 1022
+#define REVERSE_INTERVAL 1023
 // clang-format off
 static struct option CmdLineOpts[] = {
-    {"help",             no_argument,        0,  'h'        },
-    {"ram-start",        required_argument,  0,  RAM_START  },
-    {"ram-size",         required_argument,  0,  RAM_SIZE   },
-    {"program-counter",  required_argument,  0,  'p'        },
-    {"trace-output",     required_argument,  0,  't'        },
-    {0,                  0,                  0,   0         }};
+    {"help",               no_argument,        0,  'h'               },
+    {"ram-start",          required_argument,  0,  RAM_START         },
+    {"ram-size",           required_argument,  0,  RAM_SIZE          },
+    {"program-counter",    required_argument,  0,  'p'               },
+    {"trace-output",       required_argument,  0,  't'               },
+    {"trace-format",       required_argument,  0,  TRACE_FORMAT      },
+    {"trace-level",        required_argument,  0,  TRACE_LEVEL       },
+    {"lockstep",           required_argument,  0,  LOCKSTEP          },
+    {"lockstep-interval",  required_argument,  0,  LOCKSTEP_INTERVAL },
+    {"state-hash",         optional_argument,  0,  STATE_HASH        },
+    {"stats",              optional_argument,  0,  STATS             },
+    {"profile",            optional_argument,  0,  PROFILE           },
+    {"symbols",            required_argument,  0,  SYMBOLS           },
+    {"call-graph",         required_argument,  0,  CALL_GRAPH        },
+    {"icache",             required_argument,  0,  ICACHE            },
+    {"dcache",             required_argument,  0,  DCACHE            },
+    {"branch-predictors",  required_argument,  0,  BRANCH_PREDICTORS },
+    {"timing",             optional_argument,  0,  TIMING            },
+    {"checkpoint-at",      required_argument,  0,  CHECKPOINT_AT     },
+    {"checkpoint-out",     required_argument,  0,  CHECKPOINT_OUT    },
+    {"restore",            required_argument,  0,  RESTORE           },
+    {"sample",             required_argument,  0,  SAMPLE            },
+    {"record",             required_argument,  0,  RECORD            },
+    {"replay",             required_argument,  0,  REPLAY            },
+    {"skip-output",        no_argument,        0,  SKIP_OUTPUT       },
+    {"debug",              required_argument,  0,  DEBUG_COMMANDS    },
+    {"reverse-interval",   required_argument,  0,  REVERSE_INTERVAL  },
+    {0,                    0,                  0,   0                }};
 // clang-format on
 
 static void printHelp(const char *ProgName, int ErrorCode) {
@@ -69,6 +166,93 @@ static void setValue(const char *NameValue, const char *GivenValue,
 #endif
 }
 
+/**
+ * @brief parseCacheConfig - it parses SIZE:ASSOC:LINE[:POLICY] of a cache,
+ *                           sizes are in bytes, POLICY is lru (default),
+ *                           plru or random.
+ */
+static CacheConfig parseCacheConfig(const char *Name, const char *Arg) {
+  std::vector<std::string> Fields;
+  std::string Field;
+  std::istringstream Stream(Arg);
+  while (std::getline(Stream, Field, ':'))
+    Fields.push_back(Field);
+  if (Fields.size() != 3 && Fields.size() != 4)
+    failWithError("Invalid " + std::string(Name) + " " + Arg +
+                  " (expected SIZE:ASSOC:LINE[:lru|plru|random])");
+  std::optional<unsigned long long> Size, Assoc, LineSz;
+  setValue("cache size", Fields[0].c_str(), Size);
+  setValue("cache associativity", Fields[1].c_str(), Assoc);
+  setValue("cache line size", Fields[2].c_str(), LineSz);
+  CacheConfig Config;
+  Config.Size = Size.value();
+  Config.Assoc = Assoc.value();
+  Config.LineSz = LineSz.value();
+  if (Fields.size() == 4) {
+    if (Fields[3] == "lru")
+      Config.Policy = ReplacementKind::LRU;
+    else if (Fields[3] == "plru")
+      Config.Policy = ReplacementKind::PLRU;
+    else if (Fields[3] == "random")
+      Config.Policy = ReplacementKind::Random;
+    else
+      failWithError("Unknown replacement policy " + Fields[3] +
+                    " (expected lru, plru or random)");
+  }
+  return Config;
+}
+
+/**
+ * @brief parseTimingConfig - it parses LOAD:MUL:DIV:BRANCH:MISS latencies of
+ *                            the timing model in cycles.
+ */
+static TimingConfig parseTimingConfig(const char *Arg) {
+  std::vector<std::optional<unsigned long long>> Values;
+  std::string Field;
+  std::istringstream Stream(Arg);
+  while (std::getline(Stream, Field, ':'))
+    setValue("timing latency", Field.c_str(), Values.emplace_back());
+  if (Values.size() != 5)
+    failWithError("Invalid timing " + std::string(Arg) +
+                  " (expected LOAD:MUL:DIV:BRANCH:MISS)");
+  if (Values[0].value() == 0 || Values[1].value() == 0 ||
+      Values[2].value() == 0)
+    failWithError("Zero latency of the timing model");
+  TimingConfig Config;
+  Config.LoadLatency = Values[0].value();
+  Config.MulLatency = Values[1].value();
+  Config.DivLatency = Values[2].value();
+  Config.BranchPenalty = Values[3].value();
+  Config.MissPenalty = Values[4].value();
+  return Config;
+}
+
+/**
+ * @brief parseSampleConfig - it parses FF:WARM:DETAIL[:PERIOD] of the sampled
+ *                            simulation.
+ */
+static SampleConfig parseSampleConfig(const char *Arg) {
+  std::vector<std::optional<unsigned long long>> Values;
+  std::string Field;
+  std::istringstream Stream(Arg);
+  while (std::getline(Stream, Field, ':'))
+    setValue("sample length", Field.c_str(), Values.emplace_back());
+  if (Values.size() != 3 && Values.size() != 4)
+    failWithError("Invalid sample " + std::string(Arg) +
+                  " (expected FF:WARM:DETAIL[:PERIOD])");
+  SampleConfig Config;
+  Config.FastForward = Values[0].value();
+  Config.WarmUp = Values[1].value();
+  Config.Detail = Values[2].value();
+  Config.Period = Values.size() == 4 ? Values[3].value() : 0;
+  if (Config.Detail == 0)
+    failWithError("Zero detailed window of the sample");
+  if (Config.Period != 0 && Config.Period < Config.WarmUp + Config.Detail)
+    failWithError("Sample period is shorter than the warm-up and the "
+                  "detailed window");
+  return Config;
+}
+
 /**
  * @brief parseCmdLine - it parses the command line arguments and returns the
  *                       index for the binary that should be executed.
@@ -91,6 +275,109 @@ static int parseCmdLine(int Argc, char **Argv) {
       setValue("ram-size", optarg, RamSize);
       RamSize.value() <<= 20;
       break;
+    case TRACE_FORMAT:
+      if (std::string(optarg) == "text")
+        TraceFormatKind = TraceKind::Text;
+      else if (std::string(optarg) == "binary")
+        TraceFormatKind = TraceKind::Binary;
+      else if (std::string(optarg) == "spike")
+        TraceFormatKind = TraceKind::Spike;
+      else
+        failWithError("Unknown trace format " + std::string(optarg) +
+                      " (expected text, binary or spike)");
+      break;
+    case TRACE_LEVEL: {
+      auto NewLevel = parseTraceLevel(optarg);
+      if (!NewLevel.has_value())
+        failWithError("Unknown trace level " + std::string(optarg) +
+                      " (expected none, commit or full)");
+      Level = NewLevel.value();
+      break;
+    }
+    case LOCKSTEP:
+      LockstepModelPath = optarg;
+      break;
+    case LOCKSTEP_INTERVAL:
+      setValue("lockstep-interval", optarg, LockstepInterval);
+      if (LockstepInterval.value() == 0)
+        failWithError("Zero lockstep-interval");
+      break;
+    case STATE_HASH:
+      // Without a value only the final hash is printed
+      if (optarg == nullptr)
+        StateHashInterval = 0;
+      else
+        setValue("state-hash interval", optarg, StateHashInterval);
+      break;
+    case STATS:
+      StatsPath = optarg == nullptr ? "" : optarg;
+      if (StatsPath.value().empty() && optarg != nullptr)
+        failWithError("Empty stats file name");
+      break;
+    case PROFILE:
+      // Without a value every instruction is counted
+      if (optarg == nullptr)
+        ProfileInterval = 1;
+      else
+        setValue("profile interval", optarg, ProfileInterval);
+      if (ProfileInterval.value() == 0)
+        failWithError("Zero profile interval");
+      break;
+    case SYMBOLS:
+      SymbolsPath = optarg;
+      break;
+    case CALL_GRAPH:
+      CallGraphPath = optarg;
+      break;
+    case ICACHE:
+      ICacheConfig = parseCacheConfig("icache", optarg);
+      break;
+    case DCACHE:
+      DCacheConfig = parseCacheConfig("dcache", optarg);
+      break;
+    case BRANCH_PREDICTORS: {
+      std::string Name;
+      std::istringstream Stream(optarg);
+      while (std::getline(Stream, Name, ','))
+        BranchPredictorNames.push_back(Name);
+      if (BranchPredictorNames.empty())
+        failWithError("Empty list of branch predictors");
+      break;
+    }
+    case TIMING:
+      Timing = optarg == nullptr ? TimingConfig{} : parseTimingConfig(optarg);
+      break;
+    case CHECKPOINT_AT:
+      setValue("checkpoint-at", optarg, CheckpointAt);
+      if (CheckpointAt.value() == 0)
+        failWithError("Zero checkpoint-at");
+      break;
+    case CHECKPOINT_OUT:
+      CheckpointOutPath = optarg;
+      break;
+    case RESTORE:
+      RestorePath = optarg;
+      break;
+    case SAMPLE:
+      Sample = parseSampleConfig(optarg);
+      break;
+    case RECORD:
+      RecordPath = optarg;
+      break;
+    case REPLAY:
+      ReplayPath = optarg;
+      break;
+    case SKIP_OUTPUT:
+      SkipOutput = true;
+      break;
+    case DEBUG_COMMANDS:
+      DebugCommandsPath = optarg;
+      break;
+    case REVERSE_INTERVAL:
+      setValue("reverse-interval", optarg, ReverseInterval);
+      if (ReverseInterval.value() == 0)
+        failWithError("Zero reverse-interval");
+      break;
     case 'p':
       setValue("program counter", optarg, Pc);
       break;
@@ -108,14 +395,81 @@ static int parseCmdLine(int Argc, char **Argv) {
       break;
     }
   }
-  if (optind >= Argc)
+  // The restored checkpoint has the program in its memory
+  if (optind >= Argc && !RestorePath.has_value())
     failWithError("No binary file in args");
+  if (optind < Argc && RestorePath.has_value())
+    failWithError("Binary file can't be used with --restore");
+  if (RestorePath.has_value() && Pc.has_value())
+    failWithError("--program-counter can't be used with --restore");
+  if (CheckpointAt.has_value() != CheckpointOutPath.has_value())
+    failWithError("--checkpoint-at and --checkpoint-out are used together");
+  if (CheckpointAt.has_value() && Sample.has_value())
+    failWithError("--checkpoint-at can't be used with --sample");
+  if (RecordPath.has_value() && ReplayPath.has_value())
+    failWithError("--record can't be used with --replay");
+  if (SkipOutput && !ReplayPath.has_value())
+    failWithError("--skip-output is used only with --replay");
+  if (ReverseInterval.has_value() && !DebugCommandsPath.has_value())
+    failWithError("--reverse-interval is used only with --debug");
+  if (DebugCommandsPath.has_value() &&
+      (StateHashInterval.has_value() || StatsPath.has_value() ||
+       ProfileInterval.has_value() || CallGraphPath.has_value() ||
+       ICacheConfig.has_value() || DCacheConfig.has_value() ||
+       !BranchPredictorNames.empty() || Timing.has_value() ||
+       CheckpointAt.has_value() || Sample.has_value()))
+    failWithError("The analyses, --checkpoint-at and --sample can't be used "
+                  "with --debug");
+  if (TraceFormatKind == TraceKind::Binary && !LogFilePath.has_value())
+    failWithError("Binary trace format requires --trace-output");
+  if ((StatsPath.has_value() || ProfileInterval.has_value() ||
+       CallGraphPath.has_value() || ICacheConfig.has_value() ||
+       DCacheConfig.has_value() || !BranchPredictorNames.empty() ||
+       Timing.has_value() || CheckpointAt.has_value() ||
+       RestorePath.has_value() || Sample.has_value() ||
+       RecordPath.has_value() || ReplayPath.has_value() ||
+       DebugCommandsPath.has_value()) &&
+      LockstepModelPath.has_value())
+    failWithError("The analyses (--stats, --profile, --call-graph, caches, "
+                  "branch predictors and timing), checkpoints, sampling, "
+                  "syscall logs and --debug can't be used with --lockstep");
 #ifdef DEBUG
   std::cerr << "Binary file " << Argv[optind] << "\n";
 #endif
   return optind;
 }
 
+/**
+ * @brief loadElfImage - it reads the segments of the ELF executable. The
+ *                       entry point is the default PC and the file is the
+ *                       default --symbols. Without --ram-size the RAM is
+ *                       extended to the end of the segments.
+ */
+template <size_t Sz> void loadElfImage(const char *ElfPath) {
+  if (LockstepModelPath.has_value())
+    failWithError("ELF files can't be used with --lockstep, use a binary "
+                  "image");
+  Elf = std::make_shared<const ElfImage>(ElfPath,
+                                         Memory<Sz>::getPageSz() / CHAR_BIT);
+  if (!Pc.has_value())
+    Pc = Elf->getEntry();
+  if (!SymbolsPath.has_value())
+    SymbolsPath = ElfPath;
+  if (!RamStart.has_value())
+    RamStart = Memory<Sz>::getDefaultRamStart();
+  if (!RamSize.has_value()) {
+    const unsigned long long MB = 1ull << 20;
+    auto End = std::max<unsigned long long>(Elf->getEnd(), RamStart.value());
+    RamSize = std::max(Memory<Sz>::getDefaultRamSz(),
+                       (End - RamStart.value() + MB - 1) / MB * MB);
+  }
+  for (auto &Seg : Elf->getSegments())
+    if (Seg.Addr < RamStart.value() ||
+        Seg.Addr + Seg.MemSz > RamStart.value() + RamSize.value())
+      failWithError("ELF segment at " + std::to_string(Seg.Addr) +
+                    " is out of RAM, use --ram-start and --ram-size");
+}
+
 std::vector<Register<CHAR_BIT>>
 putProgramInBuffer(const std::string &ProgName) {
   std::vector<Register<CHAR_BIT>> Program;
@@ -128,17 +482,465 @@ putProgramInBuffer(const std::string &ProgName) {
   return Program;
 }
 
-template <size_t Sz>
+/**
+ * @brief printStateHash - the state hash goes to stderr, so the trace stays
+ *                         the same.
+ */
+static void printStateHash(unsigned long long InstrCount, uint64_t Hash) {
+  char Line[TraceFormat::MaxLineSz];
+  char *Out = TraceFormat::putStr(Line, "State hash after ");
+  Out = TraceFormat::putDec(Out, InstrCount);
+  Out = TraceFormat::putStr(Out, " instructions: 0x");
+  Out = TraceFormat::putHexPadded(Out, Hash, /* Digits */ 16);
+  Out = TraceFormat::putStr(Out, "\n");
+  std::cerr.write(Line, Out - Line);
+}
+
+/**
+ * @brief printStats - the text report goes to stderr like the state hash,
+ *                     the JSON one to the file given to --stats.
+ */
+static void printStats(const RunStats &Stats) {
+  if (StatsPath.value().empty()) {
+    Stats.printText(std::cerr);
+    return;
+  }
+  std::ofstream File(StatsPath.value());
+  if (!File.is_open())
+    failWithError("Can't open stats file " + StatsPath.value());
+  Stats.printJSON(File);
+}
+
+/**
+ * @brief reportCaches - the cache counters go to stderr after the run, if
+ *                       the memory has the cache model.
+ */
+template <typename MemoryType>
+static void reportCaches(const MemoryType &Mem, RunStats *Stats = nullptr) {
+  if constexpr (HasCacheModel<MemoryType>) {
+    Mem.reportCaches(std::cerr);
+    if (Stats == nullptr)
+      return;
+    if (Mem.getICache().has_value())
+      Stats->addCache("l1i", Mem.getICache().value());
+    if (Mem.getDCache().has_value())
+      Stats->addCache("l1d", Mem.getDCache().value());
+  }
+}
+
+/**
+ * @brief runSampled - sampled simulation (--sample). Cpu is the detailed
+ *                     model, it runs the windows with the trace and
+ *                     AfterStep. The fast-forward and the warm-up are done by
+ *                     the models of the same hart without the trace: the
+ *                     fast one does not touch the caches, the warm one
+ *                     updates them and calls WarmUpStep (the branch
+ *                     predictors). BeginPhase is called before the warm-up
+ *                     and the window with the PC where they start.
+ */
+template <typename MemoryType, typename CPUType, typename HookType,
+          typename WarmHookType, typename PhaseHookType>
+void runSampled(MemoryType &Mem, CPUType &Cpu,
+                const std::vector<Register<CHAR_BIT>> &Program,
+                TraceSink &Sink, HookType AfterStep, WarmHookType WarmUpStep,
+                PhaseHookType BeginPhase) {
+  using FastMemory = Memory<MemoryType::getAddrSz(), MemoryType::getPageSz()>;
+  CPU<FastMemory, InstrSet<FastMemory, TraceLevel::None, RV32I::RV32IInstrSet,
+                           Zicsr::ZicsrInstrSet, Machine::MachineInstrSet>>
+      Fast{Mem, Sink, SharedHart{}};
+  CPU<MemoryType, InstrSet<MemoryType, TraceLevel::None, RV32I::RV32IInstrSet,
+                           Zicsr::ZicsrInstrSet, Machine::MachineInstrSet>>
+      Warm{Mem, Sink, SharedHart{}};
+  if (Pc.value() % Instruction::Sz_b != 0)
+    failWithError("Pc start address is not aligned to 4 bytes");
+  auto &Config = Sample.value();
+  Fast.continueFrom(Cpu);
+  Fast.storeProgramInVirtualMemory(Program);
+  Fast.setPC(Pc.value());
+
+  uint64_t Windows = 0, FastInstrs = 0, WarmInstrs = 0, DetailInstrs = 0;
+  auto FastCount = Config.FastForward;
+  Cpu.beginTrace();
+  while (true) {
+    FastInstrs += Fast.run(FastCount);
+    if (Fast.isStopped()) {
+      Cpu.continueFrom(Fast);
+      break;
+    }
+    Warm.continueFrom(Fast);
+    BeginPhase(SamplePhase::WarmUp, Warm.readPC().to_ullong());
+    WarmInstrs += Warm.run(Config.WarmUp,
+                           [&](bool Retired) { WarmUpStep(Warm, Retired); });
+    Cpu.continueFrom(Warm);
+    BeginPhase(SamplePhase::Detail, Cpu.readPC().to_ullong());
+    if (!Cpu.isStopped()) {
+      DetailInstrs += Cpu.run(Config.Detail, AfterStep);
+      ++Windows;
+    }
+    Fast.continueFrom(Cpu);
+    if (Cpu.isStopped())
+      break;
+    // Without the period the rest of the program is fast-forwarded
+    FastCount = Config.Period == 0
+                    ? std::numeric_limits<uint64_t>::max()
+                    : Config.Period - Config.WarmUp - Config.Detail;
+  }
+  Cpu.endTrace();
+  std::cerr << "Sampled simulation: " << Windows << " windows, "
+            << FastInstrs << " fast-forwarded, " << WarmInstrs
+            << " warm-up and " << DetailInstrs << " detailed instructions\n";
+}
+
+/**
+ * @brief runDebugger - it executes the commands of --debug (one per line,
+ *                      # starts a comment) and reports the instret and the
+ *                      PC after each of them to stderr:
+ *                        step [N]              N instructions (1)
+ *                        continue [PC]         until PC or the end
+ *                        reverse-step [N]      N instructions back (1)
+ *                        reverse-continue [PC] back to the previous PC or
+ *                                              the beginning
+ *                        regs                  PC and X registers
+ *                        quit
+ *                      Cpu executes forward with the trace, the steps back
+ *                      are done by ReverseExecution on the model of the
+ *                      same hart without the trace.
+ */
+template <typename MemoryType, typename CPUType>
+void runDebugger(MemoryType &Mem, CPUType &Cpu,
+                 const std::vector<Register<CHAR_BIT>> &Program,
+                 TraceSink &Sink) {
+  using FastMemory = Memory<MemoryType::getAddrSz(), MemoryType::getPageSz()>;
+  CPU<FastMemory, InstrSet<FastMemory, TraceLevel::None, RV32I::RV32IInstrSet,
+                           Zicsr::ZicsrInstrSet, Machine::MachineInstrSet>>
+      Fast{Mem, Sink, SharedHart{}};
+  if (Pc.value() % Instruction::Sz_b != 0)
+    failWithError("Pc start address is not aligned to 4 bytes");
+  Cpu.storeProgramInVirtualMemory(Program);
+  Cpu.setPC(Pc.value());
+  FastMemory &BaseMem = Mem;
+  ReverseExecution Reverse(Cpu, Fast, BaseMem,
+                           ReverseInterval.value_or(100000));
+
+  std::ifstream File;
+  bool FromStdin = std::string(DebugCommandsPath.value()) == "-";
+  if (!FromStdin) {
+    File.open(DebugCommandsPath.value());
+    if (!File.is_open())
+      failWithError("Can't open debug commands " +
+                    std::string(DebugCommandsPath.value()));
+  }
+  std::istream &Commands = FromStdin ? std::cin : File;
+  auto AfterStep = [&](bool Retired) {
+    if (Retired)
+      Reverse.afterStep();
+  };
+  auto GetValue = [](const std::string &Arg,
+                     unsigned long long Default) -> unsigned long long {
+    if (Arg.empty())
+      return Default;
+    std::optional<unsigned long long> Value;
+    setValue("debug command argument", Arg.c_str(), Value);
+    return Value.value();
+  };
+
+  Cpu.beginTrace();
+  std::string Line;
+  while (std::getline(Commands, Line)) {
+    std::istringstream Stream(Line);
+    std::string Command, Arg;
+    Stream >> Command >> Arg;
+    if (Command.empty() || Command[0] == '#')
+      continue;
+    if (Command == "quit")
+      break;
+    if (Command == "step") {
+      Cpu.run(GetValue(Arg, 1), AfterStep);
+    } else if (Command == "continue") {
+      if (Arg.empty()) {
+        Cpu.run(std::numeric_limits<uint64_t>::max(), AfterStep);
+      } else {
+        // A trap to the handler at the PC stops too
+        Cpu.runUntil(std::numeric_limits<uint64_t>::max(), GetValue(Arg, 0),
+                     AfterStep);
+        Cpu.checkUnhandledTrap();
+      }
+    } else if (Command == "reverse-step") {
+      Reverse.reverseStep(GetValue(Arg, 1));
+    } else if (Command == "reverse-continue") {
+      auto Target = GetValue(Arg, 0);
+      bool HasTarget = !Arg.empty();
+      if (!Reverse.reverseContinue([&](const auto &Model) {
+            return HasTarget && Model.readPC().to_ullong() == Target;
+          }) &&
+          HasTarget)
+        std::cerr << "PC " << Target << " was not reached before\n";
+    } else if (Command == "regs") {
+      std::cerr << "pc = 0x" << std::hex << Cpu.readPC().to_ullong() << "\n";
+      for (unsigned Reg = 0; Reg < 32; ++Reg)
+        std::cerr << "X" << std::dec << Reg << " = 0x" << std::hex
+                  << Cpu.readXReg(Reg) << "\n";
+      std::cerr << std::dec;
+      continue;
+    } else {
+      failWithError("Unknown debug command " + Command);
+    }
+    Cpu.flushTrace();
+    std::cerr << "instret " << Cpu.getInstret() << ", pc 0x" << std::hex
+              << Cpu.readPC().to_ullong() << std::dec
+              << (Cpu.isStopped() ? ", finished" : "") << "\n";
+  }
+  Cpu.endTrace();
+}
+
+/**
+ * @brief simulate - it runs Program on Mem together with the analyses
+ *                   requested in the command line.
+ */
+template <TraceLevel Level, typename MemoryType>
+void simulate(MemoryType &Mem, const std::vector<Register<CHAR_BIT>> &Program,
+              TraceSink &Sink) {
+  CPU<MemoryType, InstrSet<MemoryType, Level, RV32I::RV32IInstrSet,
+                           Zicsr::ZicsrInstrSet, Machine::MachineInstrSet>>
+      Cpu{Mem, Sink};
+  if (Restored != nullptr)
+    restoreCheckpoint(Restored, Cpu, Mem);
+  if (Elf != nullptr) {
+    Mem.setLazyPages(Elf, Elf->getStateHash());
+    Cpu.setProgramBreak(Elf->getEnd());
+  }
+  if (TraceFormatKind != TraceKind::Binary && !LogFilePath.has_value())
+    Cpu.getSyscalls().shareWithTrace();
+  if (RecordPath.has_value())
+    Cpu.getSyscalls().record(RecordPath.value());
+  if (ReplayPath.has_value())
+    Cpu.getSyscalls().replay(ReplayPath.value(), SkipOutput);
+  if (DebugCommandsPath.has_value()) {
+    runDebugger(Mem, Cpu, Program, Sink);
+    return;
+  }
+  if (!StateHashInterval.has_value() && !StatsPath.has_value() &&
+      !ProfileInterval.has_value() && !CallGraphPath.has_value() &&
+      BranchPredictorNames.empty() && !Timing.has_value() &&
+      !CheckpointAt.has_value() && !Sample.has_value()) {
+    Cpu.execute(Pc.value(), Program);
+    reportCaches(Mem);
+    return;
+  }
+  // The symbols are read before the run, so a wrong file is reported early
+  SymbolTable Symbols;
+  if (SymbolsPath.has_value())
+    Symbols = SymbolTable(SymbolsPath.value());
+  auto Interval = StateHashInterval.value_or(0);
+  bool CountMix = StatsPath.has_value();
+  InstrMixCounter<decltype(Cpu.getLastExecuted())> Mix;
+  std::optional<HotSpotProfiler> Profiler;
+  if (ProfileInterval.has_value())
+    Profiler.emplace(ProfileInterval.value(), Pc.value());
+  std::optional<CallGraphProfiler> CallGraph;
+  if (CallGraphPath.has_value())
+    CallGraph.emplace(Pc.value());
+  std::optional<BranchModel> Branches;
+  if (!BranchPredictorNames.empty())
+    Branches.emplace(BranchPredictorNames, Pc.value());
+  std::optional<TimingModel> Pipeline;
+  if (Timing.has_value())
+    Pipeline.emplace(Timing.value(), Pc.value(), !Symbols.empty());
+  // Observed instructions: all of them or the detailed windows of --sample
+  unsigned long long InstrCount = 0;
+  // The state hash is reported by the position in the program, so the
+  // sampled run can be compared with the full one
+  auto StartInstret = Cpu.getInstret();
+  auto getExecuted = [&]() { return Cpu.getInstret() - StartInstret; };
+  RunStats Stats;
+  auto AfterStep = [&](bool Retired) {
+    if (!Retired) [[unlikely]] {
+      // The instruction that took the trap is not observed, the analyses
+      // go on from the handler
+      auto HandlerPc = Cpu.readPC().to_ullong();
+      if (Profiler.has_value())
+        Profiler->skipTo(HandlerPc);
+      if (CallGraph.has_value())
+        CallGraph->trapTo(HandlerPc);
+      if (Branches.has_value())
+        Branches->skipTo(HandlerPc);
+      if (Pipeline.has_value())
+        Pipeline->skipTo(HandlerPc);
+      return;
+    }
+    ++InstrCount;
+    if (CountMix)
+      Mix.count(Cpu.getLastExecuted());
+    if (Profiler.has_value())
+      Profiler->afterStep(Cpu.readPC().to_ullong());
+    if (CallGraph.has_value())
+      CallGraph->afterStep(Cpu.getLastInstr(), Cpu.readPC().to_ullong());
+    if (Branches.has_value())
+      Branches->afterStep(Cpu.getLastInstr(), Cpu.readPC().to_ullong());
+    if (Pipeline.has_value()) {
+      unsigned IMisses = 0, DMisses = 0;
+      if constexpr (HasCacheModel<MemoryType>) {
+        IMisses = Mem.getLastIMisses();
+        DMisses = Mem.getLastDMisses();
+      }
+      std::optional<bool> Mispredicted;
+      if (Branches.has_value())
+        Mispredicted = Branches->lastMispredicted();
+      Pipeline->afterStep(Cpu.getLastInstr(), Cpu.readPC().to_ullong(),
+                          IMisses, DMisses, Mispredicted);
+    }
+    if (Interval != 0 && getExecuted() % Interval == 0)
+      printStateHash(getExecuted(), Cpu.stateHash());
+    if (CheckpointAt.has_value() && Cpu.getInstret() == CheckpointAt.value())
+      saveCheckpoint(CheckpointOutPath.value(), Cpu, Mem);
+  };
+  if (Sample.has_value()) {
+    // The caches and the branch predictors are warmed up, the other
+    // analyses see only the detailed windows
+    auto WarmUpStep = [&](const auto &WarmCpu, bool Retired) {
+      if (!Branches.has_value())
+        return;
+      if (Retired)
+        Branches->afterStep(WarmCpu.getLastInstr(),
+                            WarmCpu.readPC().to_ullong());
+      else
+        Branches->skipTo(WarmCpu.readPC().to_ullong());
+    };
+    auto BeginPhase = [&](SamplePhase Phase, uint64_t PhasePc) {
+      bool IsDetail = Phase == SamplePhase::Detail;
+      if constexpr (HasCacheModel<MemoryType>)
+        Mem.setCacheCounting(IsDetail);
+      if (Branches.has_value()) {
+        Branches->setCounting(IsDetail);
+        if (!IsDetail)
+          Branches->skipTo(PhasePc);
+      }
+      if (!IsDetail)
+        return;
+      if (Profiler.has_value())
+        Profiler->skipTo(PhasePc);
+      if (CallGraph.has_value())
+        CallGraph->skipTo(PhasePc);
+      if (Pipeline.has_value())
+        Pipeline->skipTo(PhasePc);
+    };
+    runSampled(Mem, Cpu, Program, Sink, AfterStep, WarmUpStep, BeginPhase);
+  } else {
+    Cpu.execute(Pc.value(), Program, AfterStep);
+  }
+  if (CheckpointAt.has_value() && Cpu.getInstret() < CheckpointAt.value())
+    std::cerr << "Program finished after " << Cpu.getInstret()
+              << " instructions, no checkpoint was saved\n";
+  if (StateHashInterval.has_value())
+    printStateHash(getExecuted(), Cpu.stateHash());
+  if (Profiler.has_value())
+    Profiler->report(std::cerr, Symbols);
+  if (Branches.has_value())
+    Branches->report(std::cerr, Symbols);
+  if (Pipeline.has_value())
+    Pipeline->report(std::cerr, Symbols);
+  if (CallGraph.has_value()) {
+    std::ofstream File(CallGraphPath.value());
+    if (!File.is_open())
+      failWithError("Can't open call graph file " +
+                    std::string(CallGraphPath.value()));
+    CallGraph->writeFolded(File, Symbols);
+  }
+  if (!StatsPath.has_value()) {
+    reportCaches(Mem);
+    return;
+  }
+  for (auto &[Func, Count] : Mix.getCounts())
+    Stats.addInstr(Cpu.getMnemonic(Func), Count);
+  Stats.finish(InstrCount, getExecuted(), Cpu.getPagesTouched(),
+               Mem.getPageSz() / CHAR_BIT, Sample.has_value());
+  reportCaches(Mem, &Stats);
+  printStats(Stats);
+}
+
+template <size_t Sz, TraceLevel Level>
 void generateProcess(const std::vector<Register<CHAR_BIT>> &Program,
-                     std::ostream &LogFile) {
+                     TraceSink &Sink) {
+  if (!RamStart.has_value())
+    RamStart = Memory<Sz>::getDefaultRamStart();
+  if (!RamSize.has_value())
+    RamSize = Memory<Sz>::getDefaultRamSz();
+  if (!ICacheConfig.has_value() && !DCacheConfig.has_value()) {
+    Memory<Sz> Mem(RamStart.value(), RamSize.value());
+    simulate<Level>(Mem, Program, Sink);
+    return;
+  }
+  CachedMemory<Memory<Sz>> Mem(ICacheConfig, DCacheConfig, RamStart.value(),
+                               RamSize.value());
+  simulate<Level>(Mem, Program, Sink);
+}
+
+/**
+ * @brief generateLockstepProcess - the same as generateProcess, but the
+ *                                  program is executed together with the
+ *                                  reference model (--lockstep).
+ */
+template <size_t Sz, TraceLevel Level>
+void generateLockstepProcess(const std::vector<Register<CHAR_BIT>> &Program,
+                             LockstepSink &Checker) {
   if (!RamStart.has_value())
     RamStart = Memory<Sz>::getDefaultRamStart();
   if (!RamSize.has_value())
     RamSize = Memory<Sz>::getDefaultRamSz();
   Memory<Sz> Mem(RamStart.value(), RamSize.value());
-  CPU<decltype(Mem), InstrSet<decltype(Mem), RV32I::RV32IInstrSet>> Cpu{
-      Mem, LogFile};
-  Cpu.execute(Pc.value(), Program);
+  CPU<decltype(Mem), InstrSet<decltype(Mem), Level, RV32I::RV32IInstrSet,
+                              Zicsr::ZicsrInstrSet, Machine::MachineInstrSet>>
+      Cpu{Mem, Checker};
+  ReferenceModel Ref(LockstepModelPath.value(), RamStart.value(),
+                     RamSize.value());
+  runLockstep(Cpu, Ref, Checker, Pc.value(), Program,
+              LockstepInterval.value_or(1));
+}
+
+/**
+ * @brief runProcess - it selects the instantiation of the model for the
+ *                     trace level given in the command line.
+ */
+template <size_t Sz>
+void runProcess(const std::vector<Register<CHAR_BIT>> &Program,
+                TraceSink &Sink) {
+  if (LockstepModelPath.has_value()) {
+    // Memory writes are needed for the comparison, so at least the commit
+    // level is instantiated, but nothing is printed for --trace-level none
+    LockstepSink Checker(Level == TraceLevel::None ? nullptr : &Sink);
+    if (Level == TraceLevel::Full)
+      generateLockstepProcess<Sz, TraceLevel::Full>(Program, Checker);
+    else
+      generateLockstepProcess<Sz, TraceLevel::Commit>(Program, Checker);
+    return;
+  }
+  switch (Level) {
+  case TraceLevel::None:
+    generateProcess<Sz, TraceLevel::None>(Program, Sink);
+    break;
+  case TraceLevel::Commit:
+    generateProcess<Sz, TraceLevel::Commit>(Program, Sink);
+    break;
+  case TraceLevel::Full:
+    generateProcess<Sz, TraceLevel::Full>(Program, Sink);
+    break;
+  }
+}
+
+/**
+ * @brief runWithStreamSink - it runs the process with the text or Spike
+ *                            commit log sink writing into LogFile.
+ */
+template <size_t Sz>
+void runWithStreamSink(const std::vector<Register<CHAR_BIT>> &Program,
+                       std::ostream &LogFile) {
+  if (TraceFormatKind == TraceKind::Spike) {
+    SpikeTraceSink Sink(LogFile, Sz);
+    runProcess<Sz>(Program, Sink);
+  } else {
+    TextTraceSink Sink(LogFile);
+    runProcess<Sz>(Program, Sink);
+  }
 }
 
 } // namespace rvdash
@@ -147,14 +949,30 @@ int main(int Argc, char **Argv) {
   try {
     const unsigned AddrSpaceSz = 32;
     auto BinIdx = rvdash::parseCmdLine(Argc, Argv);
-    auto Program = rvdash::putProgramInBuffer(Argv[BinIdx]);
+    std::vector<rvdash::Register<CHAR_BIT>> Program;
+    if (rvdash::RestorePath.has_value()) {
+      rvdash::Restored = std::make_shared<const rvdash::CheckpointFile>(
+          rvdash::RestorePath.value());
+      auto &Header = rvdash::Restored->getHeader();
+      rvdash::Pc = Header.Pc;
+      if (!rvdash::RamStart.has_value())
+        rvdash::RamStart = Header.RamStart;
+      if (!rvdash::RamSize.has_value())
+        rvdash::RamSize = Header.RamSize;
+    } else if (rvdash::ElfImage::isElfFile(Argv[BinIdx])) {
+      rvdash::loadElfImage<AddrSpaceSz>(Argv[BinIdx]);
+    } else {
+      Program = rvdash::putProgramInBuffer(Argv[BinIdx]);
+    }
     rvdash::Pc = rvdash::Pc.has_value() ? rvdash::Pc.value() : 0;
-    if (!rvdash::LogFilePath.has_value()) {
-      std::ostream &LogFile = std::cout;
-      rvdash::generateProcess<AddrSpaceSz>(Program, LogFile);
+    if (rvdash::TraceFormatKind == rvdash::TraceKind::Binary) {
+      rvdash::BinaryTraceSink Sink(rvdash::LogFilePath.value());
+      rvdash::runProcess<AddrSpaceSz>(Program, Sink);
+    } else if (!rvdash::LogFilePath.has_value()) {
+      rvdash::runWithStreamSink<AddrSpaceSz>(Program, std::cout);
     } else {
       std::ofstream LogFile(rvdash::LogFilePath.value());
-      rvdash::generateProcess<AddrSpaceSz>(Program, LogFile);
+      rvdash::runWithStreamSink<AddrSpaceSz>(Program, LogFile);
     }
   } catch (std::exception &ex) {
     std::cout << ex.what() << std::endl;
@@ -0,0 +1,98 @@
+#include "Error.h"
+#include "rvdash/Trace/SpikeTraceSink.h"
+#include "rvdash/Trace/TextTraceSink.h"
+#include "rvdash/Trace/TraceReader.h"
+
+#include <fstream>
+#include <getopt.h>
+#include <optional>
+
+namespace rvdash {
+
+static std::optional<const char *> OutputPath;
+static bool SpikeFormat = false;
+
+// clang-format off
+static struct option CmdLineOpts[] = {
+    {"help",    no_argument,        0,  'h' },
+    {"output",  required_argument,  0,  'o' },
+    {"format",  required_argument,  0,  'f' },
+    {0,         0,                  0,   0  }};
+// clang-format on
+
+static void printHelp(const char *ProgName, int ErrorCode) {
+  std::cerr << "USAGE:     " << ProgName << "   [options]   <binary_trace>\n\n";
+  std::cerr << "Renders the binary trace of rvdashSim (--trace-format binary)\n"
+               "in the text trace format or in the Spike commit log format\n"
+               "(--format spike).\n\n";
+  std::cerr << "OPTIONS: \n";
+  struct option *opt = CmdLineOpts;
+  while (opt->name) {
+    std::cerr << "\t   -" << static_cast<char>(opt->val) << "\t --"
+              << opt->name << "\n";
+    opt++;
+  }
+  exit(ErrorCode);
+}
+
+/**
+ * @brief parseCmdLine - it parses the command line arguments and returns the
+ *                       index for the trace that should be rendered.
+ */
+static int parseCmdLine(int Argc, char **Argv) {
+  int NextOpt;
+  while ((NextOpt = getopt_long(Argc, Argv, "ho:f:", CmdLineOpts, NULL)) != -1) {
+    switch (NextOpt) {
+    case 'o':
+      OutputPath = optarg;
+      break;
+    case 'f':
+      if (std::string(optarg) == "spike")
+        SpikeFormat = true;
+      else if (std::string(optarg) != "text")
+        failWithError("Unknown format " + std::string(optarg) +
+                      " (expected text or spike)");
+      break;
+    case 'h':
+      printHelp(Argv[0], 0);
+      break;
+    case '?':
+      printHelp(Argv[0], 1);
+      break;
+    }
+  }
+  if (optind >= Argc)
+    failWithError("No trace file in args");
+  return optind;
+}
+
+static void renderTrace(const char *TracePath, std::ostream &Output) {
+  if (SpikeFormat) {
+    SpikeTraceSink Sink(Output);
+    replayTrace(TracePath, Sink);
+  } else {
+    TextTraceSink Sink(Output);
+    replayTrace(TracePath, Sink);
+  }
+}
+
+} // namespace rvdash
+
+int main(int Argc, char **Argv) {
+  try {
+    auto TraceIdx = rvdash::parseCmdLine(Argc, Argv);
+    if (!rvdash::OutputPath.has_value()) {
+      rvdash::renderTrace(Argv[TraceIdx], std::cout);
+    } else {
+      std::ofstream Output(rvdash::OutputPath.value());
+      if (!Output.is_open())
+        rvdash::failWithError("Can't open file " +
+                              std::string(rvdash::OutputPath.value()));
+      rvdash::renderTrace(Argv[TraceIdx], Output);
+    }
+  } catch (std::exception &ex) {
+    std::cout << ex.what() << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  return 0;
+}